@@ -0,0 +1,30 @@
+/**
+ * @file allocation_tracker.h
+ */
+
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#include <cstdint>
+
+/**
+ * @brief Counts the heap allocations made by the calling thread, used to check that the control loop does not
+ *        allocate once it is running.
+ *
+ *        The counting is only compiled in when Fluid is built with the FLUID_TRACK_ALLOCATIONS option, which
+ *        replaces the global operator new. Otherwise the count stays at 0 and nothing is replaced.
+ */
+class AllocationTracker {
+   public:
+    /**
+     * @return Whether the allocations are counted in this build.
+     */
+    static bool isEnabled();
+
+    /**
+     * @return The number of allocations made by the calling thread so far.
+     */
+    static uint64_t getCount();
+};
+
+#endif
@@ -0,0 +1,321 @@
+/**
+ * @file async_service_caller.h
+ */
+
+#ifndef ASYNC_SERVICE_CALLER_H
+#define ASYNC_SERVICE_CALLER_H
+
+#include <ros/ros.h>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "latency_histogram.h"
+
+/**
+ * @brief The state of the call of an #AsyncServiceCaller.
+ */
+enum class AsyncCallStatus {
+    IDLE,       ///< No call is pending.
+    PENDING,    ///< The call is waiting for an answer.
+    SUCCEEDED,  ///< The service answered.
+    FAILED,     ///< The call failed, e.g. the service is not advertised.
+    TIMED_OUT,  ///< No answer within the timeout, the call is abandoned.
+    BUSY        ///< Calls which timed out still hold the workers, no call can be started.
+};
+
+/**
+ * @brief Calls a service from a worker thread, so that a busy service never blocks the control loop.
+ *
+ *        A call is started with #call and polled from the tick with #poll. A call which has not been answered within
+ *        the timeout is abandoned. If its worker is still stuck on it when the next call is started, the worker is
+ *        abandoned too and a new one takes over, so that the call doesn't queue behind the stuck one. The abandoned
+ *        worker finishes the call in the background, its answer is dropped even if it succeeded, and the worker
+ *        exits. A service which hangs could block its workers forever, so only one worker is abandoned at a time:
+ *        while it is stuck and the current worker gets stuck too, the caller is BUSY and no thread is started. The
+ *        latency of every call is recorded in a #LatencyHistogram, which is logged when the caller is destroyed.
+ *
+ * @tparam Service The service type.
+ */
+template <class Service>
+class AsyncServiceCaller {
+   private:
+    /**
+     * @brief The answer of a call.
+     */
+    struct Result {
+        bool success;
+        typename Service::Response response;
+        ros::WallTime answer_time;
+    };
+
+    /**
+     * @brief A call waiting for the worker.
+     */
+    struct Job {
+        typename Service::Request request;
+        std::promise<Result> promise;
+    };
+
+    /**
+     * @brief State shared with a worker. The worker keeps it alive, so the caller can be destroyed or move on to a
+     *        new worker while a call is stuck without waiting for it.
+     */
+    struct Shared {
+        ros::ServiceClient client;
+        std::string name;
+        std::deque<Job> jobs;
+        bool stopping = false;
+
+        /**
+         * @brief Whether the worker is in a call.
+         */
+        bool is_calling = false;
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    /**
+     * @brief The name of the service, used in the log.
+     */
+    const std::string name;
+
+    /**
+     * @brief Time a call may take before it is abandoned [s].
+     */
+    const double timeout;
+
+    /**
+     * @brief Used to make the calls, copied to every worker.
+     */
+    ros::ServiceClient client;
+
+    /**
+     * @brief State shared with #worker.
+     */
+    std::shared_ptr<Shared> shared_ptr;
+
+    /**
+     * @brief Makes the calls.
+     */
+    std::thread worker;
+
+    /**
+     * @brief State shared with the worker abandoned last, nullptr if none was. No other worker is abandoned while it
+     *        is still in its call.
+     */
+    std::shared_ptr<Shared> abandoned_shared_ptr;
+
+    /**
+     * @brief The answer of the pending call.
+     */
+    std::future<Result> future;
+
+    /**
+     * @brief When the pending call was started.
+     */
+    ros::WallTime call_time;
+
+    /**
+     * @brief Latencies of the calls.
+     */
+    LatencyHistogram histogram;
+
+    /**
+     * @brief Body of #worker.
+     */
+    static void run(std::shared_ptr<Shared> shared_ptr) {
+        while (true) {
+            Job job;
+
+            {
+                std::unique_lock<std::mutex> lock(shared_ptr->mutex);
+                shared_ptr->condition.wait(lock, [&]() { return shared_ptr->stopping || !shared_ptr->jobs.empty(); });
+
+                if (shared_ptr->stopping) {
+                    return;
+                }
+
+                job = std::move(shared_ptr->jobs.front());
+                shared_ptr->jobs.pop_front();
+                shared_ptr->is_calling = true;
+            }
+
+            Service service;
+            service.request = job.request;
+
+            Result result;
+            result.success = shared_ptr->client.call(service);
+            result.response = service.response;
+            result.answer_time = ros::WallTime::now();
+
+            bool is_abandoned;
+
+            // Cleared before the answer is handed over, so a caller which has seen the answer never takes the worker
+            // as stuck.
+            {
+                std::lock_guard<std::mutex> lock(shared_ptr->mutex);
+                shared_ptr->is_calling = false;
+                is_abandoned = shared_ptr->stopping;
+            }
+
+            job.promise.set_value(result);
+
+            if (is_abandoned) {
+                ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                                << ": " << shared_ptr->name.c_str() << " answered after it was abandoned, the "
+                                << (result.success ? "succeeded" : "failed") << " call is dropped.");
+                return;
+            }
+        }
+    }
+
+    /**
+     * @return Whether the worker of @p shared_ptr is in a call, false if there is no such worker.
+     */
+    static bool isCalling(const std::shared_ptr<Shared>& shared_ptr) {
+        if (!shared_ptr) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(shared_ptr->mutex);
+        return shared_ptr->is_calling;
+    }
+
+    /**
+     * @return false if #worker is stuck on a call which timed out and the worker abandoned before is still stuck
+     *         too, so that no worker is free and none can be abandoned.
+     */
+    bool canCall() const { return !isCalling(shared_ptr) || !isCalling(abandoned_shared_ptr); }
+
+    /**
+     * @brief Starts a worker with its own state.
+     */
+    void startWorker() {
+        shared_ptr = std::make_shared<Shared>();
+        shared_ptr->client = client;
+        shared_ptr->name = name;
+        worker = std::thread(&AsyncServiceCaller::run, shared_ptr);
+    }
+
+    /**
+     * @brief Tells #worker to exit once it is done with its current call, without waiting for it.
+     */
+    void stopWorker() {
+        {
+            std::lock_guard<std::mutex> lock(shared_ptr->mutex);
+            shared_ptr->stopping = true;
+        }
+
+        shared_ptr->condition.notify_one();
+        worker.detach();
+    }
+
+   public:
+    /**
+     * @brief Sets up the service client and starts the worker.
+     *
+     * @param node_handle Used to set up the service client.
+     * @param name The name of the service.
+     * @param timeout Time a call may take before it is abandoned [s].
+     */
+    AsyncServiceCaller(ros::NodeHandle& node_handle, const std::string& name, const double& timeout)
+        : name(name), timeout(timeout), client(node_handle.serviceClient<Service>(name)) {
+        startWorker();
+    }
+
+    /**
+     * @brief Stops the worker without waiting for a call in progress and logs the latencies.
+     */
+    ~AsyncServiceCaller() {
+        stopWorker();
+
+        if (histogram.getCount() > 0) {
+            ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                            << ": " << name.c_str() << " latency: " << histogram.toString().c_str());
+        }
+    }
+
+    /**
+     * @brief Starts a call.
+     *
+     * @param request The request.
+     *
+     * @return false if a call is already pending or the caller is BUSY, the request is not sent then.
+     */
+    bool call(const typename Service::Request& request) {
+        if (future.valid() || !canCall()) {
+            return false;
+        }
+
+        // The worker is still stuck on a call which timed out, a new one takes over.
+        if (isCalling(shared_ptr)) {
+            stopWorker();
+            abandoned_shared_ptr = shared_ptr;
+            startWorker();
+        }
+
+        Job job;
+        job.request = request;
+        future = job.promise.get_future();
+        call_time = ros::WallTime::now();
+
+        {
+            std::lock_guard<std::mutex> lock(shared_ptr->mutex);
+            shared_ptr->jobs.push_back(std::move(job));
+        }
+
+        shared_ptr->condition.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Checks the pending call without blocking. SUCCEEDED, FAILED and TIMED_OUT are only returned once, the
+     *        caller is IDLE afterwards, or BUSY as long as the workers are stuck on calls which timed out.
+     *
+     * @param response Set to the response if the call succeeded, can be nullptr.
+     *
+     * @return The state of the call.
+     */
+    AsyncCallStatus poll(typename Service::Response* response = nullptr) {
+        if (!future.valid()) {
+            return canCall() ? AsyncCallStatus::IDLE : AsyncCallStatus::BUSY;
+        }
+
+        if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            const Result result = future.get();
+            histogram.record((result.answer_time - call_time).toSec());
+
+            if (result.success && response) {
+                *response = result.response;
+            }
+
+            return result.success ? AsyncCallStatus::SUCCEEDED : AsyncCallStatus::FAILED;
+        }
+
+        if ((ros::WallTime::now() - call_time).toSec() > timeout) {
+            // Dropping the future doesn't wait for the worker, unlike the futures from std::async. The worker is
+            // replaced by the next call if it is still stuck then.
+            future = std::future<Result>();
+            histogram.recordTimeout();
+
+            ROS_WARN_STREAM(ros::this_node::getName().c_str() << ": " << name.c_str() << " did not answer within "
+                                                              << timeout << " s, its answer will be dropped.");
+            return AsyncCallStatus::TIMED_OUT;
+        }
+
+        return AsyncCallStatus::PENDING;
+    }
+
+    /**
+     * @return The latencies of the calls so far.
+     */
+    const LatencyHistogram& getHistogram() const { return histogram; }
+};
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file checkpoint.h
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+
+#include "state_types.h"
+
+/**
+ * @brief What Fluid needs to resume the operation it was performing after a restart.
+ *
+ *        Plain data with a fixed size, so that it lives in the mapped file as is.
+ */
+struct CheckpointState {
+    /**
+     * @brief The most points of a path which are kept, a longer path is kept as a window which follows the drone.
+     */
+    static constexpr uint32_t MAX_PATH_SIZE = 1024;
+
+    /**
+     * @brief The OperationIdentifier of the operation, UNDEFINED if there is nothing to resume.
+     */
+    uint8_t operation;
+
+    /**
+     * @brief Whether the operation had completed and the drone was holding after it.
+     */
+    uint8_t is_completed;
+
+    /**
+     * @brief The mode ArduPilot was set to for the operation, null terminated.
+     */
+    char ardupilot_mode[16];
+
+    /**
+     * @brief Parameters of the interact operation.
+     */
+    float fixed_mast_yaw, offset;
+
+    /**
+     * @brief The motion of the mast estimated by the interact operation.
+     */
+    MastEstimate mast_estimate;
+
+    /**
+     * @brief The point the explore operation looks at.
+     */
+    Vec3 point_of_interest;
+
+    /**
+     * @brief The waypoint the move operations are flying to, within #path.
+     */
+    uint32_t path_index;
+
+    /**
+     * @brief Number of points in #path.
+     */
+    uint32_t path_size;
+
+    /**
+     * @brief The path of the move operations, or the window of it starting at a waypoint not yet reached.
+     */
+    Vec3 path[MAX_PATH_SIZE];
+};
+
+/**
+ * @brief Keeps a #CheckpointState in a memory mapped file, so that it survives a crash of the process.
+ *
+ *        An update is a plain write to the mapping, the kernel writes it back to the file, so updating the
+ *        checkpoint on every tick is cheap. A sequence number is odd while an update is in progress, so that a state
+ *        torn by a crash in the middle of an update is not loaded.
+ */
+class Checkpoint {
+   private:
+    /**
+     * @brief Layout of the file.
+     */
+    struct Record {
+        /**
+         * @brief Identify the file and its layout.
+         */
+        uint32_t magic, version, size;
+
+        /**
+         * @brief Incremented before and after every update.
+         */
+        uint64_t sequence;
+
+        /**
+         * @brief Wall time of the last update [s].
+         */
+        double stamp;
+
+        CheckpointState state;
+    };
+
+    /**
+     * @brief The file, -1 if it could not be opened.
+     */
+    int file_descriptor = -1;
+
+    /**
+     * @brief The mapping of the file, nullptr if it could not be mapped.
+     */
+    Record* record = nullptr;
+
+   public:
+    /**
+     * @brief Opens and maps @p path, creating it if it does not exist. A state written by a previous run is kept
+     *        until it is updated.
+     *
+     * @param path The file.
+     */
+    explicit Checkpoint(const std::string& path);
+
+    /**
+     * @brief Unmaps and closes the file, the state stays in it.
+     */
+    ~Checkpoint();
+
+    Checkpoint(const Checkpoint&) = delete;
+    Checkpoint& operator=(const Checkpoint&) = delete;
+
+    /**
+     * @return true if the file is mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Copies the state in the file.
+     *
+     * @param state The state.
+     * @param age Time since the state was last updated [s].
+     *
+     * @return true if there is a complete state in the file.
+     */
+    bool load(CheckpointState& state, double& age) const;
+
+    /**
+     * @brief Starts an update, which has to be finished with #commit.
+     *
+     * @return The state in the file.
+     */
+    CheckpointState& edit();
+
+    /**
+     * @brief Finishes the update started with #edit.
+     *
+     * @param should_flush Whether to schedule the write back to the file now, for the updates which matter the most.
+     */
+    void commit(const bool& should_flush = false);
+};
+
+#endif
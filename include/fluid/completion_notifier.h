@@ -0,0 +1,108 @@
+/**
+ * @file completion_notifier.h
+ */
+
+#ifndef COMPLETION_NOTIFIER_H
+#define COMPLETION_NOTIFIER_H
+
+#include <ros/ros.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Delivers operation completions to the clients from a worker thread, so that a slow or missing client can
+ *        never stall the control loop.
+ *
+ *        Every completion is published on the latched fluid/operation_completed topic and sent to the
+ *        fluid/operation_completion service. Completions wait in a bounded queue, when it is full the oldest
+ *        completion is dropped and counted.
+ */
+class CompletionNotifier {
+   private:
+    /**
+     * @brief Maximum number of completions waiting to be delivered.
+     */
+    const size_t capacity;
+
+    /**
+     * @brief Completions waiting to be delivered.
+     */
+    std::deque<std::string> queue;
+
+    /**
+     * @brief Number of completions dropped because the queue was full.
+     */
+    unsigned int dropped = 0;
+
+    /**
+     * @brief Set when the worker should stop.
+     */
+    bool stopping = false;
+
+    /**
+     * @brief Guards #queue, #dropped and #stopping.
+     */
+    std::mutex mutex;
+
+    /**
+     * @brief Wakes the worker up when there is a completion to deliver or it should stop.
+     */
+    std::condition_variable condition;
+
+    /**
+     * @brief Used to set up the publisher and service client.
+     */
+    ros::NodeHandle node_handle;
+
+    /**
+     * @brief Publishes the completions on a latched topic.
+     */
+    ros::Publisher completion_publisher;
+
+    /**
+     * @brief Calls the completion service of the client.
+     */
+    ros::ServiceClient operation_completion_client;
+
+    /**
+     * @brief Delivers the completions.
+     */
+    std::thread worker;
+
+    /**
+     * @brief Body of #worker.
+     */
+    void run();
+
+   public:
+    /**
+     * @brief Sets up the publisher and service client and starts the worker.
+     *
+     * @param node_handle Node handle in the namespace of the vehicle.
+     * @param capacity Maximum number of completions waiting to be delivered.
+     */
+    explicit CompletionNotifier(const ros::NodeHandle& node_handle, const size_t& capacity = 8);
+
+    /**
+     * @brief Stops the worker, completions which are not delivered yet are discarded.
+     */
+    ~CompletionNotifier();
+
+    /**
+     * @brief Queues the completion of @p operation for delivery, never blocks on the client.
+     *
+     * @param operation The operation which completed.
+     */
+    void notify(const std::string& operation);
+
+    /**
+     * @return The number of completions dropped so far because the queue was full.
+     */
+    unsigned int getDroppedCount();
+};
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file configuration_loader.h
+ */
+
+#ifndef CONFIGURATION_LOADER_H
+#define CONFIGURATION_LOADER_H
+
+#include <ros/ros.h>
+#include <xmlrpcpp/XmlRpcValue.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+struct FluidConfiguration;
+
+/**
+ * @brief Fetches a whole parameter namespace from the parameter server in one call and hands out typed, validated
+ *        values from it.
+ *
+ *        Every parameter that is missing, has the wrong type or is out of range is recorded, so that all the
+ *        configuration errors can be reported at once instead of one per launch.
+ */
+class ConfigurationLoader {
+   private:
+    /**
+     * @brief The namespace the parameters were fetched from.
+     */
+    const std::string name_space;
+
+    /**
+     * @brief All the parameters within #name_space.
+     */
+    XmlRpc::XmlRpcValue parameters;
+
+    /**
+     * @brief Errors found while fetching and reading the parameters.
+     */
+    std::vector<std::string> errors;
+
+    /**
+     * @brief Looks up @p key, recording an error if it is not there.
+     *
+     * @param key The name of the parameter within #name_space.
+     *
+     * @return The parameter, nullptr if it is not there.
+     */
+    XmlRpc::XmlRpcValue* find(const std::string& key);
+
+    /**
+     * @brief Converts @p value to a number, accepting both integers and doubles.
+     *
+     * @param key The name of the parameter, used in the error message.
+     * @param value The parameter.
+     * @param output The number.
+     *
+     * @return true if @p value is a number.
+     */
+    bool toNumber(const std::string& key, XmlRpc::XmlRpcValue& value, double& output);
+
+    /**
+     * @brief Records an error if @p value is not within [@p min, @p max].
+     */
+    void checkRange(const std::string& key, const double& value, const double& min, const double& max);
+
+   public:
+    /**
+     * @brief Fetches all the parameters within @p name_space.
+     *
+     * @param name_space The namespace to fetch, usually the private namespace of the node.
+     */
+    explicit ConfigurationLoader(const std::string& name_space);
+
+    /**
+     * @brief Reads a boolean parameter.
+     *
+     * @param key The name of the parameter within the namespace.
+     *
+     * @return The value, false if it is missing or has the wrong type.
+     */
+    bool getBool(const std::string& key);
+
+    /**
+     * @brief Reads an integer parameter within [@p min, @p max].
+     *
+     * @param key The name of the parameter within the namespace.
+     * @param min The lowest valid value.
+     * @param max The highest valid value.
+     *
+     * @return The value, 0 if it is missing or has the wrong type.
+     */
+    int getInt(const std::string& key, const int& min, const int& max);
+
+    /**
+     * @brief Reads a floating point parameter within [@p min, @p max], integers are accepted as well.
+     *
+     * @param key The name of the parameter within the namespace.
+     * @param min The lowest valid value.
+     * @param max The highest valid value.
+     *
+     * @return The value, 0 if it is missing or has the wrong type.
+     */
+    float getFloat(const std::string& key, const float& min, const float& max);
+
+    /**
+     * @brief Reads a string parameter.
+     *
+     * @param key The name of the parameter within the namespace.
+     *
+     * @return The value, empty if it is missing or has the wrong type.
+     */
+    std::string getString(const std::string& key);
+
+    /**
+     * @return The errors found so far.
+     */
+    const std::vector<std::string>& getErrors() const;
+};
+
+/**
+ * @brief Loads the configuration of Fluid from @p name_space, logging every error found.
+ *
+ * @param name_space The private namespace of the node or nodelet.
+ *
+ * @return The configuration, nullptr if it is invalid.
+ */
+std::shared_ptr<FluidConfiguration> loadFluidConfiguration(const std::string& name_space);
+
+#endif
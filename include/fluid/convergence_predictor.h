@@ -0,0 +1,113 @@
+/**
+ * @file convergence_predictor.h
+ */
+
+#ifndef CONVERGENCE_PREDICTOR_H
+#define CONVERGENCE_PREDICTOR_H
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Vector3.h>
+
+#include <vector>
+
+/**
+ * @brief Predicts when the drone will be within a distance of a target and below a speed, so that an operation can
+ *        complete before the drone has settled completely.
+ *
+ *        Keeps a short history of the distance to the target and the speed, and fits a line to each of them. The time
+ *        to go is the time until both lines are within their tolerances. The drone counts as converged when it is
+ *        within the tolerances, or when it is approaching, slowing down and the time to go is within the horizon.
+ */
+class ConvergencePredictor {
+   private:
+    /**
+     * @brief One entry of the history.
+     */
+    struct Sample {
+        double time;
+        double distance;
+        double speed;
+    };
+
+    /**
+     * @brief Fewest samples a prediction is made from.
+     */
+    static constexpr size_t MIN_SAMPLES = 4;
+
+    /**
+     * @brief How far ahead convergence is predicted [s], 0 only accepts the current state.
+     */
+    const double horizon;
+
+    /**
+     * @brief Samples older than this compared to the newest one are not used [s].
+     */
+    const double window;
+
+    /**
+     * @brief The history, a ring where #next is the slot to write. Sized at construction to hold #window at the
+     *        highest sample rate, so that it is never reallocated.
+     */
+    std::vector<Sample> samples;
+    size_t count = 0, next = 0;
+
+    /**
+     * @brief Fits a line to the distance and the speed within #window.
+     *
+     * @param distance The fitted distance at the newest sample.
+     * @param distance_rate The rate of change of the distance.
+     * @param speed The fitted speed at the newest sample.
+     * @param speed_rate The rate of change of the speed.
+     *
+     * @return false if there are too few samples.
+     */
+    bool fit(double& distance, double& distance_rate, double& speed, double& speed_rate) const;
+
+   public:
+    /**
+     * @brief Sets up the predictor.
+     *
+     * @param horizon How far ahead convergence is predicted [s], 0 only accepts the current state.
+     * @param rate The highest rate samples are added at [Hz], twice the max rate of an operation which samples every
+     *             tick, as triggered ticks come at up to twice the rate.
+     * @param window The length of the history used [s].
+     */
+    ConvergencePredictor(const double& horizon, const int& rate, const double& window = 1.0);
+
+    /**
+     * @brief Adds a sample to the history.
+     *
+     * @param time The time of the sample [s].
+     * @param position The position of the drone.
+     * @param target The target position.
+     * @param velocity The velocity of the drone.
+     */
+    void update(const double& time,
+                const geometry_msgs::Point& position,
+                const geometry_msgs::Point& target,
+                const geometry_msgs::Vector3& velocity);
+
+    /**
+     * @brief Clears the history, has to be called when the target changes.
+     */
+    void reset();
+
+    /**
+     * @param distance_tolerance The distance to the target which counts as arrived [m].
+     * @param velocity_tolerance The speed which counts as stopped [m/s].
+     *
+     * @return The predicted time until the drone is within both tolerances [s], 0 if it already is and -1 if it is not
+     *         converging or there are too few samples.
+     */
+    double getTimeToGo(const double& distance_tolerance, const double& velocity_tolerance) const;
+
+    /**
+     * @param distance_tolerance The distance to the target which counts as arrived [m].
+     * @param velocity_tolerance The speed which counts as stopped [m/s].
+     *
+     * @return true if the drone is within both tolerances, or is predicted to be within the horizon.
+     */
+    bool hasConverged(const double& distance_tolerance, const double& velocity_tolerance) const;
+};
+
+#endif
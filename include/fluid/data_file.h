@@ -27,6 +27,17 @@ class DataFile {
     std::string m_path;
     std::string m_name;
 
+    /**
+     * @brief The file the data is appended to, kept open so that saving does not allocate.
+     */
+    std::ofstream m_file;
+
+    /**
+     * @brief Open #m_file for appending if it is not already open.
+     * 
+     * @return true if the file is open
+     */
+    bool openForAppend();
     
     public:
     DataFile(std::string name="noname.txt",std::string path = "");
@@ -36,17 +47,17 @@ class DataFile {
      * 
      * @param title array of names separated by tabulations
      */
-    void init(std::string title);
+    void init(const std::string& title);
     
     void initStateLog(); // initLog
 
-    void saveVector3(const geometry_msgs::Vector3 vec);// saveSetpointLog
+    void saveVector3(const geometry_msgs::Vector3& vec);// saveSetpointLog
 
-    void saveStateLog(const geometry_msgs::Point pose, const geometry_msgs::Vector3 vel, const geometry_msgs::Vector3 accel); //saveLog
+    void saveStateLog(const geometry_msgs::Point& pose, const geometry_msgs::Vector3& vel, const geometry_msgs::Vector3& accel); //saveLog
     
-    void saveStateLog(const mavros_msgs::PositionTarget data); //saveLog
+    void saveStateLog(const mavros_msgs::PositionTarget& data); //saveLog
     
-    void saveArray(double* vec, int n);
+    void saveArray(const double* vec, int n);
 
     void setPrecision(int precision);
 
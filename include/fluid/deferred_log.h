@@ -0,0 +1,329 @@
+/**
+ * @file deferred_log.h
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#define FLUID_LOG_LEVEL_DEBUG 0
+#define FLUID_LOG_LEVEL_INFO 1
+#define FLUID_LOG_LEVEL_WARN 2
+#define FLUID_LOG_LEVEL_ERROR 3
+#define FLUID_LOG_LEVEL_NONE 4
+
+/**
+ * @brief Messages below this level are removed at compile time, set with -DFLUID_LOG_MIN_LEVEL=...
+ */
+#ifndef FLUID_LOG_MIN_LEVEL
+#define FLUID_LOG_MIN_LEVEL FLUID_LOG_LEVEL_INFO
+#endif
+
+/**
+ * @brief Logging for the control loop, where the formatting is moved off the calling thread.
+ *
+ *        A call only stores its call site, its printf format and its raw arguments in a ring owned by the calling
+ *        thread. A background thread drains the rings, formats the messages and hands them to rosconsole, prefixed
+ *        with the node name. Every call site can be rate limited, and the calls below #FLUID_LOG_MIN_LEVEL are not
+ *        compiled at all.
+ *
+ *        The format is used after the call returns, so it has to be a string literal, and the arguments are
+ *        restricted to numbers so that no pointer is kept past the call. When a ring is full the message is dropped
+ *        and counted.
+ *
+ *        The logger is not drained when it is destroyed, as rosconsole may be gone by then. Call #flush before the
+ *        process exits to output what is left.
+ *
+ *        Use through the FLUID_LOG_* macros, e.g. FLUID_LOG_INFO_THROTTLE(1.0, "distance to ref %f", distance).
+ */
+class DeferredLog {
+   public:
+    enum class Level { DEBUG, INFO, WARN, ERROR };
+
+    /**
+     * @brief A place in the code which logs, holds its level and rate limit.
+     */
+    struct Site {
+        const Level level;
+
+        /**
+         * @brief Minimum time between two messages from this site [ns], 0 for no limit.
+         */
+        const int64_t period;
+
+        /**
+         * @brief Earliest time the next message from this site is let through [ns].
+         */
+        std::atomic<int64_t> next_time{0};
+
+        Site(const Level& level, const double& period) : level(level), period(static_cast<int64_t>(period * 1e9)) {}
+    };
+
+    /**
+     * @brief The arguments of a message, stored as they were passed.
+     */
+    template <typename... Arguments>
+    struct Pack;
+
+    /**
+     * @brief Space for the arguments of one message.
+     */
+    static constexpr size_t ARGUMENT_SIZE = 64;
+
+    /**
+     * @brief Number of messages a thread can have waiting to be formatted.
+     */
+    static constexpr size_t CAPACITY = 256;
+
+   private:
+    typedef int (*Formatter)(const char* format, const void* arguments, char* output, size_t size);
+
+    struct Record {
+        const Site* site;
+        const char* format;
+        Formatter formatter;
+        alignas(std::max_align_t) unsigned char arguments[ARGUMENT_SIZE];
+    };
+
+    /**
+     * @brief The single producer, single consumer ring of one thread.
+     */
+    struct Ring {
+        std::array<Record, CAPACITY> records;
+        std::atomic<size_t> read_index{0}, write_index{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    /**
+     * @brief The rings of all the threads which have logged, they live as long as the logger.
+     */
+    std::vector<std::unique_ptr<Ring>> rings;
+
+    /**
+     * @brief Guards #rings, and makes sure only one thread drains at a time.
+     */
+    std::mutex rings_mutex;
+
+    /**
+     * @brief Drains the rings periodically.
+     */
+    std::thread worker;
+    std::mutex worker_mutex;
+    std::condition_variable worker_condition;
+    bool should_stop = false;
+
+    DeferredLog();
+    ~DeferredLog();
+
+    /**
+     * @return The ring of the calling thread, created the first time the thread logs.
+     */
+    Ring& getRing();
+
+    /**
+     * @return Whether the rate limit of @p site lets a message through now.
+     */
+    static bool isAllowed(Site& site);
+
+    /**
+     * @brief Stores a message in the ring of the calling thread.
+     */
+    void push(const Site& site, const char* format, Formatter formatter, const void* arguments, const size_t& size);
+
+    /**
+     * @brief Formats and outputs the messages of every ring.
+     */
+    void drain();
+
+    /**
+     * @brief Outputs a formatted message with rosconsole.
+     */
+    static void output(const Level& level, const char* message);
+
+    template <typename... Arguments, size_t... indices>
+    static int format(const char* format,
+                      const Pack<Arguments...>& pack,
+                      char* output,
+                      size_t size,
+                      std::index_sequence<indices...>);
+
+    /**
+     * @brief Formats a message with the argument types @p Arguments, the formatter of every record.
+     */
+    template <typename... Arguments>
+    static int formatPack(const char* format, const void* arguments, char* output, size_t size);
+
+   public:
+    /**
+     * @return The logger, the background thread is started on the first call.
+     */
+    static DeferredLog& getInstance();
+
+    /**
+     * @brief Logs a message from @p site, unless the rate limit of the site holds it back.
+     *
+     * @param site The call site.
+     * @param format printf format, has to be a string literal.
+     * @param arguments Numbers.
+     */
+    template <size_t size, typename... Arguments>
+    static void log(Site& site, const char (&format)[size], const Arguments&... arguments);
+
+    /**
+     * @brief Formats and outputs every message logged so far before returning. Called before the process exits,
+     *        as the messages still waiting are not output when the logger is destroyed.
+     */
+    void flush();
+};
+
+template <>
+struct DeferredLog::Pack<> {};
+
+template <typename First, typename... Rest>
+struct DeferredLog::Pack<First, Rest...> {
+    First first;
+    Pack<Rest...> rest;
+
+    Pack(const First& first, const Rest&... rest) : first(first), rest(rest...) {}
+};
+
+namespace deferred_log_detail {
+
+/**
+ * @brief Gets argument @p index out of a pack.
+ */
+template <size_t index>
+struct Get {
+    template <typename PackType>
+    static const auto& from(const PackType& pack) {
+        return Get<index - 1>::from(pack.rest);
+    }
+};
+
+template <>
+struct Get<0> {
+    template <typename PackType>
+    static const auto& from(const PackType& pack) {
+        return pack.first;
+    }
+};
+
+}  // namespace deferred_log_detail
+
+template <typename... Arguments, size_t... indices>
+int DeferredLog::format(const char* format,
+                        const Pack<Arguments...>& pack,
+                        char* output,
+                        size_t size,
+                        std::index_sequence<indices...>) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-security"
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+    return std::snprintf(output, size, format, deferred_log_detail::Get<indices>::from(pack)...);
+#pragma GCC diagnostic pop
+}
+
+template <typename... Arguments>
+int DeferredLog::formatPack(const char* format, const void* arguments, char* output, size_t size) {
+    return DeferredLog::format(format, *static_cast<const Pack<Arguments...>*>(arguments), output, size,
+                               std::index_sequence_for<Arguments...>());
+}
+
+namespace deferred_log_detail {
+
+/**
+ * @brief Whether all of @p Arguments are numbers.
+ */
+template <typename... Arguments>
+struct AreArithmetic : std::true_type {};
+
+template <typename First, typename... Rest>
+struct AreArithmetic<First, Rest...>
+    : std::integral_constant<bool, std::is_arithmetic<First>::value && AreArithmetic<Rest...>::value> {};
+
+}  // namespace deferred_log_detail
+
+template <size_t size, typename... Arguments>
+void DeferredLog::log(Site& site, const char (&format)[size], const Arguments&... arguments) {
+    typedef Pack<typename std::decay<const Arguments>::type...> PackType;
+
+    static_assert(sizeof(PackType) <= ARGUMENT_SIZE, "Too many arguments for a deferred log message");
+    // A pointer, e.g. from c_str(), could dangle by the time the message is formatted.
+    static_assert(deferred_log_detail::AreArithmetic<typename std::decay<Arguments>::type...>::value,
+                  "Deferred log arguments have to be numbers");
+
+    if (!isAllowed(site)) {
+        return;
+    }
+
+    const PackType pack(arguments...);
+    getInstance().push(site, format, &formatPack<typename std::decay<const Arguments>::type...>, &pack,
+                       sizeof(pack));
+}
+
+/**
+ * @brief Checks the format against the arguments with -Wformat at the call site, the format is only passed on as a
+ *        pointer afterwards. Not evaluated.
+ */
+#define FLUID_LOG_CHECK_FORMAT(...) static_cast<void>(sizeof(std::printf(__VA_ARGS__)))
+
+/**
+ * @brief Declares a call site and logs through it.
+ */
+#define FLUID_LOG_DEFERRED(level, period, ...)                                    \
+    do {                                                                          \
+        FLUID_LOG_CHECK_FORMAT(__VA_ARGS__);                                      \
+        static DeferredLog::Site fluid_log_site(level, period);                   \
+        DeferredLog::log(fluid_log_site, __VA_ARGS__);                            \
+    } while (0)
+
+/**
+ * @brief Logs nothing, but still checks the format so that a message doesn't break when its level is enabled.
+ */
+#define FLUID_LOG_DISABLED(...)               \
+    do {                                      \
+        FLUID_LOG_CHECK_FORMAT(__VA_ARGS__);  \
+    } while (0)
+
+#if FLUID_LOG_MIN_LEVEL <= FLUID_LOG_LEVEL_DEBUG
+#define FLUID_LOG_DEBUG_THROTTLE(period, ...) FLUID_LOG_DEFERRED(DeferredLog::Level::DEBUG, period, __VA_ARGS__)
+#else
+#define FLUID_LOG_DEBUG_THROTTLE(period, ...) FLUID_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if FLUID_LOG_MIN_LEVEL <= FLUID_LOG_LEVEL_INFO
+#define FLUID_LOG_INFO_THROTTLE(period, ...) FLUID_LOG_DEFERRED(DeferredLog::Level::INFO, period, __VA_ARGS__)
+#else
+#define FLUID_LOG_INFO_THROTTLE(period, ...) FLUID_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if FLUID_LOG_MIN_LEVEL <= FLUID_LOG_LEVEL_WARN
+#define FLUID_LOG_WARN_THROTTLE(period, ...) FLUID_LOG_DEFERRED(DeferredLog::Level::WARN, period, __VA_ARGS__)
+#else
+#define FLUID_LOG_WARN_THROTTLE(period, ...) FLUID_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if FLUID_LOG_MIN_LEVEL <= FLUID_LOG_LEVEL_ERROR
+#define FLUID_LOG_ERROR_THROTTLE(period, ...) FLUID_LOG_DEFERRED(DeferredLog::Level::ERROR, period, __VA_ARGS__)
+#else
+#define FLUID_LOG_ERROR_THROTTLE(period, ...) FLUID_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#define FLUID_LOG_DEBUG(...) FLUID_LOG_DEBUG_THROTTLE(0, __VA_ARGS__)
+#define FLUID_LOG_INFO(...) FLUID_LOG_INFO_THROTTLE(0, __VA_ARGS__)
+#define FLUID_LOG_WARN(...) FLUID_LOG_WARN_THROTTLE(0, __VA_ARGS__)
+#define FLUID_LOG_ERROR(...) FLUID_LOG_ERROR_THROTTLE(0, __VA_ARGS__)
+
+#endif
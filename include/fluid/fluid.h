@@ -13,19 +13,34 @@
 #define FLUID_H
 
 #include <fluid/Explore.h>
+#include <fluid/FollowTrajectory.h>
 #include <fluid/Interact.h>
 #include <fluid/Land.h>
-#include <fluid/OperationCompletion.h>
+#include <fluid/Mission.h>
 #include <fluid/TakeOff.h>
 #include <fluid/Travel.h>
 #include <geometry_msgs/Point32.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 
+#include <atomic>
+#include <future>
+#include <list>
 #include <map>
 #include <memory>
+#include <thread>
 
+#include "checkpoint.h"
+#include "completion_notifier.h"
+#include "latency_histogram.h"
+#include "latency_monitor.h"
+#include "mavros_interface.h"
 #include "operation.h"
+#include "operation_action_server.h"
+#include "startup_timeline.h"
+#include "state_hub.h"
 #include "status_publisher.h"
+#include "tick_trigger.h"
 
 /**
  * @brief Defines all the parameters for fluid.
@@ -42,10 +57,56 @@ struct FluidConfiguration {
     const bool use_perception;
 
     /**
-     * @brief The unified refresh rate across the operation machine.
+     * @brief The default refresh rate across the operation machine, used by operations which don't declare their own.
      */
     const int refresh_rate;
 
+    /**
+     * @brief The nominal refresh rate of the interact operation.
+     */
+    const int interact_refresh_rate;
+
+    /**
+     * @brief The refresh rate the interact operation goes up to when it is close to the mast.
+     */
+    const int interact_max_refresh_rate;
+
+    /**
+     * @brief The refresh rate of the hold operation.
+     */
+    const int hold_refresh_rate;
+
+    /**
+     * @brief The rate ArduPilot is requested to stream its telemetry at.
+     */
+    const int fcu_stream_rate;
+
+    /**
+     * @brief The maximum rate feedback is published at for the active action goal.
+     */
+    const float action_feedback_rate;
+
+    /**
+     * @brief The refresh rate of the follow trajectory operation.
+     */
+    const int trajectory_refresh_rate;
+
+    /**
+     * @brief How long the follow trajectory operation holds the last sample before it finishes [s], so that a late
+     *        chunk continues the trajectory instead of ending the operation.
+     */
+    const float trajectory_end_grace_period;
+
+    /**
+     * @brief Whether fluid broadcasts the pose as the base_link transform, instead of the base_link_publisher.
+     */
+    const bool should_broadcast_base_link;
+
+    /**
+     * @brief The maximum rate the base_link transform is broadcasted at.
+     */
+    const float base_link_rate;
+
     /**
      * @brief Whether the drone will arm automatically.
      */
@@ -89,6 +150,11 @@ struct FluidConfiguration {
      */
     const float interact_max_acc;  
 
+    /**
+     * @brief Use the model predictive controller to follow the mast during the interact operation.
+     */
+    const bool interact_use_mpc;
+
     /**
      * @brief max angle ardupilot parameter for the travel operation.
      */
@@ -108,41 +174,190 @@ struct FluidConfiguration {
      * @brief max accel ardupilot parameter for the travel operation.
      */
     const float travel_accel;  
+
+    /**
+     * @brief How far the paths of the move operations may be moved when they are simplified, 0 disables it.
+     */
+    const float path_tolerance;
+
+    /**
+     * @brief Consecutive points of the paths of the move operations closer than this are merged.
+     */
+    const float path_min_spacing;
+
+    /**
+     * @brief The segments of the paths of the move operations are split up to be no longer than this, 0 disables it.
+     */
+    const float path_resample_spacing;
+
+    /**
+     * @brief How far ahead the operations may predict that the drone reaches its target and settles to complete
+     *        early, 0 makes them wait until it has.
+     */
+    const float completion_horizon;
+
+    /**
+     * @brief Whether an operation starts with the velocity the drone had when it took over, instead of commanding it
+     *        to stop first.
+     */
+    const bool velocity_handover;
+
+    /**
+     * @brief Whether the land operation descends fast under velocity control in guided and flares before
+     *        touchdown, instead of leaving the descent to the land mode of ArduPilot.
+     */
+    const bool fast_landing;
+
+    /**
+     * @brief Descent speed of the fast landing down to #land_flare_height [m/s].
+     */
+    const float land_descent_speed;
+
+    /**
+     * @brief Height the fast landing slows down to #land_final_speed at [m].
+     */
+    const float land_flare_height;
+
+    /**
+     * @brief Descent speed of the fast landing from #land_flare_height to touchdown [m/s].
+     */
+    const float land_final_speed;
+
+    /**
+     * @brief File the state of the operation machine is checkpointed to, so that it resumes the interrupted
+     *        operation after a restart. Empty disables it.
+     */
+    const std::string checkpoint_file;
+
+    /**
+     * @brief Topic the latency from an input to the setpoint is measured on, e.g. the odometry of the drone or the
+     *        state of the mast. Empty disables it.
+     */
+    const std::string tick_trigger_topic;
+
+    /**
+     * @brief Whether the main loop ticks when a message arrives on #tick_trigger_topic, with the period of the
+     *        operation as a fallback, instead of at the fixed rate of the operation.
+     */
+    const bool tick_on_trigger;
 };
 
 /**
- * @brief The main class for the FSM.
+ * @brief The main class for the FSM, one instance controls one vehicle.
+ *
+ *        Several instances can run in the same process, each in the namespace of its vehicle. All the topics,
+ *        services and actions of an instance are resolved within that namespace, and its callbacks are only handled
+ *        within its own #step, so an instance is never accessed by two threads at once.
  */
 class Fluid {
    private:
     /**
-     * @brief Only instance to this class.
+     * @brief Interface for publishing status messages.
      */
-    static std::shared_ptr<Fluid> instance_ptr;
+    std::shared_ptr<StatusPublisher> status_publisher_ptr;
 
     /**
-     * @brief Interface for publishing status messages.
+     * @brief Keeps track of the latency of the inputs and publishes it as diagnostics.
      */
-    std::shared_ptr<StatusPublisher> status_publisher_ptr;
+    std::shared_ptr<LatencyMonitor> latency_monitor_ptr;
+
+    /**
+     * @brief The latest state of the drone, shared by the operations.
+     */
+    std::shared_ptr<StateHub> state_hub_ptr;
+
+    /**
+     * @brief Records the startup stages of the node.
+     */
+    std::shared_ptr<StartupTimeline> startup_timeline_ptr;
+
+    /**
+     * @brief The queue the callbacks of the services, actions, operations and status are put on and which the main
+     *        loop spins. The global queue when running as a node, a queue owned by the nodelet when running as a
+     *        nodelet, as the global queue of a nodelet manager is spun by the manager's own threads.
+     */
+    ros::CallbackQueue* callback_queue;
+
+    /**
+     * @brief Set by #stop to make the main loop return.
+     */
+    std::atomic<bool> should_stop{false};
+
+    /**
+     * @brief Queue for the callbacks used by #fcu_link_thread, so that it can spin independently of the main loop.
+     */
+    ros::CallbackQueue fcu_link_callback_queue;
+
+    /**
+     * @brief Establishes the link with ArduPilot and sets up the telemetry streams while the rest of the node
+     *        starts up.
+     */
+    std::thread fcu_link_thread;
+
+    /**
+     * @brief Set by #fcu_link_thread when the link with ArduPilot is up and the streams are set up.
+     */
+    std::atomic<bool> linked_with_ardupilot{false};
+
+    /**
+     * @brief Body of #fcu_link_thread.
+     */
+    void establishFcuLink();
+
+    /**
+     * @brief Sets the ArduPilot mode of the operations.
+     */
+    std::shared_ptr<MavrosInterface> mavros_interface_ptr;
+
+    /**
+     * @brief The mode request sent for the next operation, and the mode it asks for. The transition waits for its
+     *        answer over several steps instead of blocking the step.
+     */
+    std::future<bool> mode_request;
+    std::string mode_request_mode;
+
+    /**
+     * @brief A parameter being set within ArduPilot.
+     */
+    struct ParamRequest {
+        std::string parameter;
+        float value;
+
+        /**
+         * @brief The answer to the last request, invalid while waiting to send it again.
+         */
+        std::future<bool> result;
+
+        /**
+         * @brief When the request was last sent.
+         */
+        ros::Time request_time;
+    };
+
+    /**
+     * @brief The parameters which ArduPilot hasn't accepted yet.
+     */
+    std::list<ParamRequest> param_requests;
 
     /**
-     * @brief Sets up the service servers and clients.
+     * @brief Checks the answers to #param_requests without blocking and sends the failed ones again.
      */
-    Fluid(const FluidConfiguration configuration) : configuration(configuration) {
-        take_off_server = node_handle.advertiseService("fluid/take_off", &Fluid::take_off, this);
-        travel_server = node_handle.advertiseService("fluid/travel", &Fluid::travel, this);
-        explore_server = node_handle.advertiseService("fluid/explore", &Fluid::explore, this);
-        interact_server = node_handle.advertiseService("fluid/interact", &Fluid::interact, this);
-        land_server = node_handle.advertiseService("fluid/land", &Fluid::land, this);
-        operation_completion_client =
-            node_handle.serviceClient<fluid::OperationCompletion>("fluid/operation_completion");
-        status_publisher_ptr = std::make_shared<StatusPublisher>();
-    }
+    void pollParamRequests();
 
     /**
-     * @brief Kept hidden since this class is a singleton.
+     * @brief State of the operation machine kept between two steps.
      */
-    //Fluid& operator=(Fluid const&){}; //commented because it builds without and it created warnings
+    bool has_started = false, has_reported_startup = false, has_called_completion = false;
+
+    /**
+     * @brief Whether #current_operation_ptr has begun and is being stepped.
+     */
+    bool is_performing = false;
+
+    /**
+     * @brief Whether the operation being performed halts if it is steady, set when it begins.
+     */
+    bool should_halt_if_steady = false;
 
     /**
      * @brief Mapping for responses in service calls.
@@ -182,19 +397,83 @@ class Fluid {
     bool got_new_operation = false;
 
     /**
-     * @brief Used to initialize the service servers.
+     * @brief Used to initialize the service servers, in the namespace of the vehicle and on #callback_queue.
      */
     ros::NodeHandle node_handle;
 
     /**
      * @brief The servers which advertise the operations.
      */
-    ros::ServiceServer take_off_server, travel_server, explore_server, interact_server, land_server;
+    ros::ServiceServer take_off_server, travel_server, explore_server, interact_server, land_server, mission_server,
+        follow_trajectory_server;
+
+    /**
+     * @brief Used to give completion calls of operations without blocking the main loop.
+     */
+    std::shared_ptr<CompletionNotifier> completion_notifier_ptr;
+
+    /**
+     * @brief The action servers of the operations.
+     */
+    std::vector<std::shared_ptr<OperationActionServerInterface>> action_servers;
+
+    /**
+     * @brief The action server whose goal is being executed, nullptr if the operation was not started through an
+     *        action.
+     */
+    OperationActionServerInterface* active_action_server = nullptr;
 
     /**
-     * @brief Used to give completion calls of operations.
+     * @brief When feedback was published the last time.
      */
-    ros::ServiceClient operation_completion_client;
+    ros::Time last_feedback_time;
+
+    /**
+     * @brief Sets up the action servers of all the operations.
+     */
+    void advertiseActionServers();
+
+    /**
+     * @brief Sets up an action server which starts the operations created by @p create_execution_queue.
+     *
+     * @tparam ActionSpec The action type.
+     * @param name The name of the action.
+     * @param target_operation_identifier The operation the action starts.
+     * @param create_execution_queue Creates the execution queue for a goal.
+     */
+    template <class ActionSpec>
+    void advertiseActionServer(const std::string& name,
+                               const OperationIdentifier& target_operation_identifier,
+                               std::function<std::list<std::shared_ptr<Operation>>(
+                                   const typename OperationActionServer<ActionSpec>::Goal&)> create_execution_queue);
+
+    /**
+     * @brief Aborts the goal of #active_action_server since another operation takes over.
+     *
+     * @param operation The operation which takes over.
+     */
+    void supersedeActionGoal(const std::string& operation);
+
+    /**
+     * @brief Stops the operation of a preempted goal of @p server, the drone holds its position, or lands if it
+     *        was taking off.
+     *
+     * @param server The server whose goal was preempted.
+     */
+    void cancelActionGoal(OperationActionServerInterface* server);
+
+    /**
+     * @return The operation to fall back to when the current one is stopped, hold, or land if it was taking off.
+     */
+    std::shared_ptr<Operation> createFallbackOperation();
+
+    /**
+     * @brief Aborts the goal of the current operation, which has failed, and falls back to
+     *        #createFallbackOperation.
+     *
+     * @param reason Why the operation failed.
+     */
+    void handleFailedOperation(const std::string& reason);
 
     /**
      * @brief Service handler for the take off service.
@@ -246,6 +525,36 @@ class Fluid {
      */
     bool land(fluid::Land::Request& request, fluid::Land::Response& response);
 
+    /**
+     * @brief Service handler for the follow trajectory service.
+     *
+     * @param request The follow trajectory request.
+     * @param response The follow trajectory response.
+     *
+     * @return true When the service call has been handled.
+     */
+    bool follow_trajectory(fluid::FollowTrajectory::Request& request, fluid::FollowTrajectory::Response& response);
+
+    /**
+     * @brief Service handler for the mission service. Validates the whole chain of operations up front and queues
+     *        them so they are executed back to back.
+     *
+     * @param request The mission request.
+     * @param response The mission response.
+     *
+     * @return true When the service call has been handled.
+     */
+    bool mission(fluid::Mission::Request& request, fluid::Mission::Response& response);
+
+    /**
+     * @brief Creates the operation for a mission item.
+     *
+     * @param item The mission item.
+     *
+     * @return The operation, nullptr if the operation type of @p item is unknown.
+     */
+    std::shared_ptr<Operation> createOperationForMissionItem(const fluid::MissionItem& item);
+
     /**
      * @brief Will check if the operation to @p target_operation_identifier is valid and update the
      * #operation_execution_queue and #current_operation if it is.
@@ -279,35 +588,110 @@ class Fluid {
                           const OperationIdentifier& target_operation_identifier) const;
 
     /**
-     * @brief Performs operation transition between @p current_operation_ptr and @p target_operation_ptr.
+     * @brief Attempts the transition from #current_operation_ptr to @p target_operation_ptr, which happens once
+     *        ArduPilot is in the mode of the target operation.
      *
-     * @param current_operation_ptr The current operation.
      * @param target_operation_ptr The target operation.
      *
-     * @return The new operation (@p target_operation_ptr).
+     * @return true if the target operation is now #current_operation_ptr.
+     */
+    bool performOperationTransition(std::shared_ptr<Operation> target_operation_ptr);
+
+    /**
+     * @brief Keeps the operation being performed in FluidConfiguration::checkpoint_file, nullptr if it is disabled.
      */
-    std::shared_ptr<Operation> performOperationTransition(std::shared_ptr<Operation> current_operation_ptr,
-                                                          std::shared_ptr<Operation> target_operation_ptr);
+    std::unique_ptr<Checkpoint> checkpoint_ptr;
+
+    /**
+     * @brief The checkpoint left by the previous run, nullptr if there is nothing to resume.
+     */
+    std::unique_ptr<CheckpointState> resume_state_ptr;
+
+    /**
+     * @brief Tells when an input arrives on FluidConfiguration::tick_trigger_topic, nullptr if no topic is set.
+     */
+    std::unique_ptr<TickTrigger> tick_trigger_ptr;
+
+    /**
+     * @brief Time from the arrival of an input on the trigger topic to the end of the first step which used it.
+     */
+    LatencyHistogram input_latency_histogram;
+
+    /**
+     * @brief Arrival of the last input recorded in #input_latency_histogram.
+     */
+    ros::WallTime last_input_arrival_time;
+
+    /**
+     * @brief When #input_latency_histogram was last reported.
+     */
+    ros::WallTime last_latency_report_time;
+
+    /**
+     * @brief Records the latency of the input which arrived at @p arrival_time if it is new, and reports the
+     *        histogram periodically.
+     *
+     * @param arrival_time Arrival of the last input before the step.
+     */
+    void recordInputLatency(const ros::WallTime& arrival_time);
+
+    /**
+     * @brief Opens the checkpoint of the vehicle and keeps the state left by the previous run if it is recent enough
+     *        to be resumed.
+     *
+     * @param name_space The namespace of the vehicle, which tells the checkpoints of several vehicles apart.
+     */
+    void openCheckpoint(const std::string& name_space);
+
+    /**
+     * @brief Queues the operations which resume #resume_state_ptr once the state of the drone is known, unless the
+     *        drone has been disarmed, taken over or given another operation in the meantime.
+     */
+    void resumeFromCheckpoint();
+
+    /**
+     * @brief Creates the operations which resume @p state: a hold, then the interrupted operation from where it
+     *        was, then the hold or land which ends it.
+     *
+     * @param state The checkpoint.
+     *
+     * @return The operations.
+     */
+    std::list<std::shared_ptr<Operation>> createOperationsForCheckpoint(const CheckpointState& state);
+
+    /**
+     * @brief Writes #current_operation_ptr to the checkpoint when it has begun.
+     */
+    void saveCheckpoint();
 
    public:
     /**
-     * @brief The configuration of the fluid singleton.
+     * @brief The configuration of this instance.
      */
     const FluidConfiguration configuration;
 
     /**
-     * @brief Initializes the Fluid singleton with a @p configuration.
+     * @brief Starts the FCU link and sets up the service servers and clients.
      *
-     * @param configuration The configuration of the Fluid singleton.
-     *
-     * @note Will only actually initialize if #instance_ptr is not nullptr.
+     * @param configuration The configuration of the instance.
+     * @param name_space The namespace of the vehicle, the topics, services and actions are resolved within it. The
+     *                   namespace of the node if empty.
+     * @param callback_queue The queue the main loop spins, the global queue if nullptr.
+     * @param startup_timeline_ptr The timeline the startup stages are recorded in, a new one is started if it is
+     *                             nullptr.
+     * @param status_publisher_ptr Publishes the status of the instance, one is set up in @p name_space if it is
+     *                             nullptr.
      */
-    static void initialize(const FluidConfiguration configuration);
+    Fluid(const FluidConfiguration& configuration,
+          const std::string& name_space = "",
+          ros::CallbackQueue* callback_queue = nullptr,
+          std::shared_ptr<StartupTimeline> startup_timeline_ptr = nullptr,
+          std::shared_ptr<StatusPublisher> status_publisher_ptr = nullptr);
 
     /**
-     * @return The Fluid singleton instance.
+     * @brief Waits for the FCU link thread to finish.
      */
-    static Fluid& getInstance();
+    ~Fluid();
 
     /**
      * @return The status publisher.
@@ -315,9 +699,74 @@ class Fluid {
     std::shared_ptr<StatusPublisher> getStatusPublisherPtr();
 
     /**
-     * @brief Runs the operation macine.
+     * @return The latency monitor.
+     */
+    std::shared_ptr<LatencyMonitor> getLatencyMonitorPtr();
+
+    /**
+     * @return The state hub.
+     */
+    std::shared_ptr<StateHub> getStateHubPtr();
+
+    /**
+     * @return The queue the main loop spins, subscribers which are handled in the main loop have to use it.
+     */
+    ros::CallbackQueue* getCallbackQueue() const;
+
+    /**
+     * @return A node handle in the namespace of the vehicle which puts its callbacks on the queue of the main loop.
+     */
+    const ros::NodeHandle& getNodeHandle() const;
+
+    /**
+     * @brief Calls the callbacks waiting in the queue of the main loop, used instead of ros::spinOnce.
+     */
+    void spinOnce();
+
+    /**
+     * @brief Publishes the progress of @p operation as feedback for the active action goal, throttled to
+     *        FluidConfiguration::action_feedback_rate.
+     *
+     * @param operation The operation being executed.
+     */
+    void publishActionFeedback(const Operation& operation);
+
+    /**
+     * @return true when the link with ArduPilot is established and the telemetry streams are set up.
+     */
+    bool isLinkedWithArduPilot() const;
+
+    /**
+     * @brief Sets a parameter within ArduPilot without waiting for the answer. The request is sent again from the
+     *        following steps until ArduPilot accepts it, and replaces an earlier request for the same parameter.
+     *
+     * @param parameter The parameter to set.
+     * @param value The new value.
+     */
+    void setParam(const std::string& parameter, const float& value);
+
+    /**
+     * @brief Runs one iteration of the operation machine: transitions to the next queued operation, or steps the
+     *        current operation once.
+     *
+     * @return The time until the next step is due.
+     */
+    ros::Duration step();
+
+    /**
+     * @brief Steps the operation machine on the calling thread until ROS shuts down or #stop is called.
      */
     void run();
+
+    /**
+     * @brief Makes #run return after the current tick, can be called from any thread.
+     */
+    void stop();
+
+    /**
+     * @return true if ROS has shut down or #stop was called, the instance shouldn't be stepped anymore.
+     */
+    bool isStopped() const;
 };
 
 #endif
\ No newline at end of file
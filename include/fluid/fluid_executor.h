@@ -0,0 +1,107 @@
+/**
+ * @file fluid_executor.h
+ */
+
+#ifndef FLUID_EXECUTOR_H
+#define FLUID_EXECUTOR_H
+
+#include <ros/ros.h>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "fluid.h"
+
+/**
+ * @brief Runs the operation machines of several vehicles on a shared pool of threads, instead of one thread per
+ *        vehicle.
+ *
+ *        Every instance is stepped at the rate its current operation asks for, the step which is due first is run
+ *        first. An instance is taken out of the schedule while it is stepped, so it is never stepped by two threads
+ *        at once. A step which is late because all the threads were busy is run as soon as a thread frees up, and
+ *        the schedule of that instance starts over from there.
+ */
+class FluidExecutor {
+   private:
+    /**
+     * @brief The next step of an instance.
+     */
+    struct Entry {
+        ros::Time due_time;
+        std::shared_ptr<Fluid> fluid_ptr;
+
+        bool operator>(const Entry& other) const { return due_time > other.due_time; }
+    };
+
+    /**
+     * @brief The instances waiting for their next step, the one due first on top.
+     */
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> schedule;
+
+    /**
+     * @brief Number of instances which are scheduled or being stepped.
+     */
+    size_t active_count = 0;
+
+    /**
+     * @brief Set by #stop.
+     */
+    bool should_stop = false;
+
+    /**
+     * @brief Guards #schedule, #active_count and #should_stop.
+     */
+    std::mutex mutex;
+
+    /**
+     * @brief Wakes the threads up when the schedule changes, and #wait when the instances are done.
+     */
+    std::condition_variable condition;
+
+    /**
+     * @brief The pool.
+     */
+    std::vector<std::thread> threads;
+
+    /**
+     * @brief Body of the threads in the pool.
+     */
+    void work();
+
+   public:
+    /**
+     * @brief Starts the pool.
+     *
+     * @param thread_count Number of threads in the pool, at least one.
+     */
+    explicit FluidExecutor(const unsigned int& thread_count);
+
+    /**
+     * @brief Stops the pool, the instances are not stepped anymore.
+     */
+    ~FluidExecutor();
+
+    /**
+     * @brief Schedules the first step of @p fluid_ptr now, it is stepped until it is stopped.
+     *
+     * @param fluid_ptr The instance.
+     */
+    void add(std::shared_ptr<Fluid> fluid_ptr);
+
+    /**
+     * @brief Blocks until all the instances are stopped or ROS shuts down.
+     */
+    void wait();
+
+    /**
+     * @brief Makes the threads return after their current step, can be called from any thread.
+     */
+    void stop();
+};
+
+#endif
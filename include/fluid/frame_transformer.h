@@ -0,0 +1,176 @@
+/**
+ * @file frame_transformer.h
+ */
+
+#ifndef FRAME_TRANSFORMER_H
+#define FRAME_TRANSFORMER_H
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Vector3.h>
+#include <mavros_msgs/PositionTarget.h>
+
+#include <vector>
+
+#include "state_types.h"
+
+/**
+ * @brief Transforms between the world frame, the mast frame, the drone body frame and the FaceHugger.
+ *
+ *        The mast and drone body frames only differ from the world frame by a yaw rotation. The rotation matrices
+ *        are cached and only recomputed when the corresponding yaw actually changes, so the transforms can be
+ *        called several times per tick without evaluating any trigonometric functions.
+ */
+class FrameTransformer {
+   private:
+    /**
+     * @brief Yaw of the mast frame compared to the world frame.
+     */
+    float mast_yaw;
+
+    /**
+     * @brief Cached yaw rotation matrix of the mast frame, stored as cos(yaw) and sin(yaw).
+     */
+    double mast_cos_yaw, mast_sin_yaw;
+
+    /**
+     * @brief Yaw of the drone body frame compared to the world frame.
+     */
+    float drone_yaw;
+
+    /**
+     * @brief Cached yaw rotation matrix of the drone body frame, stored as cos(yaw) and sin(yaw).
+     */
+    double drone_cos_yaw, drone_sin_yaw;
+
+    /**
+     * @brief 3D offset of the FaceHugger compared to the drone centre.
+     */
+    geometry_msgs::Point fh_offset;
+
+    /**
+     * @brief Rotates @p in around the z axis with the rotation matrix given by @p cos_yaw and @p sin_yaw.
+     */
+    template <typename T>
+    static T rotate(const T& in, const double& cos_yaw, const double& sin_yaw) {
+        T out;
+        out.x = cos_yaw * in.x - sin_yaw * in.y;
+        out.y = cos_yaw * in.y + sin_yaw * in.x;
+        out.z = in.z;
+        return out;
+    }
+
+    /**
+     * @brief Rotates the position, velocity and acceleration of @p in, the header and the rest of the fields are kept.
+     */
+    static mavros_msgs::PositionTarget rotate(const mavros_msgs::PositionTarget& in,
+                                              const double& cos_yaw,
+                                              const double& sin_yaw);
+    static PVAState rotate(const PVAState& in, const double& cos_yaw, const double& sin_yaw);
+
+   public:
+    /**
+     * @brief Sets up the transformer.
+     *
+     * @param mast_yaw The fixed yaw of the mast compared to the world frame.
+     * @param fh_offset 3D offset of the FaceHugger compared to the drone centre.
+     */
+    explicit FrameTransformer(const float& mast_yaw = 0.0, const geometry_msgs::Point& fh_offset = {});
+
+    /**
+     * @brief Updates the yaw of the mast frame, the rotation matrix is only recomputed if @p yaw changed.
+     *
+     * @param yaw The yaw of the mast compared to the world frame.
+     */
+    void setMastYaw(const float& yaw);
+
+    /**
+     * @brief Updates the yaw of the drone body frame, the rotation matrix is only recomputed if @p yaw changed.
+     *
+     * @param yaw The yaw of the drone compared to the world frame.
+     */
+    void setDroneYaw(const float& yaw);
+
+    /**
+     * @return The yaw of the mast frame.
+     */
+    float getMastYaw() const;
+
+    /**
+     * @return The 3D offset of the FaceHugger compared to the drone centre.
+     */
+    const geometry_msgs::Point& getFaceHuggerOffset() const;
+
+    /**
+     * @brief Rotates a quantity expressed in the mast frame into the world frame.
+     */
+    geometry_msgs::Point mastToWorld(const geometry_msgs::Point& point) const;
+    geometry_msgs::Vector3 mastToWorld(const geometry_msgs::Vector3& vector) const;
+    mavros_msgs::PositionTarget mastToWorld(const mavros_msgs::PositionTarget& state) const;
+    Vec3 mastToWorld(const Vec3& vector) const;
+    PVAState mastToWorld(const PVAState& state) const;
+
+    /**
+     * @brief Rotates a quantity expressed in the world frame into the mast frame.
+     */
+    geometry_msgs::Point worldToMast(const geometry_msgs::Point& point) const;
+    geometry_msgs::Vector3 worldToMast(const geometry_msgs::Vector3& vector) const;
+    mavros_msgs::PositionTarget worldToMast(const mavros_msgs::PositionTarget& state) const;
+    Vec3 worldToMast(const Vec3& vector) const;
+    PVAState worldToMast(const PVAState& state) const;
+
+    /**
+     * @brief Rotates a quantity expressed in the drone body frame into the world frame.
+     */
+    geometry_msgs::Point bodyToWorld(const geometry_msgs::Point& point) const;
+    geometry_msgs::Vector3 bodyToWorld(const geometry_msgs::Vector3& vector) const;
+    mavros_msgs::PositionTarget bodyToWorld(const mavros_msgs::PositionTarget& state) const;
+
+    /**
+     * @brief Rotates a quantity expressed in the world frame into the drone body frame.
+     */
+    geometry_msgs::Point worldToBody(const geometry_msgs::Point& point) const;
+    geometry_msgs::Vector3 worldToBody(const geometry_msgs::Vector3& vector) const;
+    mavros_msgs::PositionTarget worldToBody(const mavros_msgs::PositionTarget& state) const;
+
+    /**
+     * @brief Transforms a whole trajectory expressed in the mast frame into the world frame.
+     *
+     * @param trajectory The trajectory in the mast frame.
+     * @param output Will hold the trajectory in the world frame, its capacity is reused between calls.
+     */
+    void mastToWorld(const std::vector<mavros_msgs::PositionTarget>& trajectory,
+                     std::vector<mavros_msgs::PositionTarget>& output) const;
+
+    /**
+     * @brief Transforms a whole trajectory expressed in the world frame into the mast frame.
+     *
+     * @param trajectory The trajectory in the world frame.
+     * @param output Will hold the trajectory in the mast frame, its capacity is reused between calls.
+     */
+    void worldToMast(const std::vector<mavros_msgs::PositionTarget>& trajectory,
+                     std::vector<mavros_msgs::PositionTarget>& output) const;
+
+    /**
+     * @brief Retrieves the offset of the drone centre, in the mast frame, which places the FaceHugger @p forward in
+     *        front of and @p up above the interaction point.
+     *
+     * @param forward Distance between the FaceHugger and the interaction point along the mast x axis [m].
+     * @param up Height of the FaceHugger above the interaction point [m].
+     *
+     * @return The offset of the drone centre compared to the interaction point in the mast frame.
+     */
+    geometry_msgs::Point faceHuggerToDrone(const double& forward, const double& up) const;
+
+    /**
+     * @brief Retrieves the offset of the drone centre, in the mast frame, when the drone is standing off @p distance
+     *        from the interaction point with the FaceHugger @p up above it.
+     *
+     * @param distance Distance between the drone centre and the interaction point along the mast x axis [m].
+     * @param up Height of the FaceHugger above the interaction point [m].
+     *
+     * @return The offset of the drone centre compared to the interaction point in the mast frame.
+     */
+    geometry_msgs::Point standoff(const double& distance, const double& up) const;
+};
+
+#endif
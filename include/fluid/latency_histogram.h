@@ -0,0 +1,62 @@
+/**
+ * @file latency_histogram.h
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <string>
+
+/**
+ * @brief Counts latencies in logarithmically spaced bins, together with the number of timeouts.
+ */
+class LatencyHistogram {
+   public:
+    /**
+     * @brief Upper edges of the bins [s], latencies above the last edge go in an overflow bin.
+     */
+    static constexpr std::array<double, 9> EDGES{{0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1.0, 2.0}};
+
+   private:
+    /**
+     * @brief The counts of the bins, the last one being the overflow bin.
+     */
+    std::array<unsigned int, EDGES.size() + 1> counts{};
+
+    /**
+     * @brief Number of timeouts.
+     */
+    unsigned int timeouts = 0;
+
+    /**
+     * @brief Largest latency recorded [s].
+     */
+    double max = 0;
+
+   public:
+    /**
+     * @brief Records a latency.
+     *
+     * @param latency The latency [s].
+     */
+    void record(const double& latency);
+
+    /**
+     * @brief Records a timeout.
+     */
+    void recordTimeout();
+
+    /**
+     * @return The number of latencies and timeouts recorded.
+     */
+    unsigned int getCount() const;
+
+    /**
+     * @return The histogram on one line, e.g. "<5ms: 2, <10ms: 7, ..., max: 12.3ms, timeouts: 1". Empty bins are left
+     *         out.
+     */
+    std::string toString() const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file latency_monitor.h
+ */
+
+#ifndef LATENCY_MONITOR_H
+#define LATENCY_MONITOR_H
+
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include <ros/ros.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Keeps latency statistics for every input source, measured as the age of the message stamp at the moment
+ *        the message is used, and publishes them on a diagnostics topic.
+ */
+class LatencyMonitor {
+   private:
+    /**
+     * @brief Latency statistics for one source.
+     */
+    struct Statistics {
+        std::string name;
+        unsigned int count = 0;
+        double last = 0;
+        double mean = 0;
+        double jitter = 0;
+        double min = 0;
+        double max = 0;
+    };
+
+    /**
+     * @brief Weight of a new sample in the running mean and jitter.
+     */
+    const double smoothing = 0.05;
+
+    /**
+     * @brief A source is reported with a warning level when its mean latency is above this value [s].
+     */
+    const double warning_latency;
+
+    /**
+     * @brief Minimum time between two diagnostics messages [s].
+     */
+    const double publish_period;
+
+    /**
+     * @brief Reported as the hardware id of the diagnostics, tells apart the latencies measured when running as a
+     *        node and as a nodelet.
+     */
+    const std::string hardware_id;
+
+    /**
+     * @brief The statistics for every source, indexed by the id returned from #addSource.
+     */
+    std::vector<Statistics> sources;
+
+    /**
+     * @brief Used to set up the publisher.
+     */
+    ros::NodeHandle node_handle;
+
+    /**
+     * @brief Publishes the statistics.
+     */
+    ros::Publisher diagnostics_publisher;
+
+    /**
+     * @brief The diagnostics message, kept to reuse its allocations.
+     */
+    diagnostic_msgs::DiagnosticArray diagnostics;
+
+    /**
+     * @brief When the diagnostics were published the last time.
+     */
+    ros::Time last_publish_time;
+
+   public:
+    /**
+     * @brief Sets up the diagnostics publisher.
+     *
+     * @param node_handle Node handle in the namespace of the vehicle.
+     * @param warning_latency A source is reported with a warning level when its mean latency is above this value [s].
+     * @param publish_rate The maximum rate the diagnostics are published at [Hz].
+     * @param hardware_id The hardware id of the diagnostics.
+     */
+    explicit LatencyMonitor(const ros::NodeHandle& node_handle,
+                            const double& warning_latency = 0.1,
+                            const double& publish_rate = 1.0,
+                            const std::string& hardware_id = "fluid");
+
+    /**
+     * @brief Registers a source, registering an existing name returns the id of that source.
+     *
+     * @param name The name of the source.
+     *
+     * @return The id to use with #record.
+     */
+    size_t addSource(const std::string& name);
+
+    /**
+     * @brief Records the age of a message.
+     *
+     * @param source The id of the source.
+     * @param stamp The stamp of the message.
+     * @param now The time the message is used.
+     *
+     * @return The age of the message [s].
+     */
+    double record(const size_t& source, const ros::Time& stamp, const ros::Time& now = ros::Time::now());
+
+    /**
+     * @param source The id of the source.
+     *
+     * @return The running mean of the latency of @p source [s].
+     */
+    double getMeanLatency(const size_t& source) const;
+
+    /**
+     * @brief Publishes the statistics if the publish period has elapsed since the last time.
+     */
+    void publish();
+};
+
+#endif
@@ -8,6 +8,8 @@
 
 #include "operation.h" //it has all the includes needed and is already included anyway
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
+#include "state_history.h"
+#include "state_types.h"
 
 //mast movement estimation
 #define SAVE_PITCH_TIME 15
@@ -25,17 +27,29 @@ class Mast{
     bool m_SHOW_PRINTS;
 
     /**
-     * @brief state of the interaction_point. Includes Position, velocity and acceleration and a header.
+     * @brief state of the interaction_point. Includes Position, velocity and acceleration.
      * 
      */
-    mavros_msgs::PositionTarget interaction_point_state;
+    PVAState interaction_point_state = {};
 
     /**
-     * @brief state of the interaction_point at the previous iteration/tick.
-     *  Includes Position, velocity and acceleration and a header.
+     * @brief stamp of #interaction_point_state, zero until the first update.
      * 
      */
-    mavros_msgs::PositionTarget previous_interaction_point_state;
+    ros::Time interaction_point_stamp;
+
+    /**
+     * @brief state of the interaction_point at the previous iteration/tick and its stamp.
+     * 
+     */
+    PVAState previous_interaction_point_state = {};
+    ros::Time previous_interaction_point_stamp;
+
+    /**
+     * @brief The recent states of the interaction_point, one sample per update.
+     * 
+     */
+    StateHistory m_history;
 
 
      /**
@@ -91,8 +105,42 @@ class Mast{
      */
     ros::Time m_time_last_max_pitch;
 
-    
-    
+    /**
+     * @brief Running mean of the interaction point position along the mast x axis
+     * 
+     */
+    double m_forward_mean;
+
+    /**
+     * @brief Running mean absolute deviation of the interaction point position along the mast x axis
+     * 
+     */
+    double m_forward_deviation;
+
+    /**
+     * @brief Time during which the amplitude has been estimated, the estimation is valid after one period.
+     * 
+     */
+    double m_amplitude_estimation_time;
+
+    /**
+     * @brief stamp of the last interaction point state used for the amplitude estimation
+     * 
+     */
+    ros::Time m_last_amplitude_stamp;
+
+    /**
+     * @brief Update the estimation of the amplitude of the interaction point oscillation 
+     *        from the current interaction point state.
+     * 
+     */
+    void estimateAmplitude();
+
+    /**
+     * @brief Add the current interaction point state to the history.
+     * 
+     */
+    void saveToHistory();
     
     public:
     /**
@@ -100,22 +148,25 @@ class Mast{
      * 
      * @param yaw The fixed yaw angle of mast. 
      * Should be calculated by perception and given by AI
+     * @param show_prints Whether to print the estimations for debugging.
      */
-    Mast(float yaw=0.0);
+    Mast(float yaw=0.0, bool show_prints=false);
 
     /**
      * @brief Update position and velocity from EKF output
      * 
      * @param module_state state of the interaction_point from the EKF
      */
-    void updateFromEkf(mavros_msgs::PositionTarget module_state);
+    void updateFromEkf(const mavros_msgs::PositionTarget& module_state);
 
     /**
-     * @brief Update position, velocity and acceleration from euler derivations
+     * @brief Update position, velocity and acceleration from euler derivations, and the period from the pitch.
      * 
-     * @param module_pose_ptr state of the interaction_point
+     * @param module_pose pose of the interaction_point, the pitch is the roll of the euler angles because of the
+     *                    frame of the module
+     * @param stamp time the pose was measured at
      */
-    void update(geometry_msgs::PoseStamped module_pose_ptr); //todo: this should also save the pitch automaticaly
+    void update(const Pose& module_pose, const ros::Time& stamp);
 
     /**
      * @brief Check if pitch were extremum.
@@ -178,12 +229,60 @@ class Mast{
      */
     float get_period();
 
+    /**
+     * @brief Get the estimated amplitude of the interaction point oscillation along the mast x axis.
+     *        Assumes a sinusoidal oscillation.
+     * 
+     * @return -1 if not estimated yet, the estimated amplitude otherwise
+     */
+    float get_amplitude();
+
     /**
      * @brief Get the interaction point state object
      * 
-     * @return mavros_msgs::PositionTarget 
+     * @return const PVAState& 
+     */
+    const PVAState& get_interaction_point_state() const;
+
+    /**
+     * @brief Get the interaction point state predicted forward to @p time, from the 
+     *        estimated velocity and acceleration. This compensates for the latency of the
+     *        perception and the EKF.
+     * 
+     * @param time The time the state should be predicted to. Usually the publish time.
+     * @param max_prediction The prediction is never longer than this duration [s], to avoid 
+     *                       extrapolating stale data.
+     * @return PVAState at @p time
+     */
+    PVAState get_interaction_point_state(const ros::Time& time, const double& max_prediction) const;
+
+    /**
+     * @brief Get the stamp of the last interaction point state
+     * 
+     * @return ros::Time, zero if there has not been any update yet
+     */
+    ros::Time get_interaction_point_stamp() const;
+
+    /**
+     * @brief Get the recent states of the interaction point, to look them up at the time of another measurement.
+     * 
+     * @return const StateHistory& 
+     */
+    const StateHistory& get_history() const;
+
+    /**
+     * @brief Get the estimation of the motion of the mast, to carry it over a restart.
+     * 
+     * @return MastEstimate 
+     */
+    MastEstimate get_estimate() const;
+
+    /**
+     * @brief Start from an earlier estimation of the motion of the mast instead of from scratch.
+     * 
+     * @param estimate from #get_estimate
      */
-    mavros_msgs::PositionTarget get_interaction_point_state();
+    void restore_estimate(const MastEstimate& estimate);
 
 };
 #endif // MAST_H
\ No newline at end of file
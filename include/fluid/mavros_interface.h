@@ -7,9 +7,15 @@
 
 #include <mavros_msgs/SetMode.h>
 #include <mavros_msgs/State.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 #include <mavros_msgs/PositionTarget.h>
 
+#include <future>
+#include <string>
+
+class Fluid;
+
 /**
  * @brief Handles communication regarding setting state, retriving state from the pixhawk, as well as
  *        convenience functions for arming, offboard mode and setting parameters.
@@ -36,6 +42,23 @@ class MavrosInterface {
      */
     ros::Publisher setpoint_publisher;
 
+    /**
+     * @brief The namespace of the vehicle, the topics and services of MAVROS are resolved within it.
+     */
+    const std::string name_space;
+
+    /**
+     * @brief The queue the state callbacks are put on.
+     */
+    ros::CallbackQueue* callback_queue;
+
+    /**
+     * @brief Processes the callbacks on #callback_queue for one update period.
+     *
+     * @param rate The update rate.
+     */
+    void spinFor(ros::Rate& rate) const;
+
     /**
      * @brief Callback for the state within Ardupilot.
      *
@@ -46,19 +69,39 @@ class MavrosInterface {
    public:
     /**
      * @brief Sets up the required subscribers and service clients.
+     *
+     * @param name_space The namespace of the vehicle.
+     * @param callback_queue The queue the state callbacks are put on. Pass a queue owned by the caller to use the
+     *                       interface from another thread than the main loop.
+     */
+    MavrosInterface(const std::string& name_space, ros::CallbackQueue* callback_queue);
+
+    /**
+     * @brief Sets up the interface for the vehicle of @p fluid, the state callbacks are put on its queue.
+     *
+     * @param fluid The instance of Fluid the interface is used from.
      */
-    MavrosInterface();
+    explicit MavrosInterface(const Fluid& fluid);
 
     /**
      * @return The current state gotten from Ardupilot through mavros.
      */
-    mavros_msgs::State getCurrentState() const;
+    const mavros_msgs::State& getCurrentState() const;
 
     /**
      * @brief Sets up the connection with ArduPilot through MAVROS.
      */
     void establishContactToArduPilot() const;
 
+    /**
+     * @brief Requests ArduPilot to stream all its telemetry at @p rate.
+     *
+     * @param rate The stream rate [Hz].
+     *
+     * @return true if the request was sent.
+     */
+    bool requestStreamRate(const unsigned int& rate) const;
+
     /**
      * @brief Will attempt to set the @p mode if Ardupilot is not already in the given mode.
      *
@@ -93,7 +136,44 @@ class MavrosInterface {
     void requestTakeOff(mavros_msgs::PositionTarget height) const;
 
     /**
-     * @brief Sets a parameter within Ardupilot.
+     * @brief Sends an arm request to Ardupilot without waiting for the answer.
+     *
+     * @return Whether Ardupilot accepted the request, available when it has answered.
+     */
+    std::future<bool> requestArmAsync() const;
+
+    /**
+     * @brief Sends a request to set @p mode to Ardupilot without waiting for the answer.
+     *
+     * @param mode The mode to set.
+     *
+     * @return Whether the mode was sent, available when Ardupilot has answered.
+     */
+    std::future<bool> setModeAsync(const std::string& mode) const;
+
+    /**
+     * @brief Sends a take off command to Ardupilot without waiting for the answer.
+     *
+     * @param altitude The take off altitude.
+     * @param yaw The yaw to hold during the take off.
+     *
+     * @return Whether Ardupilot accepted the command, available when it has answered.
+     */
+    std::future<bool> requestTakeOffAsync(const float& altitude, const float& yaw) const;
+
+    /**
+     * @brief Sets a parameter within Ardupilot without waiting for the answer.
+     *
+     * @param parameter The parameter to set.
+     * @param value The new value.
+     *
+     * @return Whether the parameter was set, available when Ardupilot has answered.
+     */
+    std::future<bool> setParamAsync(const std::string& parameter, const float& value) const;
+
+    /**
+     * @brief Sets a parameter within Ardupilot, blocks until Ardupilot accepts it. Use Fluid::setParam from the
+     *        operations, which doesn't block the step.
      *
      * @param parameter The parameter to set.
      * @param value The new value.
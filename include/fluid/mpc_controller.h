@@ -0,0 +1,162 @@
+/**
+ * @file mpc_controller.h
+ */
+
+#ifndef MPC_CONTROLLER_H
+#define MPC_CONTROLLER_H
+
+#include <Eigen/Dense>
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Vector3.h>
+#include <array>
+
+#include "state_types.h"
+
+/**
+ * @brief Short horizon model predictive controller tracking a moving reference.
+ *
+ *        Every axis is modelled as a double integrator driven by an acceleration. The three axes share the same
+ *        dynamics and weights, so the condensed QP matrices are computed once at construction and the three QPs are
+ *        solved together as one matrix problem. The box constrained QP is solved with an accelerated projected
+ *        gradient method, warm started with the solution of the previous tick shifted by the time elapsed since. The
+ *        solver stops when it converges, after a maximum number of iterations or when the compute budget is spent,
+ *        whichever comes first.
+ */
+class MpcController {
+   public:
+    /**
+     * @brief Number of steps in the prediction horizon.
+     */
+    static constexpr int HORIZON = 10;
+
+    /**
+     * @brief Reference for every step of the horizon, the first element is one step ahead of the current state.
+     */
+    typedef std::array<PVAState, HORIZON> Reference;
+
+    /**
+     * @brief The output of one solve.
+     */
+    struct Result {
+        /**
+         * @brief Predicted position and velocity one step ahead, and the acceleration to apply now.
+         */
+        geometry_msgs::Point position;
+        geometry_msgs::Vector3 velocity;
+        geometry_msgs::Vector3 acceleration;
+
+        /**
+         * @brief Number of solver iterations.
+         */
+        int iterations;
+
+        /**
+         * @brief Time spent solving [s].
+         */
+        double compute_time;
+
+        /**
+         * @brief Whether the solver converged before hitting the iteration or time limit.
+         */
+        bool converged;
+    };
+
+   private:
+    typedef Eigen::Matrix<double, HORIZON, 3> InputSequence;
+    typedef Eigen::Matrix<double, 2 * HORIZON, 3> StateSequence;
+
+    /**
+     * @brief Time between two steps of the horizon [s].
+     */
+    const double dt;
+
+    /**
+     * @brief Maximum acceleration on each axis [m/s²].
+     */
+    const double max_acc;
+
+    /**
+     * @brief Compute time allowed for one solve [s].
+     */
+    const double time_budget;
+
+    /**
+     * @brief Maximum number of solver iterations for one solve.
+     */
+    const int max_iterations;
+
+    /**
+     * @brief Condensed prediction matrices, X = phi * x0 + gamma * U, where X stacks position and velocity of
+     *        every step.
+     */
+    Eigen::Matrix<double, 2 * HORIZON, 2> phi;
+    Eigen::Matrix<double, 2 * HORIZON, HORIZON> gamma;
+
+    /**
+     * @brief Hessian of the condensed QP, gamma' * Q * gamma + R.
+     */
+    Eigen::Matrix<double, HORIZON, HORIZON> hessian;
+
+    /**
+     * @brief The linear term of the QP is initial_state_gain * x0 - reference_gain * X_ref.
+     */
+    Eigen::Matrix<double, HORIZON, 2> initial_state_gain;
+    Eigen::Matrix<double, HORIZON, 2 * HORIZON> reference_gain;
+
+    /**
+     * @brief Gradient step, the inverse of the largest eigenvalue of #hessian.
+     */
+    double step;
+
+    /**
+     * @brief Solution of the previous solve, used as warm start.
+     */
+    InputSequence warm_start;
+
+   public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    /**
+     * @brief Precomputes the condensed QP matrices.
+     *
+     * @param dt Time between two steps of the horizon [s].
+     * @param max_acc Maximum acceleration on each axis [m/s²].
+     * @param position_weight Weight on the position error.
+     * @param velocity_weight Weight on the velocity error.
+     * @param acceleration_weight Weight on the acceleration.
+     * @param time_budget Compute time allowed for one solve [s].
+     * @param max_iterations Maximum number of solver iterations for one solve.
+     */
+    MpcController(const double& dt,
+                  const double& max_acc,
+                  const double& position_weight,
+                  const double& velocity_weight,
+                  const double& acceleration_weight,
+                  const double& time_budget,
+                  const int& max_iterations);
+
+    /**
+     * @return Time between two steps of the horizon [s].
+     */
+    double getTimeStep() const;
+
+    /**
+     * @brief Clears the warm start.
+     */
+    void reset();
+
+    /**
+     * @brief Computes the PVA target which makes the drone follow @p reference.
+     *
+     * @param position The current position of the drone.
+     * @param velocity The current velocity of the drone.
+     * @param reference Position and velocity to follow for every step of the horizon.
+     * @param elapsed Time since the previous solve [s], the previous solution is shifted by it as warm start.
+     *
+     * @return The PVA target to send for this tick.
+     */
+    Result solve(const geometry_msgs::Point& position, const geometry_msgs::Vector3& velocity,
+                 const Reference& reference, const double& elapsed);
+};
+
+#endif
@@ -15,74 +15,100 @@
 #include <string>
 #include <vector>
 
+#include "checkpoint.h"
 #include "operation_identifier.h"
 #include "type_mask.h"
 
+class Fluid;
+
 /**
- * @brief Interface for operations within the finite state machine.
+ * @brief Progress of an operation, reported as feedback to action clients.
  */
-class Operation {
-   private:
+struct OperationProgress {
     /**
-     * @brief Gets the current pose.
+     * @brief Stage of the operation.
      */
-    ros::Subscriber pose_subscriber;
+    std::string state;
 
     /**
-     * @brief Current pose.
+     * @brief Distance left [m], -1 if not known.
      */
-    geometry_msgs::PoseStamped current_pose;
+    float distance_remaining = -1;
 
     /**
-     * @brief Callback for current pose.
-     *
-     * @param pose Pose retrieved from the callback.
+     * @brief Estimated time left [s], -1 if not known.
      */
-    void poseCallback(const nav_msgs::OdometryConstPtr pose);
+    float eta = -1;
+};
 
+/**
+ * @brief Interface for operations within the finite state machine.
+ */
+class Operation {
+   private:
     /**
-     * @brief Gets the current twist.
+     * @brief Determines whether this operation is a operation we can be at for longer periods of time. E.g. hold or
+     * land.
      */
-    ros::Subscriber twist_subscriber;
+    const bool steady;
 
+    
     /**
-     * @brief Current twist.
+     * @brief Allow publishing positionTarget setpoints.
      */
-    geometry_msgs::TwistStamped current_twist;
+    bool autoPublish;
 
     /**
-     * @brief Callback for current twist.
-     *
-     * @param twist Twist retrieved from the callback.
+     * @brief Velocity of the drone when the operation took over, set by #Fluid if
+     *        FluidConfiguration::velocity_handover is set.
      */
-    void twistCallback(const geometry_msgs::TwistStampedConstPtr twist);
+    geometry_msgs::Vector3 handover_velocity;
 
-    
     /**
-     * @brief Current acceleration.
+     * @brief When the operation was started.
      */
-    geometry_msgs::Vector3 current_accel;
+    ros::Time start_time;
 
     /**
-     * @brief Determines whether this operation is a operation we can be at for longer periods of time. E.g. hold or
-     * land.
+     * @brief When the previous tick ran, zero before the first tick.
      */
-    const bool steady;
+    ros::Time last_tick_time;
 
-    
     /**
-     * @brief Allow publishing positionTarget setpoints.
+     * @brief Number of ticks run, and of those which allocated after the warm up.
      */
-    bool autoPublish;
+    unsigned int tick_count, allocating_tick_count;
+
+    /**
+     * @brief Why the operation failed, empty while it has not. Read by #Fluid after every step.
+     */
+    std::string failure_reason;
 
    protected:
+    /**
+     * @brief The instance of Fluid running the operation, gives access to its configuration and the state of the
+     *        drone it controls.
+     */
+    Fluid& fluid;
 
     /**
-     * @brief Rate at which the operation is run
+     * @brief Rate at which the operation is currently run
      *
      */
     int rate_int;
 
+    /**
+     * @brief The rate the operation normally runs at, and the highest rate it can ask for through #getDesiredRate.
+     */
+    const int nominal_rate, max_rate;
+
+    /**
+     * @brief Measured time between the previous tick and the current one [s]. Integrations and dwell times within the
+     *        operation should use this rather than 1/#rate_int or a count of ticks, as the rate changes, ticks can be
+     *        late, and triggered ticks can come at up to twice the rate.
+     */
+    double tick_dt;
+
     /**
      * @brief Publishes setpoints.
      *
@@ -90,7 +116,7 @@ class Operation {
     ros::Publisher setpoint_publisher;
 
     /**
-     * @brief Used to construct the subscribers.
+     * @brief Used to construct the subscribers, in the namespace of the vehicle and on the queue of #fluid.
      */
     ros::NodeHandle node_handle;
 
@@ -104,6 +130,13 @@ class Operation {
      */
     void publishSetpoint();
 
+    /**
+     * @brief Stops the operation after the current step, #Fluid aborts its goal and falls back to a safe operation.
+     *
+     * @param reason Why the operation failed, reported to the action client.
+     */
+    void fail(const std::string& reason);
+
     /**
      * @return true if the operation has finished its necessary tasks.
      */
@@ -120,18 +153,52 @@ class Operation {
     virtual void tick() {}
 
     /**
-     * @return The current pose.
+     * @brief Lets the operation adapt its rate to what it is doing, e.g. tick faster during precise phases.
+     *
+     * @return The rate the operation wants to run at, clamped to #max_rate. #nominal_rate by default.
      */
-    geometry_msgs::PoseStamped getCurrentPose() const;
+    virtual int getDesiredRate() const;
 
     /**
-     * @return The current twist.
+     * @return The progress of the operation, only the state by default.
+     */
+    virtual OperationProgress getProgress() const;
+
+    /**
+     * @return The mode ArduPilot has to be in for the operation, asked for when the operation takes over. The mode
+     *         of #identifier by default.
+     */
+    virtual std::string getArdupilotMode() const;
+
+    /**
+     * @brief Writes what is needed to resume the operation after a restart, called when the operation has begun.
+     *        The identifier and the mode are written by Fluid, nothing else by default.
+     *
+     * @param state The checkpoint, cleared before.
+     */
+    virtual void saveCheckpoint(CheckpointState& state) {}
+
+    /**
+     * @brief Writes the progress of the operation to the checkpoint, called after every step, so it only writes what
+     *        changed since #saveCheckpoint. Nothing by default.
+     *
+     * @param state The checkpoint.
+     */
+    virtual void saveCheckpointProgress(CheckpointState& state) {}
+
+    /**
+     * @return The current pose, from the state hub of Fluid.
      */
-    geometry_msgs::TwistStamped getCurrentTwist() const;
+    const geometry_msgs::PoseStamped& getCurrentPose() const;
 
     /**
      * @return The current twist.
      */
+    const geometry_msgs::TwistStamped& getCurrentTwist() const;
+
+    /**
+     * @return The acceleration estimated from the current attitude.
+     */
     geometry_msgs::Vector3 getCurrentAccel() const;
 
     /**
@@ -139,15 +206,11 @@ class Operation {
      */
     float getCurrentYaw() const;
 
-
     /**
-     * @brief Estimate the acceleration of the drone from its orientation.
-     * 
-     * @param orientation The orientation of the drone as from poseCallback.
-     * 
-     * @return The estimation of the drone acceleration.
+     * @return The velocity the drone had when the operation took over, decaying towards zero, so that an operation
+     *        can feed it forward and avoid commanding a sudden stop. Zero if there was no handover.
      */
-    geometry_msgs::Vector3 orientation_to_acceleration(geometry_msgs::Quaternion orientation);
+    geometry_msgs::Vector3 getHandoverVelocity() const;
 
    public:
     /**
@@ -158,28 +221,54 @@ class Operation {
     /**
      * @brief Constructs a new operation.
      *
+     * @param fluid The instance of Fluid which runs the operation.
      * @param identifier The identifier of the operation.
      * @param steady Whether the operation is steady, it can be executed for longer periods of time without
      * consequences.
      * @param should_publish_setpoints Allow to prevent the operation publishing position setpoins
+     * @param nominal_rate The rate the operation normally runs at, the configured refresh rate if 0.
+     * @param max_rate The highest rate the operation can run at, @p nominal_rate if 0.
      */
-    Operation(const OperationIdentifier& identifier, const bool& steady, const bool& autoPublish);
+    Operation(Fluid& fluid, const OperationIdentifier& identifier, const bool& steady, const bool& autoPublish,
+              const int& nominal_rate = 0, const int& max_rate = 0);
+
+    virtual ~Operation() = default;
 
     /**
-     * @brief Performs the loop for executing logic within this operation.
+     * @brief Starts the operation, called once before the first #step.
+     */
+    void begin();
+
+    /**
+     * @brief Handles the callbacks waiting on the queue of Fluid, so that the tick runs on the latest state, then runs
+     *        one tick of the operation and publishes the setpoint and the status. The caller waits #getPeriod between
+     *        two steps.
      *
-     * @param should_tick               Called each tick, makes it possible to abort operations in the midst of an
-     *                                  execution.
      * @param should_halt_if_steady     Will halt at this operation if it's steady, is useful
      *                                  if we want to keep at a certain operation for some time, e.g. #LandOperation
      *                                  or #HoldOperation.
+     *
+     * @return true if the operation should keep running, false if it has finished or failed.
+     */
+    bool step(const bool& should_halt_if_steady);
+
+    /**
+     * @brief Finishes the operation, called once after the last #step.
+     */
+    void end();
+
+    /**
+     * @return The time until the next #step, follows the rate the operation currently runs at.
+     */
+    ros::Duration getPeriod() const;
+
+    /**
+     * @return The number of ticks which allocated after the warm up, always 0 unless allocations are tracked.
      */
-    virtual void perform(std::function<bool(void)> should_tick, bool should_halt_if_steady);
+    unsigned int getAllocatingTickCount() const;
 
     /**
-     * The #Fluid class has to be able to e.g. set the current pose if we transition to a operation which
-     * requires to initially know where we are, e. g. land or take off. In that case we can execute the operation from
-     * the current pose, and we don't have to wait for the pose callback and thus halt the system.
+     * The #Fluid class has to be able to e.g. read the progress of the operation for the action feedback.
      */
     friend class Fluid;
 };
@@ -0,0 +1,156 @@
+/**
+ * @file operation_action_server.h
+ */
+
+#ifndef OPERATION_ACTION_SERVER_H
+#define OPERATION_ACTION_SERVER_H
+
+#include <actionlib/server/simple_action_server.h>
+#include <ros/ros.h>
+
+#include <functional>
+#include <string>
+
+#include "operation.h"
+
+/**
+ * @brief The part of an action server the state machine talks to, independent of the action type.
+ */
+class OperationActionServerInterface {
+   public:
+    virtual ~OperationActionServerInterface() {}
+
+    /**
+     * @brief Publishes @p progress as feedback for the active goal.
+     */
+    virtual void publishFeedback(const OperationProgress& progress) = 0;
+
+    /**
+     * @brief Marks the active goal as succeeded.
+     */
+    virtual void succeed(const std::string& message) = 0;
+
+    /**
+     * @brief Marks the active goal as aborted, e.g. when another operation took over.
+     */
+    virtual void abort(const std::string& message) = 0;
+};
+
+/**
+ * @brief Action server for one operation.
+ *
+ *        The goals are not executed within the server, they are handed to the state machine which runs them in its
+ *        own loop and reports back through #OperationActionServerInterface.
+ *
+ * @tparam ActionSpec The action type, e.g. fluid::TravelAction.
+ */
+template <class ActionSpec>
+class OperationActionServer : public OperationActionServerInterface {
+   public:
+    ACTION_DEFINITION(ActionSpec)
+
+    /**
+     * @brief Called with a new goal, returns false and sets the message if the goal can't be started.
+     */
+    typedef std::function<bool(const Goal&, OperationActionServerInterface*, std::string&)> StartCallback;
+
+    /**
+     * @brief Called when the client preempts the active goal.
+     */
+    typedef std::function<void(OperationActionServerInterface*)> CancelCallback;
+
+   private:
+    /**
+     * @brief The underlying action server.
+     */
+    actionlib::SimpleActionServer<ActionSpec> server;
+
+    /**
+     * @brief Starts the goals.
+     */
+    const StartCallback start_callback;
+
+    /**
+     * @brief Stops the active goal.
+     */
+    const CancelCallback cancel_callback;
+
+    /**
+     * @brief Accepts the new goal and hands it to the state machine.
+     */
+    void goalCallback() {
+        const GoalConstPtr goal = server.acceptNewGoal();
+        std::string message;
+
+        if (!start_callback(*goal, this, message)) {
+            abort(message);
+        }
+    }
+
+    /**
+     * @brief Stops the active goal.
+     */
+    void preemptCallback() {
+        cancel_callback(this);
+
+        Result result;
+        result.success = false;
+        result.message = "Preempted";
+        server.setPreempted(result, result.message);
+    }
+
+   public:
+    /**
+     * @brief Sets up and starts the action server.
+     *
+     * @param node_handle The node handle to advertise the action on.
+     * @param name The name of the action.
+     * @param start_callback Starts the goals.
+     * @param cancel_callback Stops the active goal.
+     */
+    OperationActionServer(ros::NodeHandle& node_handle,
+                          const std::string& name,
+                          const StartCallback& start_callback,
+                          const CancelCallback& cancel_callback)
+        : server(node_handle, name, false), start_callback(start_callback), cancel_callback(cancel_callback) {
+        server.registerGoalCallback(std::bind(&OperationActionServer::goalCallback, this));
+        server.registerPreemptCallback(std::bind(&OperationActionServer::preemptCallback, this));
+        server.start();
+    }
+
+    void publishFeedback(const OperationProgress& progress) override {
+        if (!server.isActive()) {
+            return;
+        }
+
+        Feedback feedback;
+        feedback.state = progress.state;
+        feedback.distance_remaining = progress.distance_remaining;
+        feedback.eta = progress.eta;
+        server.publishFeedback(feedback);
+    }
+
+    void succeed(const std::string& message) override {
+        if (!server.isActive()) {
+            return;
+        }
+
+        Result result;
+        result.success = true;
+        result.message = message;
+        server.setSucceeded(result, message);
+    }
+
+    void abort(const std::string& message) override {
+        if (!server.isActive()) {
+            return;
+        }
+
+        Result result;
+        result.success = false;
+        result.message = message;
+        server.setAborted(result, message);
+    }
+};
+
+#endif
@@ -23,6 +23,7 @@ enum class OperationIdentifier {
     TRAVEL,
     LAND,
     INTERACT,
+    FOLLOW_TRAJECTORY,
     UNDEFINED
 };
 
@@ -10,6 +10,7 @@
 
 #include "move_operation.h"
 #include "operation_identifier.h"
+#include "packed_path.h"
 
 /**
  * @brief Represents the a move operation where the drone is following a path and avoiding obstacles.
@@ -23,9 +24,10 @@ class ExploreOperation : public MoveOperation {
     const double path_density = 4;
 
     /**
-     * @brief The path filled with points at a #path_density, passed to obstacle avoidance.
+     * @brief The path filled with points at a #path_density, passed to obstacle avoidance. Kept as a message so it
+     *        is not copied at every tick.
      */
-    std::vector<geometry_msgs::Point> dense_path;
+    ascend_msgs::Path dense_path;
 
     /**
      * @brief Publishes the current path to obstacle avoidance.
@@ -47,6 +49,12 @@ class ExploreOperation : public MoveOperation {
      */
     std::vector<geometry_msgs::Point> corrected_path;
 
+    /**
+     * @brief The current path and the corrected path packed for the comparisons in #pathCallback, kept to reuse
+     *        their allocations.
+     */
+    PackedPath packed_path, packed_corrected_path;
+
     /**
      * @brief Determines if the original path got set.
      */
@@ -62,15 +70,18 @@ class ExploreOperation : public MoveOperation {
      *
      * @param corrected_path The corrected path.
      */
-    void pathCallback(ascend_msgs::Path corrected_path);
+    void pathCallback(const ascend_msgs::Path::ConstPtr& corrected_path);
 
    public:
     /**
      * @brief Sets up the explore operation, the last point will be faced during exploration.
      *
+     * @param fluid The instance of Fluid which runs the operation.
      * @param path_with_POI A sequence of setpoints and points of interest the drone will face in corresponding setpoint.
      */
-    explicit ExploreOperation(const std::vector<geometry_msgs::Point>& path, const geometry_msgs::Point& point_of_interest);
+    explicit ExploreOperation(Fluid& fluid,
+                              const std::vector<geometry_msgs::Point>& path,
+                              const geometry_msgs::Point& point_of_interest);
 
     /**
      * @brief Sets up the #dense_path.
@@ -81,6 +92,11 @@ class ExploreOperation : public MoveOperation {
      * @brief Publishes the #dense_path to obstacle avoidance.
      */
     void tick() override;
+
+    /**
+     * @brief Saves the path and the point of interest.
+     */
+    void saveCheckpoint(CheckpointState& state) override;
 };
 
 #endif
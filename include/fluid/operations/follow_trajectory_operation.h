@@ -0,0 +1,91 @@
+/**
+ * @file follow_trajectory_operation.h
+ */
+
+#ifndef FOLLOW_TRAJECTORY_OPERATION_H
+#define FOLLOW_TRAJECTORY_OPERATION_H
+
+#include <ros/callback_queue.h>
+#include <trajectory_msgs/MultiDOFJointTrajectory.h>
+
+#include <memory>
+
+#include "operation.h"
+#include "trajectory_buffer.h"
+
+/**
+ * @brief Follows a trajectory streamed by an external planner on fluid/trajectory.
+ *
+ *        The trajectory comes in timestamped chunks of position, velocity and acceleration, the absolute time of a
+ *        point is the stamp of the chunk plus its time from start. The chunks are received on their own thread and
+ *        handed to the control loop through a #TrajectoryBuffer, which is sampled at every tick. The drone holds
+ *        its position until the trajectory starts. When the last sample is reached, it is held for the configured
+ *        grace period, so that a gap between two chunks doesn't end the operation, and the operation finishes if no
+ *        new chunk arrived by then.
+ */
+class FollowTrajectoryOperation : public Operation {
+   private:
+    /**
+     * @brief The received trajectory.
+     */
+    TrajectoryBuffer trajectory_buffer;
+
+    /**
+     * @brief Queue and spinner for the trajectory callbacks, so that chunks are received while the control loop
+     *        runs.
+     */
+    ros::CallbackQueue trajectory_callback_queue;
+    std::unique_ptr<ros::AsyncSpinner> trajectory_spinner;
+
+    /**
+     * @brief Receives the trajectory chunks.
+     */
+    ros::Subscriber trajectory_subscriber;
+
+    /**
+     * @brief Whether the last tick was past the end of the trajectory.
+     */
+    bool past_end = false;
+
+    /**
+     * @brief Whether the last tick was past the end of the trajectory by more than the grace period.
+     */
+    bool past_grace_period = false;
+
+    /**
+     * @brief Puts the points of @p trajectory into #trajectory_buffer.
+     *
+     * @param trajectory The trajectory chunk.
+     */
+    void trajectoryCallback(const trajectory_msgs::MultiDOFJointTrajectory::ConstPtr& trajectory);
+
+   public:
+    /**
+     * @brief Sets up the follow trajectory operation.
+     *
+     * @param fluid The instance of Fluid which runs the operation.
+     */
+    explicit FollowTrajectoryOperation(Fluid& fluid);
+
+    /**
+     * @brief Stops receiving chunks.
+     */
+    ~FollowTrajectoryOperation();
+
+    /**
+     * @return true when the last sample of the trajectory has been reached.
+     */
+    bool hasFinishedExecution() const override;
+
+    /**
+     * @brief Holds the current position and starts receiving chunks.
+     */
+    void initialize() override;
+
+    /**
+     * @brief Samples the trajectory at the current time.
+     */
+    void tick() override;
+};
+
+#endif
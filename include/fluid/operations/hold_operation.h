@@ -5,6 +5,7 @@
 #ifndef HOLD_OPERATION_H
 #define HOLD_OPERATION_H
 
+#include "convergence_predictor.h"
 #include "operation.h"
 #include "util.h"
 
@@ -12,14 +13,23 @@
  * @brief Operation representing the drone hovering.
  */
 class HoldOperation : public Operation {
+   private:
+    /**
+     * @brief Predicts when the drone has settled.
+     */
+    ConvergencePredictor convergence_predictor;
+
    public:
     /**
      * @brief Sets up the hold operation.
+     *
+     * @param fluid The instance of Fluid which runs the operation.
      */
-    explicit HoldOperation();
+    explicit HoldOperation(Fluid& fluid);
 
     /**
-     * @return true When the drone is hovering still at a given position.
+     * @return true When the drone is hovering still at a given position, or is predicted to be within
+     *         FluidConfiguration::completion_horizon.
      */
     bool hasFinishedExecution() const override;
 
@@ -27,6 +37,11 @@ class HoldOperation : public Operation {
      * @brief Sets up the setpoint to the current position.
      */
     void initialize() override;
+
+    /**
+     * @brief Updates the convergence predictor.
+     */
+    void tick() override;
 };
 
 #endif
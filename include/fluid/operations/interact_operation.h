@@ -16,8 +16,17 @@
 #include <std_msgs/Bool.h> //LAEiv
 #include <std_msgs/Int16.h>
 
+#include <ascend_msgs/SetInt.h>
+#include <std_srvs/Trigger.h>
+
+#include "async_service_caller.h"
 #include "mast.h"
 #include "data_file.h"
+#include "frame_transformer.h"
+#include "rendezvous_planner.h"
+#include "mpc_controller.h"
+
+#include <memory>
 
 /**
  * @brief Represents the operation where the drone is interact with the mast.
@@ -37,7 +46,7 @@ class InteractOperation : public Operation {
     struct TransitionSetpointStruct {
         float max_vel;
         float cte_acc;
-        mavros_msgs::PositionTarget state;
+        PVAState state = {};
         uint8_t finished_bitmask;
     };
 
@@ -46,18 +55,29 @@ class InteractOperation : public Operation {
      */
     ros::Time approaching_t0;
 
+    /**
+     * @brief Stamp of the last ground truth module pose saved to the data files.
+     */
+    ros::Time prev_gt_pose_time;
+
     bool SHOW_PRINTS;
     bool GROUND_TRUTH;
     bool EKF;
     bool USE_PERCEPTION;
+    bool USE_MPC;
 	InteractionState interaction_state = InteractionState::APPROACHING;
-    uint8_t completion_count; //count the number of ticks since we completeted the current state
+    double completion_time; //time in sec since we completed the current state, summed over the ticks
 
     std_msgs::Int16 number_fail;
     
     
     TransitionSetpointStruct transition_state;
     geometry_msgs::Point desired_offset;
+
+    /**
+     * @brief Distance to the mast the approach starts at, as given to the operation.
+     */
+    float offset;
     
     ros::Subscriber ekf_module_pose_subscriber;
     ros::Subscriber ekf_state_vector_subscriber;
@@ -66,8 +86,11 @@ class InteractOperation : public Operation {
     ros::Subscriber fh_state_subscriber;
     ros::Subscriber close_tracking_ready_subscriber;
 
-    ros::ServiceClient start_close_tracking_client;
-    ros::ServiceClient pause_close_tracking_client;    
+    /**
+     * @brief Switch close tracking in perception on and off without blocking the tick.
+     */
+    std::unique_ptr<AsyncServiceCaller<ascend_msgs::SetInt>> start_close_tracking_caller;
+    std::unique_ptr<AsyncServiceCaller<std_srvs::Trigger>> pause_close_tracking_caller;
 
     ros::Publisher interact_fail_pub;
     ros::Publisher altitude_and_yaw_pub;
@@ -77,9 +100,31 @@ class InteractOperation : public Operation {
 
     Mast mast;
 
+    /**
+     * @brief Transforms between the world, mast, drone body and FaceHugger frames.
+     */
+    FrameTransformer frames;
+
+    /**
+     * @brief Picks the launch time and approach profile used to leave the READY state.
+     */
+    RendezvousPlanner rendezvous_planner;
+
+    /**
+     * @brief Tracking controller used during the interaction when #USE_MPC is set.
+     */
+    std::unique_ptr<MpcController> mpc_controller;
+
     DataFile reference_state;
     DataFile drone_pose;
     DataFile gt_reference;
+    DataFile tick_benchmark;
+
+    /**
+     * @brief Latency sources of the module state and of the interaction point state when it is used.
+     */
+    size_t module_state_latency_source;
+    size_t interaction_point_age_source;
 
 
 
@@ -89,7 +134,7 @@ class InteractOperation : public Operation {
      * 
      * @return estimated mast to travel to the mast
      */
-    float estimate_time_to_mast();
+    float estimate_time_to_mast() const;
 
 
     /**
@@ -103,17 +148,16 @@ class InteractOperation : public Operation {
      */
     bool close_tracking_is_ready;
     
-    void ekfStateVectorCallback(const mavros_msgs::DebugValue ekf_state);
-    void ekfModulePoseCallback(const mavros_msgs::PositionTarget module_state);
-    void gt_modulePoseCallback(const geometry_msgs::PoseStamped module_pose);
-    void gt_modulePoseCallbackWithCov(const geometry_msgs::PoseWithCovarianceStampedConstPtr module_pose);
-    void gt_modulePoseCallbackWithoutCov(const geometry_msgs::PoseStampedConstPtr module_pose);
-    void FaceHuggerCallback(const std_msgs::Bool released);
-    void closeTrackingCallback(std_msgs::Bool ready);
+    void ekfStateVectorCallback(const mavros_msgs::DebugValue::ConstPtr& ekf_state);
+    void ekfModulePoseCallback(const mavros_msgs::PositionTarget::ConstPtr& module_state);
+    void gt_modulePoseCallback(const geometry_msgs::PoseStamped& module_pose);
+    void gt_modulePoseCallbackWithCov(const geometry_msgs::PoseWithCovarianceStamped::ConstPtr& module_pose);
+    void gt_modulePoseCallbackWithoutCov(const geometry_msgs::PoseStamped::ConstPtr& module_pose);
+    void FaceHuggerCallback(const std_msgs::Bool::ConstPtr& released);
+    void closeTrackingCallback(const std_msgs::Bool::ConstPtr& ready);
     void finishInteraction();
     bool faceHugger_is_set;     // true as soon av facehugger is released from drone
     
-    mavros_msgs::PositionTarget rotate(mavros_msgs::PositionTarget setpoint, float yaw);
     geometry_msgs::Vector3 estimateModuleVel();
     geometry_msgs::Vector3 estimateModuleAccel();
 
@@ -124,9 +168,10 @@ class InteractOperation : public Operation {
      * @brief Sets up the subscriber for the module pose.
      * And specify at what yaw angle is the mast compare to the world frame.
      * 
+     * @param fluid The instance of Fluid which runs the operation.
      * @param mast_yaw yaw angle of the mast compare to the world frame.
      */
-    explicit InteractOperation(const float& fixed_mast_yaw, const float& offset=3.0);
+    InteractOperation(Fluid& fluid, const float& fixed_mast_yaw, const float& offset=3.0);
 
     /**
      * @brief Sets up max leaning angle to 4°, subscribe to mast pose topic,
@@ -140,6 +185,33 @@ class InteractOperation : public Operation {
      */
     bool hasFinishedExecution() const override;
 
+    /**
+     * @return The maximum rate while close to the mast, the nominal rate otherwise.
+     */
+    int getDesiredRate() const override;
+
+    /**
+     * @return The interaction state, and the distance and time left to the mast until the interaction starts.
+     */
+    OperationProgress getProgress() const override;
+
+    /**
+     * @brief Saves the yaw of the mast and the offset.
+     */
+    void saveCheckpoint(CheckpointState& state) override;
+
+    /**
+     * @brief Saves the estimation of the motion of the mast, and whether the module has been extracted.
+     */
+    void saveCheckpointProgress(CheckpointState& state) override;
+
+    /**
+     * @brief Starts from the estimation of the motion of the mast made before a restart.
+     *
+     * @param estimate The estimation from the checkpoint.
+     */
+    void restoreMastEstimate(const MastEstimate& estimate);
+
     /**
      * @brief Makes sure the drone is following the module and reacting to the extraction signal.
      */
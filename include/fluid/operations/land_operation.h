@@ -5,25 +5,106 @@
 #ifndef LAND_OPERATION_H
 #define LAND_OPERATION_H
 
+#include <future>
+#include <string>
+
 #include "mavros_interface.h"
 #include "operation.h"
 #include "util.h"
 
 /**
  * @brief Represents the operation of landing at the current position.
+ *
+ *        By default the descent is left to the land mode of ArduPilot. With FluidConfiguration::fast_landing the
+ *        operation runs in guided instead: it descends fast under velocity control down to the flare height, then
+ *        slowly until touchdown. Touchdown is detected from the landed state of ArduPilot, or from the drone
+ *        stopping its descent while it is commanded down, which is confirmed sooner when the impact is felt as an
+ *        upward acceleration. The drone is then handed to the land mode, which disarms it, and the operation
+ *        finishes once ArduPilot is in the land mode. A landing started while ArduPilot is already in the land mode
+ *        is left to it.
  */
 class LandOperation : public Operation {
    private:
+    /**
+     * @brief Phases of the fast landing.
+     */
+    enum class Phase { DESCENT, FINAL_APPROACH, TOUCHDOWN };
+
+    /**
+     * @brief The current phase of the fast landing.
+     */
+    Phase phase = Phase::DESCENT;
+
+    /**
+     * @brief Vertical velocity at the previous tick [m/s].
+     */
+    double previous_vertical_velocity = 0;
+
+    /**
+     * @brief Vertical acceleration estimated from the velocity, smoothed [m/s²].
+     */
+    double vertical_acceleration = 0;
+
+    /**
+     * @brief Since when the drone has stopped descending during the final approach, zero while it descends.
+     */
+    ros::Time stall_start_time;
+
+    /**
+     * @brief When the last impact with the ground was felt, zero if none was.
+     */
+    ros::Time impact_time;
+
+    /**
+     * @brief Sets the land mode after touchdown.
+     */
+    MavrosInterface mavros_interface;
+
+    /**
+     * @brief The request for the land mode after touchdown, not valid before it is sent. Its future doesn't wait for
+     *        the request when the operation is destroyed.
+     */
+    std::future<bool> land_mode_request;
+
+    /**
+     * @brief Whether ArduPilot has accepted the land mode after touchdown.
+     */
+    bool is_land_mode_set = false;
+
     /**
      * @return true When the drone is under a certain height and has a certain low velocity.
      */
     bool isBelowThreshold() const;
 
+    /**
+     * @return true When the drone is on the ground, from its landed state or its height.
+     */
+    bool isOnGround() const;
+
+    /**
+     * @return true When ArduPilot reports that it is in the land mode.
+     */
+    bool isInLandMode() const;
+
+    /**
+     * @brief Tracks the vertical velocity of the drone during the final approach.
+     *
+     * @return true When the signature of a touchdown is seen.
+     */
+    bool hasTouchedDown();
+
+    /**
+     * @brief Moves the setpoint of the fast landing and advances its phases.
+     */
+    void tickFastLanding();
+
    public:
     /**
      * @brief Sets up the land operation.
+     *
+     * @param fluid The instance of Fluid which runs the operation.
      */
-    explicit LandOperation();
+    explicit LandOperation(Fluid& fluid);
 
     /**
      * @return true When the drone has landed.
@@ -31,13 +112,24 @@ class LandOperation : public Operation {
     bool hasFinishedExecution() const override;
 
     /**
-     * @brief Sets up the setpoint to the current position with zero altitude.
+     * @return The height left to descend.
+     */
+    OperationProgress getProgress() const override;
+
+    /**
+     * @return Guided for the fast landing until touchdown, unless the drone is already on the ground or ArduPilot is
+     *         already in the land mode, land otherwise.
+     */
+    std::string getArdupilotMode() const override;
+
+    /**
+     * @brief Sets up the setpoint to the current position with zero altitude, or to start the fast descent.
      */
     void initialize() override;
 
     /**
      * @brief Checks if the drone isBelowThreshold() and will set setpoint type mask to #TypeMask::IDLE so that it
-     *        stays idle at ground.
+     *        stays idle at ground. Runs the phases of the fast landing when it is enabled.
      */
     void tick() override;
 };
@@ -5,6 +5,7 @@
 #ifndef MOVE_OPERATION_H
 #define MOVE_OPERATION_H
 
+#include "convergence_predictor.h"
 #include "operation.h"
 
 /**
@@ -38,6 +39,22 @@ class MoveOperation : public Operation {
      */
     bool been_to_all_points = false;
 
+    /**
+     * @brief Predicts when the drone reaches the current setpoint, reset when the setpoint changes.
+     */
+    ConvergencePredictor convergence_predictor;
+
+    /**
+     * @brief Index in #path of the first point in the checkpoint, which only holds a window of #path when it is
+     *        longer than CheckpointState::MAX_PATH_SIZE.
+     */
+    size_t saved_path_start = 0;
+
+    /**
+     * @brief Writes #path to the checkpoint, or the window of it starting at the current setpoint if it is too long.
+     */
+    void savePath(CheckpointState& state);
+
    protected:
     /**
      * @brief Flag for forcing the operation to update the setpoint even the drone hasn't reached the setpoint.
@@ -55,8 +72,25 @@ class MoveOperation : public Operation {
     std::vector<geometry_msgs::Point> path;
 
     /**
-     * @brief Sets up the move operation.
+     * @brief Index of every point of #path in the path given to the operation, used for reporting. Cleared if #path
+     *        is replaced.
+     */
+    std::vector<size_t> original_indices;
+
+    /**
+     * @brief Number of points in the path given to the operation.
+     */
+    size_t original_path_size;
+
+    /**
+     * @brief Whether #path is in the checkpoint, to be cleared when #path is replaced.
+     */
+    bool is_path_saved = false;
+
+    /**
+     * @brief Sets up the move operation, simplifying @p path with a #PathSimplifier.
      *
+     * @param fluid The instance of Fluid which runs the operation.
      * @param operation_identifier The operation identifier.
      * @param path The path of the operation.
      * @param speed The speed at which to move in [m/s].
@@ -64,7 +98,8 @@ class MoveOperation : public Operation {
      * @param velocity_threshold The velocity threshold in [m/s].
      * @param max_angle Is the maximum allowed angle during movement [deg].
      */
-    explicit MoveOperation(const OperationIdentifier& operation_identifier,
+    explicit MoveOperation(Fluid& fluid,
+                           const OperationIdentifier& operation_identifier,
                            const std::vector<geometry_msgs::Point>& path, const double& speed,
                            const double& position_threshold, const double& velocity_threshold,
                            const double& max_angle);
@@ -77,7 +112,8 @@ class MoveOperation : public Operation {
 
     /**
      * @brief Checks where the drone is at a given point and updates the #current_setpoint_iterator if
-     *        the drone has reached a setpoint.
+     *        the drone has reached a setpoint, or is predicted to within FluidConfiguration::completion_horizon.
+     *        Feeds the handover velocity forward along the direction to the setpoint.
      */
     virtual void tick() override;
 
@@ -85,6 +121,21 @@ class MoveOperation : public Operation {
      * @brief Sets up the #current_setpoint_iterator and sets the #speed at which to move.
      */
     virtual void initialize() override;
+
+    /**
+     * @return The waypoint being flown to, the distance left along the path and the time left at the travel speed.
+     */
+    OperationProgress getProgress() const override;
+
+    /**
+     * @brief Saves the path.
+     */
+    void saveCheckpoint(CheckpointState& state) override;
+
+    /**
+     * @brief Saves the waypoint being flown to, and the path if it has been replaced.
+     */
+    void saveCheckpointProgress(CheckpointState& state) override;
 };
 
 #endif
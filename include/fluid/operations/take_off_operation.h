@@ -5,13 +5,106 @@
 #ifndef TAKE_OFF_OPERATION_H
 #define TAKE_OFF_OPERATION_H
 
+#include <future>
+#include <string>
+
+#include "convergence_predictor.h"
+#include "mavros_interface.h"
 #include "operation.h"
 #include "util.h"
 
 /**
  *  @brief Will take off at the current position.
+ *
+ *         The pre-flight checks and the take off are run as a staged state machine within the ticks of the
+ *         operation, so status keeps being published and the operation can be preempted at any stage. Requests to
+ *         ArduPilot are sent asynchronously and sent again until they are answered. Every stage has a timeout after
+ *         which the take off fails, Fluid then aborts its goal and lands.
  */
 class TakeOffOperation : public Operation {
+   private:
+    /**
+     * @brief The stages of the take off.
+     */
+    enum class Stage {
+        LINK,           ///< Waiting for the link with ArduPilot.
+        ARM,            ///< Arming while the setpoint stream warms up.
+        GUIDED,         ///< Setting the guided mode.
+        WAIT_FOR_POSE,  ///< Waiting for the first pose.
+        CONFIGURE,      ///< Setting the climb rate.
+        TAKE_OFF,       ///< Sending the take off command.
+        CLIMB           ///< Climbing to the take off height.
+    };
+
+    /**
+     * @brief Used to follow the state of ArduPilot and send the requests.
+     */
+    MavrosInterface mavros_interface;
+
+    /**
+     * @brief The current stage.
+     */
+    Stage stage = Stage::LINK;
+
+    /**
+     * @brief Predicts when the drone reaches the take off height during the climb.
+     */
+    ConvergencePredictor convergence_predictor;
+
+    /**
+     * @brief When the current stage was entered.
+     */
+    ros::Time stage_start_time;
+
+    /**
+     * @brief When the first setpoint of the warm up stream was published.
+     */
+    ros::Time warmup_start_time;
+
+    /**
+     * @brief The request currently waiting for an answer from ArduPilot, if any.
+     */
+    std::future<bool> pending_request;
+
+    /**
+     * @brief The stage #pending_request was sent from, answers arriving after the stage has changed are ignored.
+     */
+    Stage pending_request_stage = Stage::LINK;
+
+    /**
+     * @brief When the last request was sent.
+     */
+    ros::Time last_request_time;
+
+    /**
+     * @brief Sends a request asynchronously from the current stage.
+     *
+     * @param request The future of the request.
+     */
+    void setPendingRequest(std::future<bool>&& request);
+
+    /**
+     * @brief Moves to @p next_stage and updates the status.
+     *
+     * @param next_stage The stage to move to.
+     */
+    void setStage(const Stage& next_stage);
+
+    /**
+     * @return true if #pending_request has an answer for the current stage, which is then put in @p success.
+     */
+    bool pollPendingRequest(bool& success);
+
+    /**
+     * @return The timeout of @p stage [s].
+     */
+    static double getTimeout(const Stage& stage);
+
+    /**
+     * @return The name of @p stage.
+     */
+    static std::string getStageName(const Stage& stage);
+
    public:
     /**
      * @brief Setpoint for take off height.
@@ -21,9 +114,10 @@ class TakeOffOperation : public Operation {
     /**
      * @brief Sets up the take off operation.
      *
+     * @param fluid The instance of Fluid which runs the operation.
      * @param height_setpoint The take off height.
      */
-    explicit TakeOffOperation(float height_setpoint);
+    TakeOffOperation(Fluid& fluid, float height_setpoint);
 
     /**
      * @return true When the drone has taken off.
@@ -31,9 +125,19 @@ class TakeOffOperation : public Operation {
     bool hasFinishedExecution() const override;
 
     /**
-     * @brief Sets up the setpoint at the current position with a given altitude.
+     * @return The stage of the take off and the height left to climb.
+     */
+    OperationProgress getProgress() const override;
+
+    /**
+     * @brief Starts the take off sequence with an idle setpoint stream.
      */
     void initialize() override;
+
+    /**
+     * @brief Advances the take off sequence.
+     */
+    void tick() override;
 };
 
 #endif
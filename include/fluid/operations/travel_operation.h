@@ -5,9 +5,9 @@
 #ifndef TRAVEL_OPERATION_H
 #define TRAVEL_OPERATION_H
 
+#include "fluid.h"
 #include "move_operation.h"
 #include "operation_identifier.h"
-#include "mavros_interface.h"
 
 /**
  * @brief Represents the operation where the drone is moving quickly at large distances.
@@ -17,6 +17,7 @@ class TravelOperation : public MoveOperation {
     /**
      * @brief Sets up the travel operation.
      *
+     * @param fluid The instance of Fluid which runs the operation.
      * @param path List of setpoints.
      * @param speed is the travel speed in [m/s].
      * @param position_threshold means that setpoints count as visited within 2 [m].
@@ -25,11 +26,10 @@ class TravelOperation : public MoveOperation {
      * @param max_angle is the maximum tilt angle of the drone during movement [deg]. 
      *                  This is set in the base.launch file.
      */
-    TravelOperation(const std::vector<geometry_msgs::Point>& path)
-        : MoveOperation(OperationIdentifier::TRAVEL, path, Fluid::getInstance().configuration.travel_speed, 5, 100, Fluid::getInstance().configuration.travel_max_angle) {
-            MavrosInterface mavros_interface;
-            mavros_interface.setParam("WPNAV_ACCEL", Fluid::getInstance().configuration.travel_accel*100);
-            ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Sat max acceleration to: " << Fluid::getInstance().configuration.travel_accel << " m/s2.");
+    TravelOperation(Fluid& fluid, const std::vector<geometry_msgs::Point>& path)
+        : MoveOperation(fluid, OperationIdentifier::TRAVEL, path, fluid.configuration.travel_speed, 5, 100, fluid.configuration.travel_max_angle) {
+            fluid.setParam("WPNAV_ACCEL", fluid.configuration.travel_accel*100);
+            ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Setting max acceleration to: " << fluid.configuration.travel_accel << " m/s2.");
         }     
 };
 
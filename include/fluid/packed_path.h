@@ -0,0 +1,122 @@
+/**
+ * @file packed_path.h
+ */
+
+#ifndef PACKED_PATH_H
+#define PACKED_PATH_H
+
+#include <ascend_msgs/Path.h>
+#include <geometry_msgs/Point.h>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief A path stored as separate arrays of x, y and z coordinates.
+ *
+ *        Keeping each coordinate contiguous lets the geometry over the whole path run two points at a time with SSE2
+ *        where it is available, with a plain loop otherwise. The arrays keep their capacity when the path is
+ *        reassigned, so converting the same path message over and over does not allocate.
+ */
+class PackedPath {
+   private:
+    /**
+     * @brief The coordinates of the points.
+     */
+    std::vector<double> x, y, z;
+
+   public:
+    PackedPath() = default;
+
+    /**
+     * @brief Creates the path from @p points.
+     */
+    explicit PackedPath(const std::vector<geometry_msgs::Point>& points);
+
+    /**
+     * @brief Replaces the path with @p points.
+     */
+    void assign(const std::vector<geometry_msgs::Point>& points);
+
+    /**
+     * @brief Replaces the path with the points of @p path.
+     */
+    void assign(const ascend_msgs::Path& path);
+
+    /**
+     * @brief Writes the path into @p points, reusing its allocation.
+     */
+    void toPoints(std::vector<geometry_msgs::Point>& points) const;
+
+    /**
+     * @brief Writes the path into the points of @p path, reusing its allocation.
+     */
+    void toMessage(ascend_msgs::Path& path) const;
+
+    /**
+     * @brief Adds a point at the end.
+     */
+    void push_back(const geometry_msgs::Point& point);
+
+    /**
+     * @brief Removes all the points, keeping the allocations.
+     */
+    void clear();
+
+    /**
+     * @return The number of points.
+     */
+    size_t size() const;
+
+    /**
+     * @return The point at @p index.
+     */
+    geometry_msgs::Point at(const size_t& index) const;
+
+    /**
+     * @brief Computes the squared distance from every point of the path to @p point.
+     *
+     * @param point The point.
+     * @param output Where the distances are written, resized to the size of the path.
+     */
+    void squaredDistancesTo(const geometry_msgs::Point& point, std::vector<double>& output) const;
+
+    /**
+     * @brief Finds the point of the path closest to @p point.
+     *
+     * @param point The point.
+     *
+     * @return The index of the closest point, the last one if several are equally close. The size of the path if it
+     *         is empty.
+     */
+    size_t nearest(const geometry_msgs::Point& point) const;
+
+    /**
+     * @brief Computes the length of the path up to every point.
+     *
+     * @param output Where the lengths are written, resized to the size of the path. The first one is 0.
+     */
+    void cumulativeLength(std::vector<double>& output) const;
+
+    /**
+     * @brief Fills every segment with evenly spaced points, the same as Util::createPath over each segment. Empty if
+     *        the path has less than two points.
+     *
+     * @param density The number of points per metre.
+     * @param output The dense path.
+     */
+    void densify(const double& density, PackedPath& output) const;
+
+    /**
+     * @brief Checks whether @p other has the same number of points, and whether each of them is closer than
+     *        @p tolerance to the corresponding point of this path.
+     *
+     * @param other The path to compare with.
+     * @param tolerance The largest distance between two corresponding points [m].
+     *
+     * @return true if the paths are the same within @p tolerance.
+     */
+    bool isEqual(const PackedPath& other, const double& tolerance) const;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file path_simplifier.h
+ */
+
+#ifndef PATH_SIMPLIFIER_H
+#define PATH_SIMPLIFIER_H
+
+#include <geometry_msgs/Point.h>
+
+#include <vector>
+
+/**
+ * @brief A simplified path and where its points came from.
+ */
+struct SimplifiedPath {
+    /**
+     * @brief The points of the simplified path.
+     */
+    std::vector<geometry_msgs::Point> points;
+
+    /**
+     * @brief Index in the original path of every point in #points. Points inserted by the resampling get the index of
+     *        the original point starting the segment they lie on.
+     */
+    std::vector<size_t> original_indices;
+};
+
+/**
+ * @brief Preprocesses the paths given to the move operations, planners often send hundreds of nearly collinear
+ *        points and the operations stop at every one of them.
+ *
+ *        Consecutive points closer than the minimum spacing are merged, then points are removed in the manner of
+ *        Visvalingam–Whyatt: a heap keeps the point whose removal moves the path the least on top, and removing it
+ *        only updates the keys of its two neighbours, which gives O(n log n). The key of a point is its distance to
+ *        the segment between its neighbours plus the largest error already absorbed by the two segments it joins, an
+ *        upper bound of how far any original point ends up from the simplified path, so the tolerance is a hard
+ *        bound. At last the segments can be split up so none of them is longer than the resample spacing. The last
+ *        point is always kept, and the first one unless the whole path is merged into the last.
+ */
+class PathSimplifier {
+   private:
+    /**
+     * @brief No original point ends up further than this from the simplified path [m], 0 disables the
+     *        simplification.
+     */
+    const double tolerance;
+
+    /**
+     * @brief Consecutive points closer than this are merged [m].
+     */
+    const double min_spacing;
+
+    /**
+     * @brief Segments longer than this are split up in equally long pieces [m], 0 disables the resampling.
+     */
+    const double resample_spacing;
+
+    /**
+     * @return The distance from @p point to the segment between @p start and @p end.
+     */
+    static double distanceToSegment(const geometry_msgs::Point& point,
+                                    const geometry_msgs::Point& start,
+                                    const geometry_msgs::Point& end);
+
+   public:
+    /**
+     * @brief Sets up the simplifier.
+     *
+     * @param tolerance No original point ends up further than this from the simplified path [m], 0 disables the
+     *                  simplification.
+     * @param min_spacing Consecutive points closer than this are merged [m].
+     * @param resample_spacing Segments longer than this are split up [m], 0 disables the resampling.
+     */
+    PathSimplifier(const double& tolerance, const double& min_spacing, const double& resample_spacing);
+
+    /**
+     * @brief Simplifies @p path.
+     *
+     * @param path The path.
+     *
+     * @return The simplified path.
+     */
+    SimplifiedPath simplify(const std::vector<geometry_msgs::Point>& path) const;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file rendezvous_planner.h
+ */
+
+#ifndef RENDEZVOUS_PLANNER_H
+#define RENDEZVOUS_PLANNER_H
+
+#include <array>
+
+/**
+ * @brief The launch time and approach profile picked by the #RendezvousPlanner.
+ */
+struct RendezvousPlan {
+    /**
+     * @brief Whether a candidate fulfilling the tolerances was found.
+     */
+    bool feasible = false;
+
+    /**
+     * @brief Time from now until the drone should leave the READY position [s].
+     */
+    float launch_time = -1;
+
+    /**
+     * @brief Maximum velocity of the approach profile [m/s].
+     */
+    float max_vel = 0;
+
+    /**
+     * @brief Constant acceleration of the approach profile [m/s²].
+     */
+    float max_acc = 0;
+
+    /**
+     * @brief Index of the oscillation (0 being the next maximum pitch) the drone will meet the mast in.
+     */
+    int window = -1;
+
+    /**
+     * @brief Predicted position error of the interaction point at contact compared to its most forward position [m].
+     */
+    float position_error = 0;
+
+    /**
+     * @brief Predicted velocity of the interaction point at contact [m/s].
+     */
+    float velocity_error = 0;
+
+    /**
+     * @brief Number of candidates evaluated before the time budget ran out.
+     */
+    int evaluated_candidates = 0;
+};
+
+/**
+ * @brief Plans when the drone should leave the READY state in order to meet the mast at its most forward position.
+ *
+ *        Candidate launch times are enumerated around the next maximum pitches of the mast for a set of approach
+ *        profiles (scaled velocity and acceleration). Each candidate is scored with the predicted position and
+ *        velocity of the interaction point at contact, assuming a sinusoidal oscillation of the mast, and the earliest
+ *        feasible launch is picked. Candidates are evaluated window by window in fixed size batches, which stops when
+ *        the time budget is spent.
+ */
+class RendezvousPlanner {
+   public:
+    /**
+     * @brief Number of approach profiles evaluated for every oscillation window.
+     */
+    static constexpr int NUMBER_OF_PROFILES = 8;
+
+    /**
+     * @brief Number of launch times evaluated around the ideal launch time of every profile.
+     */
+    static constexpr int NUMBER_OF_LAUNCH_SAMPLES = 16;
+
+    /**
+     * @brief Number of candidates evaluated in one batch (one oscillation window).
+     */
+    static constexpr int BATCH_SIZE = NUMBER_OF_PROFILES * NUMBER_OF_LAUNCH_SAMPLES;
+
+   private:
+    /**
+     * @brief Maximum velocity and acceleration of each approach profile.
+     */
+    std::array<float, NUMBER_OF_PROFILES> profile_vel, profile_acc;
+
+    /**
+     * @brief Number of oscillations ahead which are evaluated.
+     */
+    const int number_of_windows;
+
+    /**
+     * @brief Maximum time difference between the arrival and the maximum pitch [s].
+     */
+    const float time_window;
+
+    /**
+     * @brief Maximum predicted position and velocity error at contact for a candidate to be feasible.
+     */
+    const float position_tolerance, velocity_tolerance;
+
+    /**
+     * @brief Compute time allowed for one call to #plan [s].
+     */
+    const double time_budget;
+
+    /**
+     * @brief Scratch buffers for a batch of candidates, kept as separate arrays so the scoring loop vectorizes.
+     */
+    std::array<float, BATCH_SIZE> launch, delta, position_error, velocity_error;
+
+   public:
+    /**
+     * @brief Sets up the planner.
+     *
+     * @param max_vel The maximum velocity allowed during the approach [m/s].
+     * @param max_acc The maximum acceleration allowed during the approach [m/s²].
+     * @param number_of_windows Number of oscillations ahead which are evaluated.
+     * @param time_window Maximum time difference between the arrival and the maximum pitch [s].
+     * @param position_tolerance Maximum predicted position error at contact [m].
+     * @param velocity_tolerance Maximum predicted velocity of the interaction point at contact [m/s].
+     * @param time_budget Compute time allowed for one call to #plan [s].
+     */
+    RendezvousPlanner(const float& max_vel,
+                      const float& max_acc,
+                      const int& number_of_windows = 3,
+                      const float& time_window = 1.0,
+                      const float& position_tolerance = 0.1,
+                      const float& velocity_tolerance = 0.2,
+                      const double& time_budget = 0.002);
+
+    /**
+     * @brief Estimates the time to travel @p distance with a trapezoidal velocity profile starting and ending at rest.
+     *
+     * @param distance The distance to travel [m].
+     * @param max_vel The maximum velocity of the profile [m/s].
+     * @param max_acc The constant acceleration and deceleration of the profile [m/s²].
+     *
+     * @return The travel time [s].
+     */
+    static float travelTime(const float& distance, const float& max_vel, const float& max_acc);
+
+    /**
+     * @brief Evaluates the candidates and picks the earliest feasible launch.
+     *
+     * @param time_to_max_pitch Time until the next maximum pitch of the mast [s].
+     * @param period The period of the mast oscillation [s].
+     * @param amplitude Amplitude of the interaction point oscillation along the mast x axis [m], negative if unknown.
+     *                  When unknown, candidates are only judged on the arrival time.
+     * @param distance The distance left to travel before contact [m].
+     *
+     * @return The plan, #RendezvousPlan::feasible is false if no candidate fulfilled the tolerances.
+     */
+    RendezvousPlan plan(const float& time_to_max_pitch,
+                        const float& period,
+                        const float& amplitude,
+                        const float& distance);
+};
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * @file startup_timeline.h
+ */
+
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+
+#include <ros/ros.h>
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Records when each startup stage of the node finished, measured from the construction of the timeline, so
+ *        that time-to-ready can be tracked. Stages can be marked from several threads.
+ */
+class StartupTimeline {
+   private:
+    /**
+     * @brief When the timeline started.
+     */
+    const ros::WallTime start;
+
+    /**
+     * @brief Name of every stage which has finished and the time it finished at [s].
+     */
+    std::vector<std::pair<std::string, double>> stages;
+
+    /**
+     * @brief Guards #stages.
+     */
+    mutable std::mutex mutex;
+
+   public:
+    /**
+     * @brief Starts the timeline.
+     */
+    StartupTimeline();
+
+    /**
+     * @brief Records that @p stage finished now.
+     *
+     * @param stage The name of the stage.
+     */
+    void mark(const std::string& stage);
+
+    /**
+     * @brief Logs the timeline and stores it in the parameter server under ~startup_timeline.
+     */
+    void report() const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file state_history.h
+ */
+
+#ifndef STATE_HISTORY_H
+#define STATE_HISTORY_H
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Vector3.h>
+
+#include <array>
+#include <cstddef>
+
+/**
+ * @brief One timestamped position, velocity and acceleration of a tracked object.
+ */
+struct StateSample {
+    /**
+     * @brief When the state was measured [s].
+     */
+    double time = 0;
+
+    geometry_msgs::Point position;
+    geometry_msgs::Vector3 velocity;
+    geometry_msgs::Vector3 acceleration;
+};
+
+/**
+ * @brief Keeps the most recent states of a stream, so it can be looked up at any time within the history.
+ *
+ *        The samples are kept in a fixed size ring ordered by time, the oldest sample is overwritten when it is
+ *        full. Looking up a time is a binary search over the ring followed by a linear interpolation between the
+ *        two samples around it. This lets streams measured at different instants, like the drone pose and the mast
+ *        state, be compared at a common time. Not thread safe, the pushes and the lookups are expected to happen on
+ *        the same callback queue.
+ */
+class StateHistory {
+   public:
+    /**
+     * @brief Number of samples kept, a few seconds at the usual odometry and perception rates.
+     */
+    static constexpr size_t CAPACITY = 256;
+
+   private:
+    /**
+     * @brief The samples, the oldest at #start.
+     */
+    std::array<StateSample, CAPACITY> ring;
+
+    /**
+     * @brief Index of the oldest sample in #ring and number of samples.
+     */
+    size_t start = 0, count = 0;
+
+   public:
+    /**
+     * @brief Adds a sample. Samples which are not newer than the newest one are ignored, except when the time jumps
+     *        back by more than a second, which means the clock was reset and the history is cleared.
+     *
+     * @param sample The sample.
+     *
+     * @return false if the sample was ignored.
+     */
+    bool push(const StateSample& sample);
+
+    /**
+     * @brief Interpolates the state at @p time.
+     *
+     * @param time The time to interpolate at [s].
+     * @param output The interpolated state.
+     *
+     * @return false if @p time is outside of the history.
+     */
+    bool sample(const double& time, StateSample& output) const;
+
+    /**
+     * @brief Removes all the samples.
+     */
+    void clear();
+
+    /**
+     * @return The number of samples.
+     */
+    size_t size() const;
+
+    /**
+     * @param index Index of the sample, 0 is the oldest.
+     *
+     * @return The sample at @p index.
+     */
+    const StateSample& operator[](const size_t& index) const;
+
+    /**
+     * @return The time of the oldest sample, 0 if there are none.
+     */
+    double getOldestTime() const;
+
+    /**
+     * @return The time of the newest sample, 0 if there are none.
+     */
+    double getNewestTime() const;
+};
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file state_hub.h
+ */
+
+#ifndef STATE_HUB_H
+#define STATE_HUB_H
+
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/TransformStamped.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <mavros_msgs/ExtendedState.h>
+#include <nav_msgs/Odometry.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <tf2_ros/transform_broadcaster.h>
+
+#include <memory>
+
+#include "latency_monitor.h"
+#include "state_history.h"
+
+/**
+ * @brief Holds the latest state of the drone from MAVROS, shared by all the operations so that the odometry and
+ *        velocity are only subscribed to once.
+ *
+ *        Can also broadcast the pose as the base_link transform, which replaces the separate base_link_publisher
+ *        process.
+ */
+class StateHub {
+   private:
+    /**
+     * @brief Sets up the subscribers.
+     */
+    ros::NodeHandle node_handle;
+
+    /**
+     * @brief Gets the odometry, the velocity and the extended state.
+     */
+    ros::Subscriber odometry_subscriber, twist_subscriber, extended_state_subscriber;
+
+    /**
+     * @brief Latest pose, twist and acceleration estimated from the attitude.
+     */
+    geometry_msgs::PoseStamped current_pose;
+    geometry_msgs::TwistStamped current_twist;
+    geometry_msgs::Vector3 current_accel;
+
+    /**
+     * @brief Latest landed state reported by ArduPilot, one of mavros_msgs::ExtendedState::LANDED_STATE_*.
+     */
+    uint8_t landed_state = mavros_msgs::ExtendedState::LANDED_STATE_UNDEFINED;
+
+    /**
+     * @brief The recent states of the drone, one sample per odometry message.
+     */
+    StateHistory history;
+
+    /**
+     * @brief Records the age of the odometry and velocity.
+     */
+    std::shared_ptr<LatencyMonitor> latency_monitor_ptr;
+
+    /**
+     * @brief Ids of the odometry and velocity sources in #latency_monitor_ptr.
+     */
+    size_t odometry_latency_source, velocity_latency_source;
+
+    /**
+     * @brief Broadcasts the base_link transform, nullptr if it is disabled.
+     */
+    std::unique_ptr<tf2_ros::TransformBroadcaster> broadcaster_ptr;
+
+    /**
+     * @brief The base_link transform, kept to reuse its allocations.
+     */
+    geometry_msgs::TransformStamped transform_stamped;
+
+    /**
+     * @brief Minimum time between two broadcasted transforms, measured on the message stamps [s].
+     */
+    const double transform_period;
+
+    /**
+     * @brief Callback for the odometry, broadcasts the transform if the period has elapsed.
+     *
+     * @param odometry The odometry.
+     */
+    void odometryCallback(const nav_msgs::Odometry::ConstPtr& odometry);
+
+    /**
+     * @brief Callback for the velocity.
+     *
+     * @param twist The velocity.
+     */
+    void twistCallback(const geometry_msgs::TwistStamped::ConstPtr& twist);
+
+    /**
+     * @brief Callback for the extended state.
+     *
+     * @param extended_state The extended state.
+     */
+    void extendedStateCallback(const mavros_msgs::ExtendedState::ConstPtr& extended_state);
+
+    /**
+     * @brief Estimate the acceleration of the drone from its orientation.
+     *
+     * @param orientation The orientation of the drone.
+     *
+     * @return The estimation of the drone acceleration.
+     */
+    static geometry_msgs::Vector3 orientationToAcceleration(const geometry_msgs::Quaternion& orientation);
+
+   public:
+    /**
+     * @brief Sets up the subscribers and the broadcaster.
+     *
+     * @param node_handle Node handle in the namespace of the vehicle, the callbacks are put on its queue.
+     * @param latency_monitor_ptr Records the age of the odometry and velocity.
+     * @param should_broadcast_transform Whether to broadcast the pose as the base_link transform.
+     * @param transform_rate The maximum rate the transform is broadcasted at [Hz].
+     */
+    StateHub(const ros::NodeHandle& node_handle,
+             std::shared_ptr<LatencyMonitor> latency_monitor_ptr,
+             const bool& should_broadcast_transform,
+             const float& transform_rate);
+
+    /**
+     * @return The latest pose.
+     */
+    const geometry_msgs::PoseStamped& getPose() const;
+
+    /**
+     * @return The latest twist.
+     */
+    const geometry_msgs::TwistStamped& getTwist() const;
+
+    /**
+     * @return The acceleration estimated from the latest attitude.
+     */
+    const geometry_msgs::Vector3& getAccel() const;
+
+    /**
+     * @return The recent states of the drone, stamped with the odometry and with the latest velocity at the time.
+     */
+    const StateHistory& getHistory() const;
+
+    /**
+     * @return The landed state reported by ArduPilot, mavros_msgs::ExtendedState::LANDED_STATE_UNDEFINED until it
+     *         has reported one.
+     */
+    uint8_t getLandedState() const;
+};
+
+#endif
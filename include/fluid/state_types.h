@@ -0,0 +1,93 @@
+/**
+ * @file state_types.h
+ */
+
+#ifndef STATE_TYPES_H
+#define STATE_TYPES_H
+
+#include <mavros_msgs/PositionTarget.h>
+
+/**
+ * @brief A plain 3D vector for internal computations.
+ *
+ *        Unlike the ROS messages it carries no header or allocator, so it can be copied and kept in arrays without
+ *        touching the heap. Converts to and from any message with x, y and z fields, e.g. geometry_msgs::Point and
+ *        geometry_msgs::Vector3, which should only happen where messages are received and published.
+ */
+struct Vec3 {
+    double x, y, z;
+
+    template <typename T>
+    static Vec3 from(const T& in) {
+        return {in.x, in.y, in.z};
+    }
+
+    template <typename T>
+    T to() const {
+        T out;
+        out.x = x;
+        out.y = y;
+        out.z = z;
+        return out;
+    }
+
+    Vec3 operator+(const Vec3& other) const { return {x + other.x, y + other.y, z + other.z}; }
+    Vec3 operator-(const Vec3& other) const { return {x - other.x, y - other.y, z - other.z}; }
+    Vec3 operator*(const double& factor) const { return {x * factor, y * factor, z * factor}; }
+};
+
+/**
+ * @brief Position, velocity and acceleration of an object, the internal counterpart of mavros_msgs::PositionTarget.
+ */
+struct PVAState {
+    Vec3 position, velocity, acceleration;
+
+    static PVAState from(const mavros_msgs::PositionTarget& in) {
+        return {Vec3::from(in.position), Vec3::from(in.velocity), Vec3::from(in.acceleration_or_force)};
+    }
+
+    /**
+     * @brief Sums the position, velocity and acceleration of two states.
+     */
+    PVAState operator+(const PVAState& other) const {
+        return {position + other.position, velocity + other.velocity, acceleration + other.acceleration};
+    }
+
+    /**
+     * @brief Predicts the state @p dt seconds ahead with a constant acceleration.
+     */
+    PVAState predict(const double& dt) const {
+        return {position + velocity * dt + acceleration * (0.5 * dt * dt), velocity + acceleration * dt,
+                acceleration};
+    }
+};
+
+/**
+ * @brief Position and orientation as euler angles (roll, pitch, yaw) of an object.
+ */
+struct Pose {
+    Vec3 position, orientation;
+};
+
+/**
+ * @brief What has been learnt about the motion of the mast, which takes several periods to estimate.
+ */
+struct MastEstimate {
+    /**
+     * @brief Period of the pitch [s].
+     */
+    float period;
+
+    /**
+     * @brief Extremums of the pitch during the last oscillation.
+     */
+    float last_min_pitch, last_max_pitch;
+
+    /**
+     * @brief Running mean and mean absolute deviation of the interaction point along the mast x axis, and the time
+     *        they have been estimated for [s].
+     */
+    double forward_mean, forward_deviation, amplitude_estimation_time;
+};
+
+#endif
@@ -7,6 +7,7 @@
 
 #include <ascend_msgs/FluidStatus.h>
 #include <nav_msgs/Path.h>
+#include <ros/callback_queue.h>
 #include <ros/ros.h>
 #include <visualization_msgs/Marker.h>
 
@@ -35,7 +36,7 @@ class StatusPublisher {
      *
      * @param pose_ptr Current pose.
      */
-    void poseCallback(const geometry_msgs::PoseStampedConstPtr pose_ptr);
+    void poseCallback(const geometry_msgs::PoseStamped::ConstPtr& pose_ptr);
 
     /**
      * @brief The trace path.
@@ -55,8 +56,10 @@ class StatusPublisher {
 
     /**
      * @brief Sets up the subscribers and publishers.
+     *
+     * @param node_handle Node handle in the namespace of the vehicle, the pose callbacks are put on its queue.
      */
-    StatusPublisher();
+    explicit StatusPublisher(const ros::NodeHandle& node_handle);
 
     /**
      * @brief Publishes the current status, trace and setpoint marker.
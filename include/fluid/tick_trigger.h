@@ -0,0 +1,99 @@
+/**
+ * @file tick_trigger.h
+ */
+
+#ifndef TICK_TRIGGER_H
+#define TICK_TRIGGER_H
+
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <topic_tools/shape_shifter.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Tells when a message arrives on a topic of any type, so that the main loop can tick as soon as new data is
+ *        there instead of at the next period.
+ *
+ *        The topic is subscribed on its own queue and spinner thread, so the arrival time is taken as the message
+ *        comes in, not when the main loop gets to its own queue.
+ */
+class TickTrigger {
+   private:
+    /**
+     * @brief The queue of #subscriber, spun by #spinner.
+     */
+    ros::CallbackQueue callback_queue;
+
+    /**
+     * @brief Spins #callback_queue.
+     */
+    ros::AsyncSpinner spinner;
+
+    /**
+     * @brief Subscribes to the trigger topic.
+     */
+    ros::Subscriber subscriber;
+
+    /**
+     * @brief Guards #arrival_time and #has_arrived.
+     */
+    std::mutex mutex;
+
+    /**
+     * @brief Wakes #wait up when a message arrives.
+     */
+    std::condition_variable condition;
+
+    /**
+     * @brief When the last message arrived, zero if none has.
+     */
+    ros::WallTime arrival_time;
+
+    /**
+     * @brief Whether a message has arrived since the last #wait or #consumeArrivalTime.
+     */
+    bool has_arrived = false;
+
+    /**
+     * @brief Records the arrival of a message.
+     */
+    void callback(const ros::MessageEvent<topic_tools::ShapeShifter const>& event);
+
+   public:
+    /**
+     * @brief Subscribes to @p topic.
+     *
+     * @param node_handle Node handle in the namespace of the vehicle, @p topic is resolved within it.
+     * @param topic The trigger topic.
+     */
+    TickTrigger(const ros::NodeHandle& node_handle, const std::string& topic);
+
+    /**
+     * @brief Stops the spinner.
+     */
+    ~TickTrigger();
+
+    /**
+     * @brief Blocks until a message has arrived, but at least @p min_wait and at most @p max_wait. A message which
+     *        arrived since the last call counts.
+     *
+     * @param min_wait The shortest wait.
+     * @param max_wait The longest wait, when the trigger is late or missing.
+     *
+     * @return true if a message has arrived, false if @p max_wait has elapsed.
+     */
+    bool wait(const ros::WallDuration& min_wait, const ros::WallDuration& max_wait);
+
+    /**
+     * @brief Called right before a tick which uses the messages received so far, so that a message which arrived
+     *        after #wait returned doesn't trigger another tick on the same data.
+     *
+     * @return When the last message arrived, zero if none has.
+     */
+    ros::WallTime consumeArrivalTime();
+};
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file trajectory_buffer.h
+ */
+
+#ifndef TRAJECTORY_BUFFER_H
+#define TRAJECTORY_BUFFER_H
+
+#include <geometry_msgs/Point.h>
+#include <geometry_msgs/Vector3.h>
+
+#include <array>
+#include <atomic>
+#include <deque>
+
+/**
+ * @brief One timestamped position, velocity and acceleration of a trajectory.
+ */
+struct TrajectorySample {
+    /**
+     * @brief When the drone should be at this state [s].
+     */
+    double time = 0;
+
+    /**
+     * @brief Stamp of the chunk this sample came from [s], newer chunks replace older ones where they overlap.
+     */
+    double chunk_stamp = 0;
+
+    geometry_msgs::Point position;
+    geometry_msgs::Vector3 velocity;
+    geometry_msgs::Vector3 acceleration;
+    float yaw = 0;
+};
+
+/**
+ * @brief Buffers trajectory samples from a producer thread and interpolates them for a consumer thread.
+ *
+ *        The samples go through a lock-free single producer, single consumer ring, so the subscriber never blocks
+ *        the control loop and the other way around. The consumer merges them into a time ordered window: a newer
+ *        chunk replaces what is planned from its first sample and onwards, while samples from chunks arriving out
+ *        of order only fill in before the start of the newest chunk. The state at a given time is interpolated with
+ *        cubic Hermite splines between the two samples around it.
+ */
+class TrajectoryBuffer {
+   private:
+    /**
+     * @brief Size of the ring, a power of two.
+     */
+    static constexpr size_t CAPACITY = 1024;
+
+    /**
+     * @brief The ring between the producer and the consumer.
+     */
+    std::array<TrajectorySample, CAPACITY> ring;
+
+    /**
+     * @brief Next slot to read and next slot to write, only ever increasing.
+     */
+    std::atomic<size_t> read_index{0}, write_index{0};
+
+    /**
+     * @brief Number of samples dropped because the ring was full.
+     */
+    std::atomic<unsigned int> dropped{0};
+
+    /**
+     * @brief The merged samples, ordered by time. Only touched by the consumer.
+     */
+    std::deque<TrajectorySample> window;
+
+    /**
+     * @brief Stamp and first sample time of the newest chunk seen by the consumer.
+     */
+    double newest_chunk_stamp = -1, newest_chunk_start = 0;
+
+    /**
+     * @brief Moves the samples from the ring into #window.
+     */
+    void drain();
+
+    /**
+     * @brief Inserts @p sample into #window, replacing a sample with the same time.
+     */
+    void insert(const TrajectorySample& sample);
+
+   public:
+    /**
+     * @brief Adds a sample, called by the producer only. The samples of a chunk have to be pushed in order.
+     *
+     * @param sample The sample.
+     *
+     * @return false if the ring was full and the sample was dropped.
+     */
+    bool push(const TrajectorySample& sample);
+
+    /**
+     * @brief Interpolates the trajectory at @p time, called by the consumer only.
+     *
+     * @param time The time to interpolate at [s].
+     * @param output The interpolated state. Before the first sample and after the last one it is the position of
+     *               that sample with zero velocity and acceleration.
+     *
+     * @return false if there are no samples.
+     */
+    bool sample(const double& time, TrajectorySample& output);
+
+    /**
+     * @return The time of the last sample, 0 if there are none. Called by the consumer only.
+     */
+    double getEndTime() const;
+
+    /**
+     * @return Number of samples dropped so far because the ring was full.
+     */
+    unsigned int getDroppedCount() const;
+};
+
+#endif
@@ -104,7 +104,8 @@ class Util {
      * @param b The second position target to sum
      * @return mavros_msgs::PositionTarget 
      */
-    static mavros_msgs::PositionTarget addPositionTarget(mavros_msgs::PositionTarget a, mavros_msgs::PositionTarget b){
+    static mavros_msgs::PositionTarget addPositionTarget(const mavros_msgs::PositionTarget& a,
+                                                         const mavros_msgs::PositionTarget& b){
         mavros_msgs::PositionTarget res;
         res.header = a.header; // this is arbitrary. Did no find a perfect solution, but should not have any impact
 
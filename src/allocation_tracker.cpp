@@ -0,0 +1,57 @@
+/**
+ * @file allocation_tracker.cpp
+ */
+
+#include "allocation_tracker.h"
+
+#ifdef FLUID_TRACK_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+/**
+ * @brief Allocations of the current thread, per thread so that the subscriber threads don't show up in the count
+ *        of the control loop.
+ */
+thread_local uint64_t allocation_count = 0;
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocation_count++;
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocation_count++;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+bool AllocationTracker::isEnabled() { return true; }
+
+uint64_t AllocationTracker::getCount() { return allocation_count; }
+
+#else
+
+bool AllocationTracker::isEnabled() { return false; }
+
+uint64_t AllocationTracker::getCount() { return 0; }
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * @file path_simplifier_benchmark.cpp
+ *
+ * @brief Times PathSimplifier on large noisy paths and checks the tolerance bound on the result. Only built with the
+ *        FLUID_BUILD_BENCHMARKS option, doesn't need a roscore.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "path_simplifier.h"
+#include "util.h"
+
+#define TOLERANCE 0.2           // [m]
+#define MIN_SPACING 0.05        // [m]
+#define POINT_SPACING 0.1       // Distance along x between two points of the generated path [m]
+#define NOISE 0.02              // Standard deviation of the noise added to every point [m]
+#define REPETITION_COUNT 5      // Runs per path size, the fastest one is reported
+
+/**
+ * @return A sine along x of @p size points with noise.
+ */
+std::vector<geometry_msgs::Point> createPath(const size_t& size) {
+    std::mt19937 generator(size);
+    std::normal_distribution<double> noise(0.0, NOISE);
+    std::vector<geometry_msgs::Point> path(size);
+
+    for (size_t i = 0; i < size; i++) {
+        path[i].x = i * POINT_SPACING;
+        path[i].y = 5.0 * std::sin(path[i].x / 10.0) + noise(generator);
+        path[i].z = 2.0 + noise(generator);
+    }
+
+    return path;
+}
+
+/**
+ * @return The distance from @p point to the segment between @p start and @p end.
+ */
+double distanceToSegment(const geometry_msgs::Point& point,
+                         const geometry_msgs::Point& start,
+                         const geometry_msgs::Point& end) {
+    const double dx = end.x - start.x, dy = end.y - start.y, dz = end.z - start.z;
+    const double length_squared = dx * dx + dy * dy + dz * dz;
+    double t = 0;
+
+    if (length_squared > 0) {
+        t = ((point.x - start.x) * dx + (point.y - start.y) * dy + (point.z - start.z) * dz) / length_squared;
+        t = std::min(std::max(t, 0.0), 1.0);
+    }
+
+    geometry_msgs::Point closest;
+    closest.x = start.x + t * dx;
+    closest.y = start.y + t * dy;
+    closest.z = start.z + t * dz;
+
+    return Util::distanceBetween(point, closest);
+}
+
+/**
+ * @return The largest distance from a point of @p path to the segment of @p simplified it was simplified into.
+ */
+double getMaxError(const std::vector<geometry_msgs::Point>& path, const SimplifiedPath& simplified) {
+    double max_error = 0;
+    size_t segment = 0;
+
+    for (size_t i = 0; i < path.size(); i++) {
+        while (segment + 1 < simplified.original_indices.size() - 1 && simplified.original_indices[segment + 1] < i) {
+            segment++;
+        }
+
+        const size_t end = std::min(segment + 1, simplified.points.size() - 1);
+        max_error = std::max(max_error, distanceToSegment(path[i], simplified.points[segment], simplified.points[end]));
+    }
+
+    return max_error;
+}
+
+int main(int, char**) {
+    const PathSimplifier simplifier(TOLERANCE, MIN_SPACING, 0.0);
+    bool is_within_tolerance = true;
+
+    std::printf("%10s %12s %12s %14s\n", "points", "time [ms]", "kept", "max error [m]");
+
+    for (const size_t size : std::vector<size_t>{1000, 10000, 100000}) {
+        const std::vector<geometry_msgs::Point> path = createPath(size);
+        SimplifiedPath simplified;
+        double fastest = INFINITY;
+
+        for (int i = 0; i < REPETITION_COUNT; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            simplified = simplifier.simplify(path);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            fastest = std::min(fastest, elapsed.count());
+        }
+
+        const double max_error = getMaxError(path, simplified);
+        is_within_tolerance = is_within_tolerance && max_error <= TOLERANCE;
+
+        std::printf("%10zu %12.2f %12zu %14.3f\n", size, fastest, simplified.points.size(), max_error);
+    }
+
+    return is_within_tolerance ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file checkpoint.cpp
+ */
+
+#include "checkpoint.h"
+
+#include <fcntl.h>
+#include <ros/ros.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "operation_identifier.h"
+
+#define CHECKPOINT_MAGIC 0x464c4350  // "FLCP"
+#define CHECKPOINT_VERSION 1         // Bumped when the layout of the state changes
+
+constexpr uint32_t CheckpointState::MAX_PATH_SIZE;
+
+Checkpoint::Checkpoint(const std::string& path) {
+    file_descriptor = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (file_descriptor < 0) {
+        ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                        << ": Could not open the checkpoint " << path.c_str() << ": " << std::strerror(errno));
+        return;
+    }
+
+    struct stat file_status;
+    const bool has_record = fstat(file_descriptor, &file_status) == 0 && file_status.st_size == sizeof(Record);
+
+    if (!has_record && ftruncate(file_descriptor, sizeof(Record)) != 0) {
+        ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                        << ": Could not size the checkpoint " << path.c_str() << ": " << std::strerror(errno));
+        return;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(Record), PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+
+    if (mapping == MAP_FAILED) {
+        ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                        << ": Could not map the checkpoint " << path.c_str() << ": " << std::strerror(errno));
+        return;
+    }
+
+    record = static_cast<Record*>(mapping);
+
+    if (!has_record || record->magic != CHECKPOINT_MAGIC || record->version != CHECKPOINT_VERSION ||
+        record->size != sizeof(Record)) {
+        std::memset(record, 0, sizeof(Record));
+        record->magic = CHECKPOINT_MAGIC;
+        record->version = CHECKPOINT_VERSION;
+        record->size = sizeof(Record);
+        record->state.operation = static_cast<uint8_t>(OperationIdentifier::UNDEFINED);
+        msync(record, sizeof(Record), MS_ASYNC);
+    } else if (record->sequence % 2 != 0) {
+        // Torn by a crash in the middle of an update, the state can't be trusted. The sequence is made even again,
+        // otherwise every later update would look torn.
+        std::memset(&record->state, 0, sizeof(record->state));
+        record->state.operation = static_cast<uint8_t>(OperationIdentifier::UNDEFINED);
+        record->sequence++;
+        msync(record, sizeof(Record), MS_ASYNC);
+    }
+}
+
+Checkpoint::~Checkpoint() {
+    if (record) {
+        munmap(record, sizeof(Record));
+    }
+
+    if (file_descriptor >= 0) {
+        close(file_descriptor);
+    }
+}
+
+bool Checkpoint::isOpen() const { return record != nullptr; }
+
+bool Checkpoint::load(CheckpointState& state, double& age) const {
+    if (!record || record->sequence % 2 != 0) {
+        return false;
+    }
+
+    state = record->state;
+    age = ros::WallTime::now().toSec() - record->stamp;
+    return true;
+}
+
+CheckpointState& Checkpoint::edit() {
+    record->sequence++;
+    // The state is only written once the sequence marks the update as in progress.
+    std::atomic_thread_fence(std::memory_order_release);
+    return record->state;
+}
+
+void Checkpoint::commit(const bool& should_flush) {
+    record->stamp = ros::WallTime::now().toSec();
+    std::atomic_thread_fence(std::memory_order_release);
+    record->sequence++;
+
+    if (should_flush) {
+        msync(record, sizeof(Record), MS_ASYNC);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * @file completion_notifier.cpp
+ */
+
+#include "completion_notifier.h"
+
+#include <fluid/OperationCompletion.h>
+#include <std_msgs/String.h>
+
+CompletionNotifier::CompletionNotifier(const ros::NodeHandle& node_handle, const size_t& capacity)
+    : capacity(capacity), node_handle(node_handle) {
+    completion_publisher = this->node_handle.advertise<std_msgs::String>("fluid/operation_completed", 1, true);
+    operation_completion_client =
+        this->node_handle.serviceClient<fluid::OperationCompletion>("fluid/operation_completion");
+    worker = std::thread(&CompletionNotifier::run, this);
+}
+
+CompletionNotifier::~CompletionNotifier() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    condition.notify_one();
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void CompletionNotifier::notify(const std::string& operation) {
+    unsigned int dropped_so_far = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (queue.size() >= capacity) {
+            queue.pop_front();
+            dropped++;
+            dropped_so_far = dropped;
+        }
+
+        queue.push_back(operation);
+    }
+
+    condition.notify_one();
+
+    if (dropped_so_far > 0) {
+        ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                        << ": Completion client is not keeping up, dropped " << dropped_so_far
+                        << " completions so far.");
+    }
+}
+
+unsigned int CompletionNotifier::getDroppedCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+void CompletionNotifier::run() {
+    while (true) {
+        std::string operation;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !queue.empty(); });
+
+            if (stopping) {
+                return;
+            }
+
+            operation = queue.front();
+            queue.pop_front();
+        }
+
+        std_msgs::String message;
+        message.data = operation;
+        completion_publisher.publish(message);
+
+        // The client may be slow or not running at all, only this thread waits for it.
+        fluid::OperationCompletion operation_completion;
+        operation_completion.request.operation = operation;
+
+        if (!operation_completion_client.call(operation_completion)) {
+            ROS_DEBUG_STREAM(ros::this_node::getName().c_str()
+                             << ": No client answered the completion of " << operation.c_str());
+        }
+    }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file configuration_loader.cpp
+ */
+
+#include "configuration_loader.h"
+
+#include <sstream>
+
+#include "fluid.h"
+
+ConfigurationLoader::ConfigurationLoader(const std::string& name_space) : name_space(name_space) {
+    ros::NodeHandle node_handle;
+
+    // One round trip to the master for the whole namespace instead of one per parameter.
+    if (!node_handle.getParam(name_space, parameters) || parameters.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+        errors.push_back("Could not fetch the parameters in " + name_space);
+    }
+}
+
+XmlRpc::XmlRpcValue* ConfigurationLoader::find(const std::string& key) {
+    if (parameters.getType() != XmlRpc::XmlRpcValue::TypeStruct) {
+        return nullptr;
+    }
+
+    if (!parameters.hasMember(key)) {
+        errors.push_back("Could not find parameter: " + name_space + "/" + key);
+        return nullptr;
+    }
+
+    return &parameters[key];
+}
+
+bool ConfigurationLoader::toNumber(const std::string& key, XmlRpc::XmlRpcValue& value, double& output) {
+    switch (value.getType()) {
+        case XmlRpc::XmlRpcValue::TypeInt:
+            output = static_cast<int&>(value);
+            return true;
+        case XmlRpc::XmlRpcValue::TypeDouble:
+            output = static_cast<double&>(value);
+            return true;
+        default:
+            errors.push_back("Parameter " + name_space + "/" + key + " is not a number");
+            return false;
+    }
+}
+
+void ConfigurationLoader::checkRange(const std::string& key,
+                                     const double& value,
+                                     const double& min,
+                                     const double& max) {
+    if (value < min || value > max) {
+        std::stringstream error;
+        error << "Parameter " << name_space << "/" << key << " = " << value << " is outside [" << min << ", " << max
+              << "]";
+        errors.push_back(error.str());
+    }
+}
+
+bool ConfigurationLoader::getBool(const std::string& key) {
+    XmlRpc::XmlRpcValue* value = find(key);
+
+    if (!value) {
+        return false;
+    }
+
+    if (value->getType() != XmlRpc::XmlRpcValue::TypeBoolean) {
+        errors.push_back("Parameter " + name_space + "/" + key + " is not a boolean");
+        return false;
+    }
+
+    return static_cast<bool&>(*value);
+}
+
+int ConfigurationLoader::getInt(const std::string& key, const int& min, const int& max) {
+    XmlRpc::XmlRpcValue* value = find(key);
+
+    if (!value) {
+        return 0;
+    }
+
+    if (value->getType() != XmlRpc::XmlRpcValue::TypeInt) {
+        errors.push_back("Parameter " + name_space + "/" + key + " is not an integer");
+        return 0;
+    }
+
+    const int result = static_cast<int&>(*value);
+    checkRange(key, result, min, max);
+    return result;
+}
+
+float ConfigurationLoader::getFloat(const std::string& key, const float& min, const float& max) {
+    XmlRpc::XmlRpcValue* value = find(key);
+    double result = 0;
+
+    if (!value || !toNumber(key, *value, result)) {
+        return 0;
+    }
+
+    checkRange(key, result, min, max);
+    return result;
+}
+
+std::string ConfigurationLoader::getString(const std::string& key) {
+    XmlRpc::XmlRpcValue* value = find(key);
+
+    if (!value) {
+        return "";
+    }
+
+    if (value->getType() != XmlRpc::XmlRpcValue::TypeString) {
+        errors.push_back("Parameter " + name_space + "/" + key + " is not a string");
+        return "";
+    }
+
+    return static_cast<std::string&>(*value);
+}
+
+const std::vector<std::string>& ConfigurationLoader::getErrors() const { return errors; }
+
+std::shared_ptr<FluidConfiguration> loadFluidConfiguration(const std::string& name_space) {
+    ConfigurationLoader loader(name_space);
+
+    float* fh_offset = (float*) calloc(3, sizeof(float));
+    fh_offset[0] = loader.getFloat("fh_offset_x", -2, 2);
+    fh_offset[1] = loader.getFloat("fh_offset_y", -2, 2);
+    fh_offset[2] = loader.getFloat("fh_offset_z", -2, 2);
+
+    // The elements of a braced initializer list are evaluated in order, so the errors are reported in the order of
+    // the configuration.
+    std::shared_ptr<FluidConfiguration> configuration_ptr(
+        new FluidConfiguration{loader.getBool("ekf"),
+                               loader.getBool("use_perception"),
+                               loader.getInt("refresh_rate", 1, 1000),
+                               loader.getInt("interaction_refresh_rate", 1, 1000),
+                               loader.getInt("interaction_max_refresh_rate", 1, 1000),
+                               loader.getInt("hold_refresh_rate", 1, 1000),
+                               loader.getInt("fcu_stream_rate", 1, 400),
+                               loader.getFloat("action_feedback_rate", 0.1, 100),
+                               loader.getInt("trajectory_refresh_rate", 1, 1000),
+                               loader.getFloat("trajectory_end_grace_period", 0, 60),
+                               loader.getBool("broadcast_base_link"),
+                               loader.getFloat("base_link_rate", 1, 1000),
+                               loader.getBool("should_auto_arm"),
+                               loader.getBool("should_auto_offboard"),
+                               loader.getFloat("distance_completion_threshold", 0.01, 10),
+                               loader.getFloat("velocity_completion_threshold", 0.01, 10),
+                               loader.getFloat("default_height", 0, 100),
+                               loader.getBool("interaction_show_prints"),
+                               loader.getFloat("interaction_max_vel", 0.01, 10),
+                               loader.getFloat("interaction_max_acc", 0.01, 10),
+                               loader.getBool("interaction_use_mpc"),
+                               loader.getFloat("travel_max_angle", 1, 80),
+                               fh_offset,
+                               loader.getFloat("travel_speed", 0.1, 50),
+                               loader.getFloat("travel_accel", 0.1, 50),
+                               loader.getFloat("path_tolerance", 0, 10),
+                               loader.getFloat("path_min_spacing", 0, 10),
+                               loader.getFloat("path_resample_spacing", 0, 1000),
+                               loader.getFloat("completion_horizon", 0, 5),
+                               loader.getBool("velocity_handover"),
+                               loader.getBool("fast_landing"),
+                               loader.getFloat("land_descent_speed", 0.1, 5),
+                               loader.getFloat("land_flare_height", 0.1, 10),
+                               loader.getFloat("land_final_speed", 0.05, 2),
+                               loader.getString("checkpoint_file"),
+                               loader.getString("tick_trigger_topic"),
+                               loader.getBool("tick_on_trigger")});
+
+    if (!loader.getErrors().empty()) {
+        for (const auto& error : loader.getErrors()) {
+            ROS_FATAL_STREAM(name_space << ": " << error.c_str());
+        }
+
+        return nullptr;
+    }
+
+    if (configuration_ptr->interact_max_refresh_rate < configuration_ptr->interact_refresh_rate) {
+        ROS_FATAL_STREAM(name_space << ": interaction_max_refresh_rate has to be at least interaction_refresh_rate");
+        return nullptr;
+    }
+
+    if (configuration_ptr->land_final_speed > configuration_ptr->land_descent_speed) {
+        ROS_FATAL_STREAM(name_space << ": land_final_speed can't be above land_descent_speed");
+        return nullptr;
+    }
+
+    if (configuration_ptr->tick_on_trigger && configuration_ptr->tick_trigger_topic.empty()) {
+        ROS_FATAL_STREAM(name_space << ": tick_on_trigger needs a tick_trigger_topic");
+        return nullptr;
+    }
+
+    return configuration_ptr;
+}
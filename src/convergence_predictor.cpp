@@ -0,0 +1,107 @@
+/**
+ * @file convergence_predictor.cpp
+ */
+
+#include "convergence_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "util.h"
+
+ConvergencePredictor::ConvergencePredictor(const double& horizon, const int& rate, const double& window)
+    : horizon(horizon), window(window), samples(std::max(size_t(std::ceil(window * rate)) + 1, size_t(MIN_SAMPLES))) {}
+
+void ConvergencePredictor::update(const double& time,
+                                  const geometry_msgs::Point& position,
+                                  const geometry_msgs::Point& target,
+                                  const geometry_msgs::Vector3& velocity) {
+    samples[next] = {time,
+                     Util::distanceBetween(position, target),
+                     std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z)};
+
+    next = (next + 1) % samples.size();
+    if (count < samples.size()) {
+        count++;
+    }
+}
+
+void ConvergencePredictor::reset() { count = 0; }
+
+bool ConvergencePredictor::fit(double& distance, double& distance_rate, double& speed, double& speed_rate) const {
+    const Sample& newest = samples[(next + samples.size() - 1) % samples.size()];
+
+    // Least squares with the time relative to the newest sample, so the intercepts are the fitted current values.
+    double n = 0, sum_t = 0, sum_tt = 0, sum_d = 0, sum_td = 0, sum_s = 0, sum_ts = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const Sample& sample = samples[(next + samples.size() - 1 - i) % samples.size()];
+        const double t = sample.time - newest.time;
+
+        if (t < -window) {
+            break;
+        }
+
+        n++;
+        sum_t += t;
+        sum_tt += t * t;
+        sum_d += sample.distance;
+        sum_td += t * sample.distance;
+        sum_s += sample.speed;
+        sum_ts += t * sample.speed;
+    }
+
+    const double denominator = n * sum_tt - sum_t * sum_t;
+
+    if (n < MIN_SAMPLES || denominator <= 0) {
+        return false;
+    }
+
+    distance_rate = (n * sum_td - sum_t * sum_d) / denominator;
+    distance = (sum_d - distance_rate * sum_t) / n;
+    speed_rate = (n * sum_ts - sum_t * sum_s) / denominator;
+    speed = (sum_s - speed_rate * sum_t) / n;
+
+    return true;
+}
+
+double ConvergencePredictor::getTimeToGo(const double& distance_tolerance, const double& velocity_tolerance) const {
+    if (count == 0) {
+        return -1;
+    }
+
+    const Sample& newest = samples[(next + samples.size() - 1) % samples.size()];
+
+    if (newest.distance < distance_tolerance && newest.speed < velocity_tolerance) {
+        return 0;
+    }
+
+    double distance, distance_rate, speed, speed_rate;
+
+    if (!fit(distance, distance_rate, speed, speed_rate)) {
+        return -1;
+    }
+
+    // Each quantity has to be within its tolerance already or be heading there.
+    auto time_until = [](const double& value, const double& rate, const double& tolerance) {
+        if (value < tolerance) {
+            return 0.0;
+        }
+
+        return rate < 0 ? (value - tolerance) / -rate : -1.0;
+    };
+
+    const double distance_time = time_until(distance, distance_rate, distance_tolerance);
+    const double speed_time = time_until(speed, speed_rate, velocity_tolerance);
+
+    if (distance_time < 0 || speed_time < 0) {
+        return -1;
+    }
+
+    return std::max(distance_time, speed_time);
+}
+
+bool ConvergencePredictor::hasConverged(const double& distance_tolerance, const double& velocity_tolerance) const {
+    const double time_to_go = getTimeToGo(distance_tolerance, velocity_tolerance);
+    return time_to_go == 0 || (time_to_go > 0 && time_to_go <= horizon);
+}
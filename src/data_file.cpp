@@ -13,8 +13,9 @@ DataFile::DataFile(std::string name, std::string path){
     m_save_z = true;
 }
 
-void DataFile::init(std::string title){
+void DataFile::init(const std::string& title){
     //create a header for the data file.
+    m_file.close();
     std::ofstream save_file_f;
     save_file_f.open(m_path+m_name);
     if(save_file_f.is_open())
@@ -28,8 +29,15 @@ void DataFile::init(std::string title){
     }
 }
 
+bool DataFile::openForAppend(){
+    if(!m_file.is_open())
+        m_file.open(m_path+m_name, std::ios::app);
+    return m_file.is_open();
+}
+
 void DataFile::initStateLog(){
     //create a header for the logfile.
+    m_file.close();
     std::ofstream save_file_f;
     save_file_f.open(m_path+m_name);
     if(save_file_f.is_open())
@@ -54,31 +62,27 @@ void DataFile::initStateLog(){
     }
 }
 
-void DataFile::saveVector3(const geometry_msgs::Vector3 vec){
-    std::ofstream save_file_f;
-    save_file_f.open (m_path+m_name, std::ios::app);
-    if(save_file_f.is_open())
+void DataFile::saveVector3(const geometry_msgs::Vector3& vec){
+    if(openForAppend())
     {
-        save_file_f << std::fixed << std::setprecision(m_precision) //fix decimal number
+        m_file << std::fixed << std::setprecision(m_precision) //fix decimal number
                         << ros::Time::now() << "\t"
                         << vec.x << "\t"
                         << vec.y;
         if(m_save_z)
-            save_file_f << std::fixed << std::setprecision(m_precision) << "\t" << vec.z;
+            m_file << std::fixed << std::setprecision(m_precision) << "\t" << vec.z;
         
-        save_file_f << "\n";
-        save_file_f.close();
+        m_file << "\n";
+        m_file.flush();
     }
 }
 
-void DataFile::saveStateLog(const geometry_msgs::Point pose, const geometry_msgs::Vector3 vel, const geometry_msgs::Vector3 accel)
+void DataFile::saveStateLog(const geometry_msgs::Point& pose, const geometry_msgs::Vector3& vel, const geometry_msgs::Vector3& accel)
 {
-    std::ofstream save_file_f;
-    save_file_f.open (m_path+m_name, std::ios::app);
-    if(save_file_f.is_open())
+    if(openForAppend())
     {
         if(m_save_z){
-            save_file_f << std::fixed << std::setprecision(m_precision) //fix decimal number
+            m_file << std::fixed << std::setprecision(m_precision) //fix decimal number
                         << ros::Time::now() << "\t"
                         << pose.x << "\t"
                         << pose.y << "\t"
@@ -91,7 +95,7 @@ void DataFile::saveStateLog(const geometry_msgs::Point pose, const geometry_msgs
                         << accel.z << "\n";
         }
         else{
-            save_file_f << std::fixed << std::setprecision(m_precision) //fix decimal number
+            m_file << std::fixed << std::setprecision(m_precision) //fix decimal number
                         << ros::Time::now() << "\t"
                         << pose.x << "\t"
                         << pose.y << "\t"
@@ -100,27 +104,25 @@ void DataFile::saveStateLog(const geometry_msgs::Point pose, const geometry_msgs
                         << accel.x << "\t"
                         << accel.y << "\n";
         }
-        save_file_f.close();
+        m_file.flush();
     }
 }
 
-void DataFile::saveStateLog(const mavros_msgs::PositionTarget data) //saveLog
+void DataFile::saveStateLog(const mavros_msgs::PositionTarget& data) //saveLog
 {
     saveStateLog(data.position, data.velocity, data.acceleration_or_force);
 }
 
-void DataFile::saveArray(double* vec, int n){
-    std::ofstream save_file_f;
-    save_file_f.open (m_path+m_name, std::ios::app);
-    if(save_file_f.is_open())
+void DataFile::saveArray(const double* vec, int n){
+    if(openForAppend())
     {
-        save_file_f << std::fixed << std::setprecision(m_precision) //fix decimal number
+        m_file << std::fixed << std::setprecision(m_precision) //fix decimal number
                     << ros::Time::now();
         for(int i = 0; i< n ; i++){
-            save_file_f << "\t" << vec[i];
+            m_file << "\t" << vec[i];
         }
-        save_file_f << "\n";
-        save_file_f.close();
+        m_file << "\n";
+        m_file.flush();
     }
 }
 
@@ -0,0 +1,139 @@
+/**
+ * @file deferred_log.cpp
+ */
+
+#include "deferred_log.h"
+
+#include <ros/ros.h>
+
+#include <chrono>
+#include <cstring>
+
+#define DRAIN_PERIOD 0.02  // Time between two drains of the rings by the background thread [s]
+
+constexpr size_t DeferredLog::ARGUMENT_SIZE;
+constexpr size_t DeferredLog::CAPACITY;
+
+DeferredLog::DeferredLog() {
+    worker = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(worker_mutex);
+
+        while (!should_stop) {
+            worker_condition.wait_for(lock, std::chrono::duration<double>(DRAIN_PERIOD));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    });
+}
+
+DeferredLog::~DeferredLog() {
+    {
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        should_stop = true;
+    }
+
+    worker_condition.notify_one();
+    worker.join();
+}
+
+DeferredLog& DeferredLog::getInstance() {
+    static DeferredLog instance;
+    return instance;
+}
+
+DeferredLog::Ring& DeferredLog::getRing() {
+    thread_local Ring* ring = nullptr;
+
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.emplace_back(new Ring());
+        ring = rings.back().get();
+    }
+
+    return *ring;
+}
+
+bool DeferredLog::isAllowed(Site& site) {
+    if (site.period <= 0) {
+        return true;
+    }
+
+    const int64_t now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    int64_t next_time = site.next_time.load(std::memory_order_relaxed);
+
+    // When several threads log from the same site at once, only the one which moves the next time forward gets
+    // through.
+    return now >= next_time &&
+           site.next_time.compare_exchange_strong(next_time, now + site.period, std::memory_order_relaxed);
+}
+
+void DeferredLog::push(const Site& site,
+                       const char* format,
+                       Formatter formatter,
+                       const void* arguments,
+                       const size_t& size) {
+    Ring& ring = getRing();
+    const size_t write = ring.write_index.load(std::memory_order_relaxed);
+
+    if (write - ring.read_index.load(std::memory_order_acquire) >= CAPACITY) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record& record = ring.records[write % CAPACITY];
+    record.site = &site;
+    record.format = format;
+    record.formatter = formatter;
+    std::memcpy(record.arguments, arguments, size);
+
+    ring.write_index.store(write + 1, std::memory_order_release);
+}
+
+void DeferredLog::flush() { drain(); }
+
+void DeferredLog::drain() {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    char message[512];
+
+    for (const std::unique_ptr<Ring>& ring : rings) {
+        size_t read = ring->read_index.load(std::memory_order_relaxed);
+        const size_t write = ring->write_index.load(std::memory_order_acquire);
+
+        for (; read != write; read++) {
+            const Record& record = ring->records[read % CAPACITY];
+            record.formatter(record.format, record.arguments, message, sizeof(message));
+            output(record.site->level, message);
+        }
+
+        ring->read_index.store(read, std::memory_order_release);
+
+        const uint64_t dropped = ring->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0) {
+            std::snprintf(message, sizeof(message), "Log ring full, dropped %lu messages.",
+                          static_cast<unsigned long>(dropped));
+            output(Level::WARN, message);
+        }
+    }
+}
+
+void DeferredLog::output(const Level& level, const char* message) {
+    const char* name = ros::this_node::getName().c_str();
+
+    switch (level) {
+        case Level::DEBUG:
+            ROS_DEBUG("%s: %s", name, message);
+            break;
+        case Level::INFO:
+            ROS_INFO("%s: %s", name, message);
+            break;
+        case Level::WARN:
+            ROS_WARN("%s: %s", name, message);
+            break;
+        case Level::ERROR:
+            ROS_ERROR("%s: %s", name, message);
+            break;
+    }
+}
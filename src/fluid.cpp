@@ -4,9 +4,17 @@
 
 #include "fluid.h"
 
-#include <fluid/OperationCompletion.h>
+#include <fluid/ExploreAction.h>
+#include <fluid/InteractAction.h>
+#include <fluid/LandAction.h>
+#include <fluid/TakeOffAction.h>
+#include <fluid/TravelAction.h>
+
+#include <algorithm>
+#include <cstring>
 
 #include "explore_operation.h"
+#include "follow_trajectory_operation.h"
 #include "interact_operation.h"
 #include "fluid.h"
 #include "hold_operation.h"
@@ -16,23 +24,261 @@
 #include "travel_operation.h"
 #include "util.h"
 
+#define MAX_CHECKPOINT_AGE 30.0     // A checkpoint not updated for longer than this is not resumed [s]
+#define TRIGGER_MIN_PERIOD 0.5      // Shortest time between two triggered steps, in periods of the operation
+#define LATENCY_REPORT_PERIOD 10.0  // Time between two reports of the input to setpoint latency [s]
+#define PARAM_RETRY_INTERVAL 0.5    // Time between two requests for a parameter ArduPilot didn't accept [s]
+
 /******************************************************************************************************
- *                                          Singleton                                                 *
+ *                                          Instance                                                  *
  ******************************************************************************************************/
 
-std::shared_ptr<Fluid> Fluid::instance_ptr;
+Fluid::Fluid(const FluidConfiguration& configuration,
+             const std::string& name_space,
+             ros::CallbackQueue* callback_queue,
+             std::shared_ptr<StartupTimeline> startup_timeline_ptr,
+             std::shared_ptr<StatusPublisher> status_publisher_ptr)
+    : status_publisher_ptr(status_publisher_ptr),
+      startup_timeline_ptr(startup_timeline_ptr ? startup_timeline_ptr : std::make_shared<StartupTimeline>()),
+      callback_queue(callback_queue ? callback_queue : ros::getGlobalCallbackQueue()),
+      node_handle(name_space),
+      configuration(configuration) {
+    node_handle.setCallbackQueue(this->callback_queue);
+
+    // The link with ArduPilot is the slowest part of the startup, so it's started first and runs concurrently
+    // with the rest of the setup.
+    fcu_link_thread = std::thread(&Fluid::establishFcuLink, this);
+
+    take_off_server = node_handle.advertiseService("fluid/take_off", &Fluid::take_off, this);
+    travel_server = node_handle.advertiseService("fluid/travel", &Fluid::travel, this);
+    explore_server = node_handle.advertiseService("fluid/explore", &Fluid::explore, this);
+    interact_server = node_handle.advertiseService("fluid/interact", &Fluid::interact, this);
+    land_server = node_handle.advertiseService("fluid/land", &Fluid::land, this);
+    mission_server = node_handle.advertiseService("fluid/mission", &Fluid::mission, this);
+    follow_trajectory_server =
+        node_handle.advertiseService("fluid/follow_trajectory", &Fluid::follow_trajectory, this);
+    advertiseActionServers();
+    completion_notifier_ptr = std::make_shared<CompletionNotifier>(node_handle);
+
+    if (!this->status_publisher_ptr) {
+        this->status_publisher_ptr = std::make_shared<StatusPublisher>(node_handle);
+    }
+
+    latency_monitor_ptr =
+        std::make_shared<LatencyMonitor>(node_handle, 0.1, 1.0, callback_queue ? "fluid_nodelet" : "fluid");
+    state_hub_ptr = std::make_shared<StateHub>(node_handle, latency_monitor_ptr,
+                                               configuration.should_broadcast_base_link,
+                                               configuration.base_link_rate);
+    mavros_interface_ptr = std::make_shared<MavrosInterface>(*this);
+    openCheckpoint(name_space);
 
-void Fluid::initialize(const FluidConfiguration configuration) {
-    if (!instance_ptr) {
-        // Can't use std::make_shared here as the constructor is private.
-        instance_ptr = std::shared_ptr<Fluid>(new Fluid(configuration));
+    if (!configuration.tick_trigger_topic.empty()) {
+        tick_trigger_ptr.reset(new TickTrigger(node_handle, configuration.tick_trigger_topic));
     }
+
+    this->startup_timeline_ptr->mark("services");
 }
 
-Fluid& Fluid::getInstance() { return *instance_ptr; }
+Fluid::~Fluid() {
+    if (fcu_link_thread.joinable()) {
+        fcu_link_thread.join();
+    }
+}
 
 std::shared_ptr<StatusPublisher> Fluid::getStatusPublisherPtr() { return status_publisher_ptr; }
 
+std::shared_ptr<LatencyMonitor> Fluid::getLatencyMonitorPtr() { return latency_monitor_ptr; }
+
+std::shared_ptr<StateHub> Fluid::getStateHubPtr() { return state_hub_ptr; }
+
+ros::CallbackQueue* Fluid::getCallbackQueue() const { return callback_queue; }
+
+const ros::NodeHandle& Fluid::getNodeHandle() const { return node_handle; }
+
+void Fluid::spinOnce() { callback_queue->callAvailable(); }
+
+bool Fluid::isLinkedWithArduPilot() const { return linked_with_ardupilot; }
+
+/******************************************************************************************************
+ *                                          Startup                                                   *
+ ******************************************************************************************************/
+
+void Fluid::establishFcuLink() {
+    MavrosInterface mavros_interface(node_handle.getNamespace(), &fcu_link_callback_queue);
+
+    mavros_interface.establishContactToArduPilot();
+    startup_timeline_ptr->mark("fcu_link");
+
+    if (!mavros_interface.requestStreamRate(configuration.fcu_stream_rate)) {
+        ROS_WARN_STREAM(ros::this_node::getName().c_str() << ": Could not set the stream rate of ArduPilot.");
+    }
+
+    startup_timeline_ptr->mark("fcu_streams");
+    linked_with_ardupilot = ros::ok();
+}
+
+/******************************************************************************************************
+ *                                          Checkpoint                                                *
+ ******************************************************************************************************/
+
+void Fluid::openCheckpoint(const std::string& name_space) {
+    if (configuration.checkpoint_file.empty()) {
+        return;
+    }
+
+    // The vehicles of a fleet share the configuration, so their checkpoints are told apart by their namespace.
+    std::string path = configuration.checkpoint_file;
+    if (node_handle.getNamespace() != "/") {
+        std::string suffix = node_handle.getNamespace();
+        std::replace(suffix.begin(), suffix.end(), '/', '_');
+        path += suffix;
+    }
+
+    checkpoint_ptr.reset(new Checkpoint(path));
+
+    if (!checkpoint_ptr->isOpen()) {
+        checkpoint_ptr.reset();
+        return;
+    }
+
+    std::unique_ptr<CheckpointState> state_ptr(new CheckpointState());
+    double age = 0;
+
+    if (!checkpoint_ptr->load(*state_ptr, age) ||
+        static_cast<OperationIdentifier>(state_ptr->operation) == OperationIdentifier::UNDEFINED) {
+        return;
+    }
+
+    const std::string operation =
+        getStringFromOperationIdentifier(static_cast<OperationIdentifier>(state_ptr->operation));
+
+    if (age > MAX_CHECKPOINT_AGE) {
+        ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                        << ": The checkpoint of " << operation.c_str() << " is " << age << " s old, not resuming it.");
+        return;
+    }
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                    << ": Found a checkpoint of " << operation.c_str() << " from " << age
+                    << " s ago, resuming it once the state of the drone is known.");
+    resume_state_ptr = std::move(state_ptr);
+}
+
+void Fluid::resumeFromCheckpoint() {
+    const CheckpointState& state = *resume_state_ptr;
+    const std::string operation = getStringFromOperationIdentifier(static_cast<OperationIdentifier>(state.operation));
+
+    if (!operation_execution_queue.empty()) {
+        ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                        << ": Not resuming " << operation.c_str() << ", another operation was requested.");
+        resume_state_ptr.reset();
+        return;
+    }
+
+    const mavros_msgs::State& fcu_state = mavros_interface_ptr->getCurrentState();
+
+    if (!fcu_state.connected || state_hub_ptr->getPose().header.stamp.isZero()) {
+        return;
+    }
+
+    // Whoever took over the drone while fluid was down keeps it.
+    if (!fcu_state.armed || fcu_state.mode != state.ardupilot_mode) {
+        ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                        << ": Not resuming " << operation.c_str() << ", the drone is "
+                        << (fcu_state.armed ? "in " + fcu_state.mode : std::string("disarmed")).c_str()
+                        << " since the restart.");
+
+        checkpoint_ptr->edit().operation = static_cast<uint8_t>(OperationIdentifier::UNDEFINED);
+        checkpoint_ptr->commit(true);
+        resume_state_ptr.reset();
+        return;
+    }
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Resuming " << operation.c_str()
+                                                      << (state.is_completed ? ", which had completed." : "."));
+
+    operation_execution_queue = createOperationsForCheckpoint(state);
+    current_operation = operation;
+    resume_state_ptr.reset();
+}
+
+std::list<std::shared_ptr<Operation>> Fluid::createOperationsForCheckpoint(const CheckpointState& state) {
+    const OperationIdentifier identifier = static_cast<OperationIdentifier>(state.operation);
+
+    // Holding first would only delay the landing.
+    if (identifier == OperationIdentifier::LAND) {
+        return {std::make_shared<LandOperation>(*this), std::make_shared<LandOperation>(*this)};
+    }
+
+    std::list<std::shared_ptr<Operation>> operations{std::make_shared<HoldOperation>(*this)};
+
+    if (state.is_completed) {
+        return operations;
+    }
+
+    switch (identifier) {
+        case OperationIdentifier::TRAVEL:
+        case OperationIdentifier::EXPLORE: {
+            std::vector<geometry_msgs::Point> path;
+            for (uint32_t i = state.path_index; i < std::min(state.path_size, CheckpointState::MAX_PATH_SIZE); i++) {
+                path.push_back(state.path[i].to<geometry_msgs::Point>());
+            }
+
+            if (path.empty()) {
+                return operations;
+            }
+
+            if (identifier == OperationIdentifier::TRAVEL) {
+                operations.push_back(std::make_shared<TravelOperation>(*this, path));
+            } else {
+                operations.push_back(std::make_shared<ExploreOperation>(
+                    *this, path, state.point_of_interest.to<geometry_msgs::Point>()));
+            }
+            break;
+        }
+
+        case OperationIdentifier::INTERACT: {
+            // The interaction starts over with the approach, but keeps what it has learnt about the mast.
+            std::shared_ptr<InteractOperation> interact_operation_ptr =
+                std::make_shared<InteractOperation>(*this, state.fixed_mast_yaw, state.offset);
+            interact_operation_ptr->restoreMastEstimate(state.mast_estimate);
+            operations.push_back(interact_operation_ptr);
+            break;
+        }
+
+        case OperationIdentifier::FOLLOW_TRAJECTORY:
+            // Follows the stream again from wherever the planner is.
+            operations.push_back(std::make_shared<FollowTrajectoryOperation>(*this));
+            break;
+
+        default:
+            // A take off can't be picked up in the air, the drone holds where it got to.
+            return operations;
+    }
+
+    operations.push_back(std::make_shared<HoldOperation>(*this));
+    return operations;
+}
+
+void Fluid::saveCheckpoint() {
+    CheckpointState& state = checkpoint_ptr->edit();
+
+    // A hold keeps the operation it follows in the checkpoint, and completes it when it ends the queue.
+    if (current_operation_ptr->identifier == OperationIdentifier::HOLD) {
+        state.is_completed = operation_execution_queue.empty();
+    } else {
+        std::memset(&state, 0, sizeof(state));
+        state.operation = static_cast<uint8_t>(current_operation_ptr->identifier);
+        current_operation_ptr->saveCheckpoint(state);
+    }
+
+    const std::string ardupilot_mode = current_operation_ptr->getArdupilotMode();
+    std::strncpy(state.ardupilot_mode, ardupilot_mode.c_str(), sizeof(state.ardupilot_mode) - 1);
+    state.ardupilot_mode[sizeof(state.ardupilot_mode) - 1] = '\0';
+
+    checkpoint_ptr->commit(true);
+}
+
 /******************************************************************************************************
  *                                          Operations                                                *
  ******************************************************************************************************/
@@ -40,7 +286,7 @@ std::shared_ptr<StatusPublisher> Fluid::getStatusPublisherPtr() { return status_
 bool Fluid::take_off(fluid::TakeOff::Request& request, fluid::TakeOff::Response& response) {
     Response attempt_response = attemptToCreateOperation(
         OperationIdentifier::TAKE_OFF,
-        {std::make_shared<TakeOffOperation>(request.height), std::make_shared<HoldOperation>()});
+        {std::make_shared<TakeOffOperation>(*this, request.height), std::make_shared<HoldOperation>(*this)});
 
     response.message = attempt_response.message;
     response.success = attempt_response.success;
@@ -50,7 +296,7 @@ bool Fluid::take_off(fluid::TakeOff::Request& request, fluid::TakeOff::Response&
 bool Fluid::travel(fluid::Travel::Request& request, fluid::Travel::Response& response) {
     Response attempt_response =
         attemptToCreateOperation(OperationIdentifier::TRAVEL,
-                                 {std::make_shared<TravelOperation>(request.path), std::make_shared<HoldOperation>()});
+                                 {std::make_shared<TravelOperation>(*this, request.path), std::make_shared<HoldOperation>(*this)});
 
     response.message = attempt_response.message;
     response.success = attempt_response.success;
@@ -60,7 +306,7 @@ bool Fluid::travel(fluid::Travel::Request& request, fluid::Travel::Response& res
 bool Fluid::explore(fluid::Explore::Request& request, fluid::Explore::Response& response) {
     Response attempt_response =
         attemptToCreateOperation(OperationIdentifier::EXPLORE,
-                                 {std::make_shared<ExploreOperation>(request.path, request.point_of_interest), std::make_shared<HoldOperation>()});
+                                 {std::make_shared<ExploreOperation>(*this, request.path, request.point_of_interest), std::make_shared<HoldOperation>(*this)});
 
     response.message = attempt_response.message;
     response.success = attempt_response.success;
@@ -70,7 +316,7 @@ bool Fluid::explore(fluid::Explore::Request& request, fluid::Explore::Response&
 bool Fluid::interact(fluid::Interact::Request& request, fluid::Interact::Response& response) {
     Response attempt_response =
         attemptToCreateOperation(OperationIdentifier::INTERACT,
-                                 {std::make_shared<InteractOperation>(request.fixed_mast_yaw, request.offset), std::make_shared<HoldOperation>()});
+                                 {std::make_shared<InteractOperation>(*this, request.fixed_mast_yaw, request.offset), std::make_shared<HoldOperation>(*this)});
     response.message = attempt_response.message;
     response.success = attempt_response.success;
     return true;
@@ -78,13 +324,94 @@ bool Fluid::interact(fluid::Interact::Request& request, fluid::Interact::Respons
 
 bool Fluid::land(fluid::Land::Request& request, fluid::Land::Response& response) {
     Response attempt_response = attemptToCreateOperation(
-        OperationIdentifier::LAND, {std::make_shared<LandOperation>(), std::make_shared<LandOperation>()});
+        OperationIdentifier::LAND, {std::make_shared<LandOperation>(*this), std::make_shared<LandOperation>(*this)});
+
+    response.message = attempt_response.message;
+    response.success = attempt_response.success;
+    return true;
+}
+
+bool Fluid::follow_trajectory(fluid::FollowTrajectory::Request& request,
+                              fluid::FollowTrajectory::Response& response) {
+    Response attempt_response = attemptToCreateOperation(
+        OperationIdentifier::FOLLOW_TRAJECTORY,
+        {std::make_shared<FollowTrajectoryOperation>(*this), std::make_shared<HoldOperation>(*this)});
 
     response.message = attempt_response.message;
     response.success = attempt_response.success;
     return true;
 }
 
+bool Fluid::mission(fluid::Mission::Request& request, fluid::Mission::Response& response) {
+    response.success = false;
+
+    if (request.items.empty()) {
+        response.message = "The mission is empty";
+        return true;
+    }
+
+    std::list<std::shared_ptr<Operation>> execution_queue;
+    OperationIdentifier previous_operation_identifier = getOperationIdentifierForOperation(current_operation_ptr);
+
+    for (size_t i = 0; i < request.items.size(); i++) {
+        std::shared_ptr<Operation> operation_ptr = createOperationForMissionItem(request.items[i]);
+
+        if (!operation_ptr) {
+            response.message = "Item " + std::to_string(i) + " has an unknown operation";
+            return true;
+        }
+
+        if (!isValidOperation(previous_operation_identifier, operation_ptr->identifier)) {
+            response.message = "Item " + std::to_string(i) + ": Cannot transition to " +
+                               getStringFromOperationIdentifier(operation_ptr->identifier) + " from " +
+                               getStringFromOperationIdentifier(previous_operation_identifier);
+            return true;
+        }
+
+        execution_queue.push_back(operation_ptr);
+
+        // A finished take off leaves the drone hovering, the same as it would be if a hold was in between.
+        previous_operation_identifier = operation_ptr->identifier == OperationIdentifier::TAKE_OFF
+                                            ? OperationIdentifier::HOLD
+                                            : operation_ptr->identifier;
+    }
+
+    // End the mission the same way the single operations end.
+    if (execution_queue.back()->identifier == OperationIdentifier::LAND) {
+        execution_queue.push_back(std::make_shared<LandOperation>(*this));
+    } else {
+        execution_queue.push_back(std::make_shared<HoldOperation>(*this));
+    }
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                    << ": Starting mission with " << request.items.size() << " operations");
+
+    supersedeActionGoal("MISSION");
+    got_new_operation = true;
+    operation_execution_queue = execution_queue;
+    current_operation = getStringFromOperationIdentifier(operation_execution_queue.front()->identifier);
+
+    response.success = true;
+    return true;
+}
+
+std::shared_ptr<Operation> Fluid::createOperationForMissionItem(const fluid::MissionItem& item) {
+    switch (item.operation) {
+        case fluid::MissionItem::TAKE_OFF:
+            return std::make_shared<TakeOffOperation>(*this, item.height);
+        case fluid::MissionItem::TRAVEL:
+            return std::make_shared<TravelOperation>(*this, item.path);
+        case fluid::MissionItem::EXPLORE:
+            return std::make_shared<ExploreOperation>(*this, item.path, item.point_of_interest);
+        case fluid::MissionItem::INTERACT:
+            return std::make_shared<InteractOperation>(*this, item.fixed_mast_yaw, item.offset);
+        case fluid::MissionItem::LAND:
+            return std::make_shared<LandOperation>(*this);
+        default:
+            return nullptr;
+    }
+}
+
 Fluid::Response Fluid::attemptToCreateOperation(const OperationIdentifier& target_operation_identifier,
                                                 const std::list<std::shared_ptr<Operation>>& execution_queue) {
     Response response;
@@ -103,6 +430,7 @@ Fluid::Response Fluid::attemptToCreateOperation(const OperationIdentifier& targe
                         << getStringFromOperationIdentifier(target_operation_identifier).c_str());
     }
 
+    supersedeActionGoal(getStringFromOperationIdentifier(target_operation_identifier));
     got_new_operation = true;
     operation_execution_queue = execution_queue;
     current_operation = getStringFromOperationIdentifier(operation_execution_queue.front()->identifier);
@@ -110,24 +438,205 @@ Fluid::Response Fluid::attemptToCreateOperation(const OperationIdentifier& targe
     return response;
 }
 
-std::shared_ptr<Operation> Fluid::performOperationTransition(std::shared_ptr<Operation> current_operation_ptr,
-                                                             std::shared_ptr<Operation> target_operation_ptr) {
-    ros::Rate rate(Fluid::getInstance().configuration.refresh_rate);
-    MavrosInterface mavros_interface;
+bool Fluid::performOperationTransition(std::shared_ptr<Operation> target_operation_ptr) {
+    const std::string target_operation_ardupilot_mode = target_operation_ptr->getArdupilotMode();
+
+    if (mavros_interface_ptr->getCurrentState().mode != target_operation_ardupilot_mode) {
+        // A request for the mode of an operation which has been replaced in the queue is dropped.
+        if (!mode_request.valid() || mode_request_mode != target_operation_ardupilot_mode) {
+            mode_request = mavros_interface_ptr->setModeAsync(target_operation_ardupilot_mode);
+            mode_request_mode = target_operation_ardupilot_mode;
+            return false;
+        }
+
+        if (mode_request.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        // The request is sent again on the next step if ArduPilot refused it.
+        if (!mode_request.get()) {
+            ROS_WARN_STREAM_THROTTLE(1, ros::this_node::getName().c_str()
+                                            << ": Failed to set " << target_operation_ardupilot_mode.c_str()
+                                            << ", retrying.");
+            return false;
+        }
+    }
+
+    mode_request = std::future<bool>();
+
+    if (configuration.velocity_handover && current_operation_ptr) {
+        target_operation_ptr->handover_velocity = state_hub_ptr->getTwist().twist.linear;
+    }
+
+    current_operation_ptr = target_operation_ptr;
+    return true;
+}
+
+/******************************************************************************************************
+ *                                          Actions                                                   *
+ ******************************************************************************************************/
+
+template <class ActionSpec>
+void Fluid::advertiseActionServer(const std::string& name,
+                                  const OperationIdentifier& target_operation_identifier,
+                                  std::function<std::list<std::shared_ptr<Operation>>(
+                                      const typename OperationActionServer<ActionSpec>::Goal&)> create_execution_queue) {
+    auto start = [this, target_operation_identifier, create_execution_queue](
+                     const typename OperationActionServer<ActionSpec>::Goal& goal,
+                     OperationActionServerInterface* server,
+                     std::string& message) -> bool {
+        // A new goal on the same server replaces the old one, which actionlib has already preempted.
+        if (active_action_server == server) {
+            active_action_server = nullptr;
+        }
+
+        Response response = attemptToCreateOperation(target_operation_identifier, create_execution_queue(goal));
+        message = response.message;
+
+        if (response.success) {
+            active_action_server = server;
+        }
+
+        return response.success;
+    };
+
+    action_servers.push_back(std::make_shared<OperationActionServer<ActionSpec>>(
+        node_handle, name, start, [this](OperationActionServerInterface* server) { cancelActionGoal(server); }));
+}
+
+void Fluid::advertiseActionServers() {
+    advertiseActionServer<fluid::TakeOffAction>(
+        "fluid/take_off_action", OperationIdentifier::TAKE_OFF, [this](const fluid::TakeOffGoal& goal) {
+            return std::list<std::shared_ptr<Operation>>{std::make_shared<TakeOffOperation>(*this, goal.height),
+                                                         std::make_shared<HoldOperation>(*this)};
+        });
+
+    advertiseActionServer<fluid::TravelAction>(
+        "fluid/travel_action", OperationIdentifier::TRAVEL, [this](const fluid::TravelGoal& goal) {
+            return std::list<std::shared_ptr<Operation>>{std::make_shared<TravelOperation>(*this, goal.path),
+                                                         std::make_shared<HoldOperation>(*this)};
+        });
+
+    advertiseActionServer<fluid::ExploreAction>(
+        "fluid/explore_action", OperationIdentifier::EXPLORE, [this](const fluid::ExploreGoal& goal) {
+            return std::list<std::shared_ptr<Operation>>{
+                std::make_shared<ExploreOperation>(*this, goal.path, goal.point_of_interest),
+                std::make_shared<HoldOperation>(*this)};
+        });
+
+    advertiseActionServer<fluid::InteractAction>(
+        "fluid/interact_action", OperationIdentifier::INTERACT, [this](const fluid::InteractGoal& goal) {
+            return std::list<std::shared_ptr<Operation>>{
+                std::make_shared<InteractOperation>(*this, goal.fixed_mast_yaw, goal.offset),
+                std::make_shared<HoldOperation>(*this)};
+        });
+
+    advertiseActionServer<fluid::LandAction>(
+        "fluid/land_action", OperationIdentifier::LAND, [this](const fluid::LandGoal& goal) {
+            return std::list<std::shared_ptr<Operation>>{std::make_shared<LandOperation>(*this),
+                                                         std::make_shared<LandOperation>(*this)};
+        });
+}
+
+void Fluid::supersedeActionGoal(const std::string& operation) {
+    if (active_action_server) {
+        active_action_server->abort("Superseded by " + operation);
+        active_action_server = nullptr;
+    }
+}
+
+void Fluid::cancelActionGoal(OperationActionServerInterface* server) {
+    if (active_action_server != server) {
+        return;
+    }
+
+    active_action_server = nullptr;
+
+    std::shared_ptr<Operation> operation_ptr = createFallbackOperation();
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                    << ": Goal preempted, transitioning to "
+                    << getStringFromOperationIdentifier(operation_ptr->identifier).c_str());
+
+    got_new_operation = true;
+    operation_execution_queue = {operation_ptr};
+    current_operation = getStringFromOperationIdentifier(operation_ptr->identifier);
+}
+
+std::shared_ptr<Operation> Fluid::createFallbackOperation() {
+    if (getOperationIdentifierForOperation(current_operation_ptr) == OperationIdentifier::TAKE_OFF) {
+        return std::make_shared<LandOperation>(*this);
+    }
+
+    return std::make_shared<HoldOperation>(*this);
+}
+
+void Fluid::handleFailedOperation(const std::string& reason) {
+    std::shared_ptr<Operation> operation_ptr = createFallbackOperation();
+
+    ROS_ERROR_STREAM(ros::this_node::getName().c_str()
+                     << ": " << current_operation.c_str() << " failed: " << reason.c_str() << ", transitioning to "
+                     << getStringFromOperationIdentifier(operation_ptr->identifier).c_str());
+
+    if (active_action_server) {
+        active_action_server->abort(current_operation + " failed: " + reason);
+        active_action_server = nullptr;
+    }
+
+    operation_execution_queue = {operation_ptr};
+    current_operation = getStringFromOperationIdentifier(operation_ptr->identifier);
+}
+
+void Fluid::setParam(const std::string& parameter, const float& value) {
+    param_requests.remove_if([&](const ParamRequest& request) { return request.parameter == parameter; });
+
+    ParamRequest request;
+    request.parameter = parameter;
+    request.value = value;
+    request.result = mavros_interface_ptr->setParamAsync(parameter, value);
+    request.request_time = ros::Time::now();
+    param_requests.push_back(std::move(request));
+}
+
+void Fluid::pollParamRequests() {
+    const ros::Time now = ros::Time::now();
+
+    for (auto iterator = param_requests.begin(); iterator != param_requests.end();) {
+        ParamRequest& request = *iterator;
+
+        if (!request.result.valid()) {
+            if ((now - request.request_time).toSec() > PARAM_RETRY_INTERVAL) {
+                request.result = mavros_interface_ptr->setParamAsync(request.parameter, request.value);
+                request.request_time = now;
+            }
+        } else if (request.result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            if (request.result.get()) {
+                iterator = param_requests.erase(iterator);
+                continue;
+            }
+
+            ROS_WARN_STREAM_THROTTLE(1, ros::this_node::getName().c_str()
+                                            << ": Failed to set param " << request.parameter.c_str()
+                                            << " for ArduPilot, retrying.");
+        }
 
-    // Loop until the Ardupilot mode is set.
-    const std::string target_operation_ardupilot_mode = getArdupilotModeForOperationIdentifier(target_operation_ptr->identifier);
-    while (ros::ok() && !mavros_interface.attemptToSetMode(target_operation_ardupilot_mode)) {
-        ros::spinOnce();
-        rate.sleep();
+        iterator++;
     }
+}
+
+void Fluid::publishActionFeedback(const Operation& operation) {
+    if (!active_action_server) {
+        return;
+    }
+
+    const ros::Time now = ros::Time::now();
 
-    if (current_operation_ptr) {
-        target_operation_ptr->current_pose = current_operation_ptr->getCurrentPose();
-        target_operation_ptr->current_twist = current_operation_ptr->getCurrentTwist();
+    if ((now - last_feedback_time).toSec() < 1.0 / configuration.action_feedback_rate) {
+        return;
     }
 
-    return target_operation_ptr;
+    last_feedback_time = now;
+    active_action_server->publishFeedback(operation.getProgress());
 }
 
 /******************************************************************************************************
@@ -156,10 +665,11 @@ bool Fluid::isValidOperation(const OperationIdentifier& current_operation_identi
                    current_operation_identifier != OperationIdentifier::UNDEFINED;
 
         case OperationIdentifier::LAND:
-            return current_operation_identifier != OperationIdentifier::TAKE_OFF &&
-                   current_operation_identifier != OperationIdentifier::UNDEFINED;
+            // Landing can preempt the take off at any of its stages.
+            return current_operation_identifier != OperationIdentifier::UNDEFINED;
 
         case OperationIdentifier::INTERACT:
+        case OperationIdentifier::FOLLOW_TRAJECTORY:
             return current_operation_identifier != OperationIdentifier::TAKE_OFF &&
                    current_operation_identifier != OperationIdentifier::LAND &&
                    current_operation_identifier != OperationIdentifier::UNDEFINED;
@@ -172,37 +682,153 @@ bool Fluid::isValidOperation(const OperationIdentifier& current_operation_identi
  *                                          Main Logic                                                *
  ******************************************************************************************************/
 
-void Fluid::run() {
-    ros::Rate rate(configuration.refresh_rate);
-    bool has_called_completion = false;
+ros::Duration Fluid::step() {
+    const ros::Duration idle_period(1.0 / configuration.refresh_rate);
+
+    if (!has_started) {
+        startup_timeline_ptr->mark("main_loop");
+        has_started = true;
+    }
+
+    if (!has_reported_startup && isLinkedWithArduPilot()) {
+        startup_timeline_ptr->mark("ready");
+        startup_timeline_ptr->report();
+        getStatusPublisherPtr()->status.linked_with_ardupilot = 1;
+        has_reported_startup = true;
+    }
+
+    pollParamRequests();
+
+    if (!is_performing) {
+        if (resume_state_ptr) {
+            resumeFromCheckpoint();
+        }
 
-    while (ros::ok()) {
         got_new_operation = false;
+        bool has_transitioned = false;
+
         if (!operation_execution_queue.empty()) {
-            current_operation_ptr =
-                performOperationTransition(current_operation_ptr, operation_execution_queue.front());
+            // The queue is kept until ArduPilot is in the mode of the next operation, the transition is attempted
+            // again on the next step.
+            if (!performOperationTransition(operation_execution_queue.front())) {
+                spinOnce();
+                return idle_period;
+            }
+
             operation_execution_queue.pop_front();
+            has_transitioned = true;
+
+            // Missions run several operations from one queue, the hold at the end keeps the name of the operation
+            // which completed.
+            if (current_operation_ptr->identifier != OperationIdentifier::HOLD) {
+                current_operation = getStringFromOperationIdentifier(current_operation_ptr->identifier);
+            }
             has_called_completion = false;
         }
 
         // If we are at the steady operation, we call the completion service
         if (operation_execution_queue.empty() && !has_called_completion) {
-            fluid::OperationCompletion operation_completion;
-            operation_completion.request.operation = current_operation;
-            operation_completion_client.call(operation_completion);
+            completion_notifier_ptr->notify(current_operation);
             has_called_completion = true;
+
+            if (active_action_server) {
+                active_action_server->succeed(current_operation + " completed");
+                active_action_server = nullptr;
+            }
+        }
+
+        if (!current_operation_ptr) {
+            spinOnce();
+            return idle_period;
+        }
+
+        getStatusPublisherPtr()->status.current_operation = current_operation;
+        getStatusPublisherPtr()->status.ardupilot_mode = current_operation_ptr->getArdupilotMode();
+
+        should_halt_if_steady = operation_execution_queue.empty();
+        current_operation_ptr->begin();
+        is_performing = true;
+
+        if (has_transitioned && checkpoint_ptr) {
+            saveCheckpoint();
         }
+    }
+
+    const ros::WallTime input_arrival_time =
+        tick_trigger_ptr ? tick_trigger_ptr->consumeArrivalTime() : ros::WallTime();
+
+    is_performing = current_operation_ptr->step(should_halt_if_steady) && !got_new_operation && !should_stop;
+
+    if (tick_trigger_ptr) {
+        recordInputLatency(input_arrival_time);
+    }
+
+    if (checkpoint_ptr) {
+        current_operation_ptr->saveCheckpointProgress(checkpoint_ptr->edit());
+        checkpoint_ptr->commit();
+    }
 
-        if (current_operation_ptr) {
-            getStatusPublisherPtr()->status.current_operation = current_operation;
-            getStatusPublisherPtr()->status.ardupilot_mode =
-                getArdupilotModeForOperationIdentifier(current_operation_ptr->identifier);
+    if (!is_performing) {
+        current_operation_ptr->end();
 
-            current_operation_ptr->perform([&]() -> bool { return !got_new_operation; },
-                                           operation_execution_queue.empty());
+        // An operation requested in the meantime takes over from the failed one.
+        if (!current_operation_ptr->failure_reason.empty() && !got_new_operation) {
+            handleFailedOperation(current_operation_ptr->failure_reason);
         }
+    }
+
+    return current_operation_ptr->getPeriod();
+}
+
+void Fluid::recordInputLatency(const ros::WallTime& arrival_time) {
+    const ros::WallTime now = ros::WallTime::now();
 
-        ros::spinOnce();
-        rate.sleep();
+    // Only the first step after an input waited for it.
+    if (!arrival_time.isZero() && arrival_time != last_input_arrival_time) {
+        input_latency_histogram.record((now - arrival_time).toSec());
+        last_input_arrival_time = arrival_time;
+    }
+
+    if (last_latency_report_time.isZero()) {
+        last_latency_report_time = now;
+    } else if ((now - last_latency_report_time).toSec() >= LATENCY_REPORT_PERIOD &&
+               input_latency_histogram.getCount() > 0) {
+        ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                        << ": Input to setpoint latency on " << configuration.tick_trigger_topic.c_str()
+                        << (configuration.tick_on_trigger ? " (triggered): " : " (fixed rate): ")
+                        << input_latency_histogram.toString().c_str());
+
+        input_latency_histogram = LatencyHistogram();
+        last_latency_report_time = now;
     }
 }
+
+void Fluid::run() {
+    ros::Time due_time = ros::Time::now();
+
+    while (!isStopped()) {
+        const ros::Duration period = step();
+
+        // The next step runs as soon as the trigger arrives, at most at twice the rate of the operation, and at its
+        // rate when the trigger is late.
+        if (tick_trigger_ptr && configuration.tick_on_trigger) {
+            tick_trigger_ptr->wait(ros::WallDuration(period.toSec() * TRIGGER_MIN_PERIOD),
+                                   ros::WallDuration(period.toSec()));
+            continue;
+        }
+
+        due_time += period;
+
+        // Like ros::Rate, a loop which has fallen behind starts over from now instead of catching up.
+        const ros::Time now = ros::Time::now();
+        if (due_time < now) {
+            due_time = now;
+        } else {
+            ros::Time::sleepUntil(due_time);
+        }
+    }
+}
+
+void Fluid::stop() { should_stop = true; }
+
+bool Fluid::isStopped() const { return should_stop || !ros::ok(); }
@@ -0,0 +1,94 @@
+/**
+ * @file fluid_executor.cpp
+ */
+
+#include "fluid_executor.h"
+
+#include <algorithm>
+#include <chrono>
+
+#define IDLE_WAIT 0.1             // Longest time a thread waits before it checks whether ROS is still running [s]
+#define CLOCK_JUMP_THRESHOLD 2.0  // A step due further ahead than this follows a clock reset and is run now [s]
+
+FluidExecutor::FluidExecutor(const unsigned int& thread_count) {
+    for (unsigned int i = 0; i < std::max(thread_count, 1u); i++) {
+        threads.emplace_back(&FluidExecutor::work, this);
+    }
+}
+
+FluidExecutor::~FluidExecutor() {
+    stop();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void FluidExecutor::add(std::shared_ptr<Fluid> fluid_ptr) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        schedule.push({ros::Time::now(), fluid_ptr});
+        active_count++;
+    }
+
+    condition.notify_one();
+}
+
+void FluidExecutor::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!should_stop && active_count > 0 && ros::ok()) {
+        condition.wait_for(lock, std::chrono::duration<double>(IDLE_WAIT));
+    }
+}
+
+void FluidExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        should_stop = true;
+    }
+
+    condition.notify_all();
+}
+
+void FluidExecutor::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!should_stop && ros::ok()) {
+        if (schedule.empty()) {
+            condition.wait_for(lock, std::chrono::duration<double>(IDLE_WAIT));
+            continue;
+        }
+
+        const double wait = (schedule.top().due_time - ros::Time::now()).toSec();
+
+        if (wait > 0 && wait < CLOCK_JUMP_THRESHOLD) {
+            // Woken up early when an instance is scheduled, it might be due before the one on top.
+            condition.wait_for(lock, std::chrono::duration<double>(std::min(wait, IDLE_WAIT)));
+            continue;
+        }
+
+        Entry entry = schedule.top();
+        schedule.pop();
+        lock.unlock();
+
+        entry.due_time += entry.fluid_ptr->step();
+        const bool is_stopped = entry.fluid_ptr->isStopped();
+
+        // Like ros::Rate, an instance which has fallen behind starts over from now instead of catching up.
+        const ros::Time now = ros::Time::now();
+        if (entry.due_time < now) {
+            entry.due_time = now;
+        }
+
+        lock.lock();
+
+        if (is_stopped) {
+            active_count--;
+            condition.notify_all();
+        } else {
+            schedule.push(entry);
+            condition.notify_one();
+        }
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file frame_transformer.cpp
+ */
+
+#include "frame_transformer.h"
+
+#include <cmath>
+
+FrameTransformer::FrameTransformer(const float& mast_yaw, const geometry_msgs::Point& fh_offset)
+    : mast_yaw(mast_yaw),
+      mast_cos_yaw(cos(mast_yaw)),
+      mast_sin_yaw(sin(mast_yaw)),
+      drone_yaw(0.0),
+      drone_cos_yaw(1.0),
+      drone_sin_yaw(0.0),
+      fh_offset(fh_offset) {}
+
+void FrameTransformer::setMastYaw(const float& yaw) {
+    if (yaw != mast_yaw) {
+        mast_yaw = yaw;
+        mast_cos_yaw = cos(yaw);
+        mast_sin_yaw = sin(yaw);
+    }
+}
+
+void FrameTransformer::setDroneYaw(const float& yaw) {
+    if (yaw != drone_yaw) {
+        drone_yaw = yaw;
+        drone_cos_yaw = cos(yaw);
+        drone_sin_yaw = sin(yaw);
+    }
+}
+
+float FrameTransformer::getMastYaw() const { return mast_yaw; }
+
+const geometry_msgs::Point& FrameTransformer::getFaceHuggerOffset() const { return fh_offset; }
+
+mavros_msgs::PositionTarget FrameTransformer::rotate(const mavros_msgs::PositionTarget& in,
+                                                     const double& cos_yaw,
+                                                     const double& sin_yaw) {
+    mavros_msgs::PositionTarget out = in;
+    out.position = rotate(in.position, cos_yaw, sin_yaw);
+    out.velocity = rotate(in.velocity, cos_yaw, sin_yaw);
+    out.acceleration_or_force = rotate(in.acceleration_or_force, cos_yaw, sin_yaw);
+    return out;
+}
+
+PVAState FrameTransformer::rotate(const PVAState& in, const double& cos_yaw, const double& sin_yaw) {
+    return {rotate(in.position, cos_yaw, sin_yaw), rotate(in.velocity, cos_yaw, sin_yaw),
+            rotate(in.acceleration, cos_yaw, sin_yaw)};
+}
+
+/******************************************************************************************************
+ *                                          Mast frame                                                *
+ ******************************************************************************************************/
+
+geometry_msgs::Point FrameTransformer::mastToWorld(const geometry_msgs::Point& point) const {
+    return rotate(point, mast_cos_yaw, mast_sin_yaw);
+}
+
+geometry_msgs::Vector3 FrameTransformer::mastToWorld(const geometry_msgs::Vector3& vector) const {
+    return rotate(vector, mast_cos_yaw, mast_sin_yaw);
+}
+
+mavros_msgs::PositionTarget FrameTransformer::mastToWorld(const mavros_msgs::PositionTarget& state) const {
+    return rotate(state, mast_cos_yaw, mast_sin_yaw);
+}
+
+Vec3 FrameTransformer::mastToWorld(const Vec3& vector) const { return rotate(vector, mast_cos_yaw, mast_sin_yaw); }
+
+PVAState FrameTransformer::mastToWorld(const PVAState& state) const {
+    return rotate(state, mast_cos_yaw, mast_sin_yaw);
+}
+
+geometry_msgs::Point FrameTransformer::worldToMast(const geometry_msgs::Point& point) const {
+    return rotate(point, mast_cos_yaw, -mast_sin_yaw);
+}
+
+geometry_msgs::Vector3 FrameTransformer::worldToMast(const geometry_msgs::Vector3& vector) const {
+    return rotate(vector, mast_cos_yaw, -mast_sin_yaw);
+}
+
+mavros_msgs::PositionTarget FrameTransformer::worldToMast(const mavros_msgs::PositionTarget& state) const {
+    return rotate(state, mast_cos_yaw, -mast_sin_yaw);
+}
+
+Vec3 FrameTransformer::worldToMast(const Vec3& vector) const { return rotate(vector, mast_cos_yaw, -mast_sin_yaw); }
+
+PVAState FrameTransformer::worldToMast(const PVAState& state) const {
+    return rotate(state, mast_cos_yaw, -mast_sin_yaw);
+}
+
+void FrameTransformer::mastToWorld(const std::vector<mavros_msgs::PositionTarget>& trajectory,
+                                   std::vector<mavros_msgs::PositionTarget>& output) const {
+    output.resize(trajectory.size());
+
+    for (size_t i = 0; i < trajectory.size(); i++) {
+        output[i] = rotate(trajectory[i], mast_cos_yaw, mast_sin_yaw);
+    }
+}
+
+void FrameTransformer::worldToMast(const std::vector<mavros_msgs::PositionTarget>& trajectory,
+                                   std::vector<mavros_msgs::PositionTarget>& output) const {
+    output.resize(trajectory.size());
+
+    for (size_t i = 0; i < trajectory.size(); i++) {
+        output[i] = rotate(trajectory[i], mast_cos_yaw, -mast_sin_yaw);
+    }
+}
+
+/******************************************************************************************************
+ *                                          Drone body frame                                          *
+ ******************************************************************************************************/
+
+geometry_msgs::Point FrameTransformer::bodyToWorld(const geometry_msgs::Point& point) const {
+    return rotate(point, drone_cos_yaw, drone_sin_yaw);
+}
+
+geometry_msgs::Vector3 FrameTransformer::bodyToWorld(const geometry_msgs::Vector3& vector) const {
+    return rotate(vector, drone_cos_yaw, drone_sin_yaw);
+}
+
+mavros_msgs::PositionTarget FrameTransformer::bodyToWorld(const mavros_msgs::PositionTarget& state) const {
+    return rotate(state, drone_cos_yaw, drone_sin_yaw);
+}
+
+geometry_msgs::Point FrameTransformer::worldToBody(const geometry_msgs::Point& point) const {
+    return rotate(point, drone_cos_yaw, -drone_sin_yaw);
+}
+
+geometry_msgs::Vector3 FrameTransformer::worldToBody(const geometry_msgs::Vector3& vector) const {
+    return rotate(vector, drone_cos_yaw, -drone_sin_yaw);
+}
+
+mavros_msgs::PositionTarget FrameTransformer::worldToBody(const mavros_msgs::PositionTarget& state) const {
+    return rotate(state, drone_cos_yaw, -drone_sin_yaw);
+}
+
+/******************************************************************************************************
+ *                                          FaceHugger                                                *
+ ******************************************************************************************************/
+
+geometry_msgs::Point FrameTransformer::faceHuggerToDrone(const double& forward, const double& up) const {
+    geometry_msgs::Point offset;
+    offset.x = fh_offset.x + forward;
+    offset.y = fh_offset.y;
+    offset.z = fh_offset.z + up;
+    return offset;
+}
+
+geometry_msgs::Point FrameTransformer::standoff(const double& distance, const double& up) const {
+    geometry_msgs::Point offset;
+    offset.x = distance;
+    offset.y = fh_offset.y;
+    offset.z = fh_offset.z + up;
+    return offset;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file latency_histogram.cpp
+ */
+
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+constexpr std::array<double, 9> LatencyHistogram::EDGES;
+
+void LatencyHistogram::record(const double& latency) {
+    const size_t bin = std::lower_bound(EDGES.begin(), EDGES.end(), latency) - EDGES.begin();
+    counts[bin]++;
+    max = std::max(max, latency);
+}
+
+void LatencyHistogram::recordTimeout() { timeouts++; }
+
+unsigned int LatencyHistogram::getCount() const {
+    unsigned int count = timeouts;
+
+    for (const auto& bin_count : counts) {
+        count += bin_count;
+    }
+
+    return count;
+}
+
+std::string LatencyHistogram::toString() const {
+    std::stringstream line;
+    line << std::fixed << std::setprecision(1);
+
+    for (size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+
+        if (i < EDGES.size()) {
+            line << "<" << EDGES[i] * 1000 << "ms: " << counts[i] << ", ";
+        } else {
+            line << ">" << EDGES.back() * 1000 << "ms: " << counts[i] << ", ";
+        }
+    }
+
+    line << "max: " << max * 1000 << "ms, timeouts: " << timeouts;
+    return line.str();
+}
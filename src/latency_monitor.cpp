@@ -0,0 +1,109 @@
+/**
+ * @file latency_monitor.cpp
+ */
+
+#include "latency_monitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+LatencyMonitor::LatencyMonitor(const ros::NodeHandle& node_handle,
+                               const double& warning_latency,
+                               const double& publish_rate,
+                               const std::string& hardware_id)
+    : warning_latency(warning_latency),
+      publish_period(1.0 / publish_rate),
+      hardware_id(hardware_id),
+      node_handle(node_handle) {
+    diagnostics_publisher = this->node_handle.advertise<diagnostic_msgs::DiagnosticArray>("fluid/latency", 1);
+}
+
+size_t LatencyMonitor::addSource(const std::string& name) {
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (sources[i].name == name) {
+            return i;
+        }
+    }
+
+    Statistics statistics;
+    statistics.name = name;
+    sources.push_back(statistics);
+
+    return sources.size() - 1;
+}
+
+double LatencyMonitor::record(const size_t& source, const ros::Time& stamp, const ros::Time& now) {
+    Statistics& statistics = sources[source];
+    const double latency = (now - stamp).toSec();
+
+    if (statistics.count == 0) {
+        statistics.mean = statistics.min = statistics.max = latency;
+        statistics.jitter = 0;
+    } else {
+        statistics.mean += smoothing * (latency - statistics.mean);
+        statistics.jitter += smoothing * (std::abs(latency - statistics.mean) - statistics.jitter);
+        statistics.min = std::min(statistics.min, latency);
+        statistics.max = std::max(statistics.max, latency);
+    }
+
+    statistics.last = latency;
+    statistics.count++;
+
+    return latency;
+}
+
+double LatencyMonitor::getMeanLatency(const size_t& source) const { return sources[source].mean; }
+
+void LatencyMonitor::publish() {
+    const ros::Time now = ros::Time::now();
+
+    if ((now - last_publish_time).toSec() < publish_period) {
+        return;
+    }
+
+    last_publish_time = now;
+    diagnostics.header.stamp = now;
+    diagnostics.status.resize(sources.size());
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        const Statistics& statistics = sources[i];
+        diagnostic_msgs::DiagnosticStatus& status = diagnostics.status[i];
+
+        // The names don't change once a source is added, and the strings keep their capacity between publishes.
+        if (status.name.empty()) {
+            status.name = "fluid: " + statistics.name + " latency";
+            status.hardware_id = hardware_id;
+        }
+
+        if (statistics.count == 0) {
+            status.level = diagnostic_msgs::DiagnosticStatus::STALE;
+            status.message = "No data";
+        } else if (statistics.mean > warning_latency) {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            status.message = "High latency";
+        } else {
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.message = "OK";
+        }
+
+        // The delay budget is what the consumer has to compensate for in the worst case.
+        const std::pair<const char*, double> values[] = {{"last", statistics.last},
+                                                         {"mean", statistics.mean},
+                                                         {"jitter", statistics.jitter},
+                                                         {"min", statistics.min},
+                                                         {"max", statistics.max},
+                                                         {"delay_budget", statistics.mean + 3 * statistics.jitter},
+                                                         {"count", (double)statistics.count}};
+
+        status.values.resize(sizeof(values) / sizeof(values[0]));
+        for (size_t j = 0; j < status.values.size(); j++) {
+            char value[32];
+            std::snprintf(value, sizeof(value), "%f", values[j].second);
+            status.values[j].key = values[j].first;
+            status.values[j].value = value;
+        }
+    }
+
+    diagnostics_publisher.publish(diagnostics);
+}
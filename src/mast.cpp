@@ -3,33 +3,42 @@
  */
 #include "mast.h"
 #include "util.h"
-#include "fluid.h"
 
-Mast::Mast(float yaw){
+Mast::Mast(float yaw, bool show_prints){
     m_fixed_yaw = yaw;
     m_period = 10;
-    m_SHOW_PRINTS = Fluid::getInstance().configuration.interaction_show_prints;
+    m_SHOW_PRINTS = show_prints;
     m_current_extremum = 0;
+    m_forward_mean = 0;
+    m_forward_deviation = 0;
+    m_amplitude_estimation_time = 0;
 }
 
-void Mast::updateFromEkf(mavros_msgs::PositionTarget module_state){
-    interaction_point_state = module_state;
+void Mast::updateFromEkf(const mavros_msgs::PositionTarget& module_state){
+    interaction_point_state = PVAState::from(module_state);
+    interaction_point_stamp = module_state.header.stamp;
+    estimateAmplitude();
+    saveToHistory();
 }
 
-void Mast::update(geometry_msgs::PoseStamped module_pose){
-    if(module_pose.header.stamp.toSec() - interaction_point_state.header.stamp.toSec() > 0.010){
+void Mast::update(const Pose& module_pose, const ros::Time& stamp){
+    if(stamp.toSec() - interaction_point_stamp.toSec() > 0.010){
     //sanity check that it is a new message.
         previous_interaction_point_state = interaction_point_state;
-        interaction_point_state.header = module_pose.header;
-        interaction_point_state.position = module_pose.pose.position;
+        previous_interaction_point_stamp = interaction_point_stamp;
+        interaction_point_stamp = stamp;
+        interaction_point_state.position = module_pose.position;
         estimateInteractionPointVel();    
         estimateInteractionPointAccel(); //this takes into account the updated velocity.
+        estimateAmplitude();
+        saveToHistory();
     }
+    search_period(module_pose.orientation.x);
 }
 
 void Mast::estimateInteractionPointVel(){
     // estimate the velocity of the interaction_point by a simple derivation of the position.
-    double dt = (interaction_point_state.header.stamp - previous_interaction_point_state.header.stamp).toSec();
+    double dt = (interaction_point_stamp - previous_interaction_point_stamp).toSec();
     interaction_point_state.velocity.x = (interaction_point_state.position.x - previous_interaction_point_state.position.x)/dt;
     interaction_point_state.velocity.y = (interaction_point_state.position.y - previous_interaction_point_state.position.y)/dt;
     interaction_point_state.velocity.z = (interaction_point_state.position.z - previous_interaction_point_state.position.z)/dt;
@@ -37,10 +46,40 @@ void Mast::estimateInteractionPointVel(){
 
 void Mast::estimateInteractionPointAccel(){
     // estimate the acceleration of the interaction_point by simply derivating the velocity.
-    double dt = (interaction_point_state.header.stamp - previous_interaction_point_state.header.stamp).toSec();
-    interaction_point_state.acceleration_or_force.x = (interaction_point_state.velocity.x - previous_interaction_point_state.velocity.x)/dt;
-    interaction_point_state.acceleration_or_force.y = (interaction_point_state.velocity.y - previous_interaction_point_state.velocity.y)/dt;
-    interaction_point_state.acceleration_or_force.z = (interaction_point_state.velocity.z - previous_interaction_point_state.velocity.z)/dt;
+    double dt = (interaction_point_stamp - previous_interaction_point_stamp).toSec();
+    interaction_point_state.acceleration.x = (interaction_point_state.velocity.x - previous_interaction_point_state.velocity.x)/dt;
+    interaction_point_state.acceleration.y = (interaction_point_state.velocity.y - previous_interaction_point_state.velocity.y)/dt;
+    interaction_point_state.acceleration.z = (interaction_point_state.velocity.z - previous_interaction_point_state.velocity.z)/dt;
+}
+
+void Mast::estimateAmplitude(){
+    // Exponential running mean of the position along the mast x axis and its mean absolute deviation,
+    // with a time constant of one period. For a sinus, the mean absolute deviation is 2/pi times the amplitude.
+    const double forward = cos(m_fixed_yaw) * interaction_point_state.position.x 
+                         + sin(m_fixed_yaw) * interaction_point_state.position.y;
+
+    if(m_last_amplitude_stamp.isZero()){
+        m_forward_mean = forward;
+    }
+    else{
+        double dt = (interaction_point_stamp - m_last_amplitude_stamp).toSec();
+        if(dt <= 0.0)
+            return;
+        double alpha = std::min(1.0, dt/m_period);
+        m_forward_mean += alpha * (forward - m_forward_mean);
+        m_forward_deviation += alpha * (std::abs(forward - m_forward_mean) - m_forward_deviation);
+        m_amplitude_estimation_time += dt;
+    }
+    m_last_amplitude_stamp = interaction_point_stamp;
+}
+
+void Mast::saveToHistory(){
+    StateSample sample;
+    sample.time = interaction_point_stamp.toSec();
+    sample.position = interaction_point_state.position.to<geometry_msgs::Point>();
+    sample.velocity = interaction_point_state.velocity.to<geometry_msgs::Vector3>();
+    sample.acceleration = interaction_point_state.acceleration.to<geometry_msgs::Vector3>();
+    m_history.push(sample);
 }
 
 void Mast::search_period(double pitch){
@@ -111,6 +150,39 @@ float Mast::get_period(){
     return m_period;
 }
 
-mavros_msgs::PositionTarget Mast::get_interaction_point_state(){
+float Mast::get_amplitude(){
+    if(m_amplitude_estimation_time < m_period)
+        return -1;
+    return m_forward_deviation * M_PI / 2.0;
+}
+
+const PVAState& Mast::get_interaction_point_state() const{
     return interaction_point_state;
-}
\ No newline at end of file
+}
+
+PVAState Mast::get_interaction_point_state(const ros::Time& time, const double& max_prediction) const{
+    // Constant acceleration model over the age of the state.
+    const double dt = std::min(std::max((time - interaction_point_stamp).toSec(), 0.0), max_prediction);
+    return interaction_point_state.predict(dt);
+}
+
+ros::Time Mast::get_interaction_point_stamp() const{
+    return interaction_point_stamp;
+}
+
+const StateHistory& Mast::get_history() const{
+    return m_history;
+}
+MastEstimate Mast::get_estimate() const{
+    return {m_period, m_last_min_pitch, m_last_max_pitch, m_forward_mean, m_forward_deviation,
+            m_amplitude_estimation_time};
+}
+
+void Mast::restore_estimate(const MastEstimate& estimate){
+    m_period = estimate.period;
+    m_last_min_pitch = estimate.last_min_pitch;
+    m_last_max_pitch = estimate.last_max_pitch;
+    m_forward_mean = estimate.forward_mean;
+    m_forward_deviation = estimate.forward_deviation;
+    m_amplitude_estimation_time = estimate.amplitude_estimation_time;
+}
@@ -10,19 +10,54 @@
 #include <mavros_msgs/CommandTOL.h>
 #include <mavros_msgs/ParamSet.h>
 #include <mavros_msgs/PositionTarget.h>
+#include <mavros_msgs/StreamRate.h>
 
+#include <thread>
+
+#include "fluid.h"
 #include "type_mask.h"
 
-MavrosInterface::MavrosInterface() {
-    ros::NodeHandle node_handle;
+namespace {
+
+/**
+ * @brief Runs @p call on a detached thread. Unlike the future of std::async, the returned future doesn't wait for the
+ *        call when it is destroyed, so the operation holding it can be dropped while ArduPilot hasn't answered.
+ *
+ * @param call The service call, must not refer to the caller.
+ *
+ * @return The result of @p call, available when it has returned.
+ */
+template <class Call>
+std::future<bool> callDetached(Call call) {
+    std::promise<bool> promise;
+    std::future<bool> future = promise.get_future();
+    std::thread([call, promise = std::move(promise)]() mutable { promise.set_value(call()); }).detach();
+    return future;
+}
+
+}  // namespace
+
+MavrosInterface::MavrosInterface(const std::string& name_space, ros::CallbackQueue* callback_queue)
+    : name_space(name_space), callback_queue(callback_queue) {
+    ros::NodeHandle node_handle(name_space);
+    node_handle.setCallbackQueue(callback_queue);
+
     state_subscriber =
         node_handle.subscribe<mavros_msgs::State>("mavros/state", 1, &MavrosInterface::stateCallback, this);
     setpoint_publisher = node_handle.advertise<mavros_msgs::PositionTarget>("mavros/setpoint_raw/local", 10);
 }
 
+MavrosInterface::MavrosInterface(const Fluid& fluid)
+    : MavrosInterface(fluid.getNodeHandle().getNamespace(), fluid.getCallbackQueue()) {}
+
 void MavrosInterface::stateCallback(const mavros_msgs::State::ConstPtr& msg) { current_state = *msg; }
 
-mavros_msgs::State MavrosInterface::getCurrentState() const { return current_state; }
+const mavros_msgs::State& MavrosInterface::getCurrentState() const { return current_state; }
+
+void MavrosInterface::spinFor(ros::Rate& rate) const {
+    callback_queue->callAvailable();
+    rate.sleep();
+}
 
 void MavrosInterface::establishContactToArduPilot() const {
     ros::Rate rate(UPDATE_REFRESH_RATE);
@@ -31,20 +66,30 @@ void MavrosInterface::establishContactToArduPilot() const {
 
     // Run until we achieve a connection with mavros
     while (ros::ok() && !getCurrentState().connected) {
-        ros::spinOnce();
-        rate.sleep();
+        spinFor(rate);
     }
 
     ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": OK!\n");
 }
 
+bool MavrosInterface::requestStreamRate(const unsigned int& rate) const {
+    ros::NodeHandle node_handle(name_space);
+    ros::ServiceClient stream_rate_client = node_handle.serviceClient<mavros_msgs::StreamRate>("mavros/set_stream_rate");
+    mavros_msgs::StreamRate stream_rate;
+    stream_rate.request.stream_id = 0;  // All streams
+    stream_rate.request.message_rate = rate;
+    stream_rate.request.on_off = 1;
+
+    return stream_rate_client.call(stream_rate);
+}
+
 bool MavrosInterface::attemptToSetMode(const std::string& mode) const {
     // The state on the Pixhawk is equal to the state we wan't to set, so we just return
     // What about Ardupilot? -Erlend
     if (getCurrentState().mode == mode) {
         return true;
     } else {
-        ros::NodeHandle node_handle;
+        ros::NodeHandle node_handle(name_space);
         ros::ServiceClient set_mode_client = node_handle.serviceClient<mavros_msgs::SetMode>("mavros/set_mode");
         mavros_msgs::SetMode set_mode;
         set_mode.request.custom_mode = mode;
@@ -65,8 +110,7 @@ void MavrosInterface::requestArm(const bool& auto_arm) const {
     for (int i = UPDATE_REFRESH_RATE * 2; ros::ok() && i > 0; --i) {
         setpoint.header.stamp = ros::Time::now();
         setpoint_publisher.publish(setpoint);
-        ros::spinOnce();
-        rate.sleep();
+        spinFor(rate);
     }
 
     // Arming
@@ -77,7 +121,7 @@ void MavrosInterface::requestArm(const bool& auto_arm) const {
     }
 
     ros::Time last_request = ros::Time::now();
-    ros::NodeHandle node_handle;
+    ros::NodeHandle node_handle(name_space);
     ros::ServiceClient arming_client = node_handle.serviceClient<mavros_msgs::CommandBool>("mavros/cmd/arming");
     mavros_msgs::CommandBool arm_command;
     arm_command.request.value = true;
@@ -105,8 +149,7 @@ void MavrosInterface::requestArm(const bool& auto_arm) const {
         setpoint.header.stamp = ros::Time::now();
         setpoint_publisher.publish(setpoint);
 
-        ros::spinOnce();
-        rate.sleep();
+        spinFor(rate);
     }
 
     ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": OK!");
@@ -136,8 +179,7 @@ void MavrosInterface::requestOffboard(const bool& auto_offboard) const {
         setpoint.header.stamp = ros::Time::now();
         setpoint_publisher.publish(setpoint);
 
-        ros::spinOnce();
-        rate.sleep();
+        spinFor(rate);
     }
 
     ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": OK!\n");
@@ -157,8 +199,7 @@ void MavrosInterface::requestTakeOff(mavros_msgs::PositionTarget setpoint) const
         setpoint.header.stamp = ros::Time::now();
 
         setpoint_publisher.publish(setpoint);
-        ros::spinOnce();
-        rate.sleep();
+        spinFor(rate);
     }
     setpoint.type_mask = TypeMask::POSITION;
 
@@ -166,9 +207,9 @@ void MavrosInterface::requestTakeOff(mavros_msgs::PositionTarget setpoint) const
     ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Attempting to take off!");
 
     ros::Time last_request = ros::Time::now();
-    ros::NodeHandle node_handle;
+    ros::NodeHandle node_handle(name_space);
 
-    ros::ServiceClient takeoff_cl = node_handle.serviceClient<mavros_msgs::CommandTOL>("/mavros/cmd/takeoff");
+    ros::ServiceClient takeoff_cl = node_handle.serviceClient<mavros_msgs::CommandTOL>("mavros/cmd/takeoff");
     mavros_msgs::CommandTOL srv_takeoff;
     srv_takeoff.request.altitude = setpoint.position.z;
     srv_takeoff.request.min_pitch = 0.0;
@@ -176,7 +217,7 @@ void MavrosInterface::requestTakeOff(mavros_msgs::PositionTarget setpoint) const
     srv_takeoff.request.longitude = 0.0;
     srv_takeoff.request.yaw = setpoint.yaw;
     
-    while (!srv_takeoff.response.success){
+    while (ros::ok() && !srv_takeoff.response.success){
         ros::Duration(.1).sleep();
         takeoff_cl.call(srv_takeoff);
     }
@@ -194,8 +235,7 @@ void MavrosInterface::requestTakeOff(mavros_msgs::PositionTarget setpoint) const
             }
             last_request = ros::Time::now();
         }
-        ros::spinOnce();
-        rate.sleep();
+        spinFor(rate);
     }
     setpoint.header.stamp = ros::Time::now();
     setpoint_publisher.publish(setpoint);
@@ -204,7 +244,7 @@ void MavrosInterface::requestTakeOff(mavros_msgs::PositionTarget setpoint) const
 
 void MavrosInterface::setParam(const std::string& parameter, const float& value) const {
     ros::Rate rate(UPDATE_REFRESH_RATE);
-    ros::NodeHandle node_handle;
+    ros::NodeHandle node_handle(name_space);
     ros::ServiceClient param_set_service_client = node_handle.serviceClient<mavros_msgs::ParamSet>("mavros/param/set");
 
     mavros_msgs::ParamSet param_set_service;
@@ -221,7 +261,52 @@ void MavrosInterface::setParam(const std::string& parameter, const float& value)
             failed_setting = true;
         }
 
-        rate.sleep();
-        ros::spinOnce();
+        spinFor(rate);
     }
-}
\ No newline at end of file
+}
+
+std::future<bool> MavrosInterface::requestArmAsync() const {
+    ros::NodeHandle node_handle(name_space);
+    ros::ServiceClient arming_client = node_handle.serviceClient<mavros_msgs::CommandBool>("mavros/cmd/arming");
+
+    return callDetached([arming_client]() mutable {
+        mavros_msgs::CommandBool arm_command;
+        arm_command.request.value = true;
+        return arming_client.call(arm_command) && arm_command.response.success;
+    });
+}
+
+std::future<bool> MavrosInterface::setModeAsync(const std::string& mode) const {
+    ros::NodeHandle node_handle(name_space);
+    ros::ServiceClient set_mode_client = node_handle.serviceClient<mavros_msgs::SetMode>("mavros/set_mode");
+
+    return callDetached([set_mode_client, mode]() mutable {
+        mavros_msgs::SetMode set_mode;
+        set_mode.request.custom_mode = mode;
+        return set_mode_client.call(set_mode) && set_mode.response.mode_sent;
+    });
+}
+
+std::future<bool> MavrosInterface::requestTakeOffAsync(const float& altitude, const float& yaw) const {
+    ros::NodeHandle node_handle(name_space);
+    ros::ServiceClient takeoff_client = node_handle.serviceClient<mavros_msgs::CommandTOL>("mavros/cmd/takeoff");
+
+    return callDetached([takeoff_client, altitude, yaw]() mutable {
+        mavros_msgs::CommandTOL takeoff_command;
+        takeoff_command.request.altitude = altitude;
+        takeoff_command.request.yaw = yaw;
+        return takeoff_client.call(takeoff_command) && takeoff_command.response.success;
+    });
+}
+
+std::future<bool> MavrosInterface::setParamAsync(const std::string& parameter, const float& value) const {
+    ros::NodeHandle node_handle(name_space);
+    ros::ServiceClient param_set_service_client = node_handle.serviceClient<mavros_msgs::ParamSet>("mavros/param/set");
+
+    return callDetached([param_set_service_client, parameter, value]() mutable {
+        mavros_msgs::ParamSet param_set_service;
+        param_set_service.request.param_id = parameter;
+        param_set_service.request.value.real = value;
+        return param_set_service_client.call(param_set_service) && param_set_service.response.success;
+    });
+}
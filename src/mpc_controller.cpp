@@ -0,0 +1,135 @@
+/**
+ * @file mpc_controller.cpp
+ */
+
+#include "mpc_controller.h"
+
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <cmath>
+
+MpcController::MpcController(const double& dt,
+                             const double& max_acc,
+                             const double& position_weight,
+                             const double& velocity_weight,
+                             const double& acceleration_weight,
+                             const double& time_budget,
+                             const int& max_iterations)
+    : dt(dt), max_acc(max_acc), time_budget(time_budget), max_iterations(max_iterations) {
+    Eigen::Matrix2d A;
+    A << 1, dt, 0, 1;
+    Eigen::Vector2d B(0.5 * dt * dt, dt);
+
+    // Build the prediction matrices step by step, x_k = A^k x0 + sum_j A^(k-1-j) B u_j
+    phi.setZero();
+    gamma.setZero();
+    Eigen::Matrix2d A_power = A;
+
+    for (int k = 0; k < HORIZON; k++) {
+        phi.block<2, 2>(2 * k, 0) = A_power;
+        A_power = A * A_power;
+
+        Eigen::Vector2d A_power_B = B;
+        for (int j = k; j >= 0; j--) {
+            gamma.block<2, 1>(2 * k, j) = A_power_B;
+            A_power_B = A * A_power_B;
+        }
+    }
+
+    Eigen::Matrix<double, 2 * HORIZON, 1> Q;
+    for (int k = 0; k < HORIZON; k++) {
+        Q(2 * k) = position_weight;
+        Q(2 * k + 1) = velocity_weight;
+    }
+
+    reference_gain = gamma.transpose() * Q.asDiagonal();
+    initial_state_gain = reference_gain * phi;
+    hessian = reference_gain * gamma;
+    hessian.diagonal().array() += acceleration_weight;
+
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, HORIZON, HORIZON>> eigen_solver(hessian,
+                                                                                        Eigen::EigenvaluesOnly);
+    step = 1.0 / eigen_solver.eigenvalues().maxCoeff();
+
+    reset();
+}
+
+double MpcController::getTimeStep() const { return dt; }
+
+void MpcController::reset() { warm_start.setZero(); }
+
+MpcController::Result MpcController::solve(const geometry_msgs::Point& position,
+                                           const geometry_msgs::Vector3& velocity,
+                                           const Reference& reference,
+                                           const double& elapsed) {
+    const ros::WallTime start = ros::WallTime::now();
+    Result result;
+
+    Eigen::Matrix<double, 2, 3> initial_state;
+    initial_state << position.x, position.y, position.z, velocity.x, velocity.y, velocity.z;
+
+    StateSequence reference_states;
+    for (int k = 0; k < HORIZON; k++) {
+        reference_states.row(2 * k) << reference[k].position.x, reference[k].position.y, reference[k].position.z;
+        reference_states.row(2 * k + 1) << reference[k].velocity.x, reference[k].velocity.y, reference[k].velocity.z;
+    }
+
+    // The gradient of the cost is hessian * U + linear_term
+    const InputSequence linear_term = initial_state_gain * initial_state - reference_gain * reference_states;
+
+    // The solver runs every tick, which is shorter than a step of the horizon, so the previous solution is shifted
+    // by the time elapsed since, interpolating between its steps, and held at its last step.
+    const double shift = std::max(0.0, elapsed / dt);
+    InputSequence U;
+    for (int k = 0; k < HORIZON; k++) {
+        const double warm_start_step = std::min(k + shift, HORIZON - 1.0);
+        const int index = static_cast<int>(warm_start_step);
+        const double fraction = warm_start_step - index;
+        U.row(k) = (1.0 - fraction) * warm_start.row(index) + fraction * warm_start.row(std::min(index + 1, HORIZON - 1));
+    }
+
+    InputSequence Y = U;
+    double t = 1.0;
+    result.converged = false;
+    result.iterations = 0;
+
+    while (result.iterations < max_iterations) {
+        const InputSequence next_U =
+            (Y - step * (hessian * Y + linear_term)).cwiseMax(-max_acc).cwiseMin(max_acc);
+        const double next_t = (1.0 + std::sqrt(1.0 + 4.0 * t * t)) / 2.0;
+        Y = next_U + ((t - 1.0) / next_t) * (next_U - U);
+
+        const double change = (next_U - U).cwiseAbs().maxCoeff();
+        U = next_U;
+        t = next_t;
+        result.iterations++;
+
+        if (change < 1e-4) {
+            result.converged = true;
+            break;
+        }
+
+        // Checking the clock is not free, so only do it every few iterations.
+        if (result.iterations % 4 == 0 && (ros::WallTime::now() - start).toSec() > time_budget) {
+            break;
+        }
+    }
+
+    warm_start = U;
+
+    const StateSequence predicted = phi * initial_state + gamma * U;
+
+    result.position.x = predicted(0, 0);
+    result.position.y = predicted(0, 1);
+    result.position.z = predicted(0, 2);
+    result.velocity.x = predicted(1, 0);
+    result.velocity.y = predicted(1, 1);
+    result.velocity.z = predicted(1, 2);
+    result.acceleration.x = U(0, 0);
+    result.acceleration.y = U(0, 1);
+    result.acceleration.z = U(0, 2);
+    result.compute_time = (ros::WallTime::now() - start).toSec();
+
+    return result;
+}
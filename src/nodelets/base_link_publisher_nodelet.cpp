@@ -0,0 +1,65 @@
+/**
+ * @file base_link_publisher_nodelet.cpp
+ */
+
+#include <nav_msgs/Odometry.h>
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <tf2_ros/transform_broadcaster.h>
+
+#include <memory>
+
+namespace fluid {
+
+/**
+ * @brief The base_link_publisher as a nodelet, so that the odometry from MAVROS is not serialized when they run in
+ *        the same manager.
+ */
+class BaseLinkPublisherNodelet : public nodelet::Nodelet {
+   private:
+    /**
+     * @brief Retrieves the odometry.
+     */
+    ros::Subscriber pose_subscriber;
+
+    /**
+     * @brief Broadcasts the transform, created in #onInit as it needs the node to be initialized.
+     */
+    std::unique_ptr<tf2_ros::TransformBroadcaster> broadcaster_ptr;
+
+    /**
+     * @brief The transform, kept to reuse its allocations.
+     */
+    geometry_msgs::TransformStamped transform_stamped;
+
+    /**
+     * @brief Sets up the broadcaster and the subscriber.
+     */
+    void onInit() override {
+        broadcaster_ptr.reset(new tf2_ros::TransformBroadcaster());
+        transform_stamped.child_frame_id = "base_link";
+
+        pose_subscriber = getNodeHandle().subscribe("/mavros/global_position/local", 10,
+                                                    &BaseLinkPublisherNodelet::poseCallback, this);
+    }
+
+    /**
+     * @brief Broadcasts the pose of @p odometry as the base_link transform.
+     *
+     * @param odometry The odometry from MAVROS.
+     */
+    void poseCallback(const nav_msgs::Odometry::ConstPtr& odometry) {
+        transform_stamped.header.stamp = ros::Time::now();
+        transform_stamped.header.frame_id = odometry->header.frame_id;
+        transform_stamped.transform.translation.x = odometry->pose.pose.position.x;
+        transform_stamped.transform.translation.y = odometry->pose.pose.position.y;
+        transform_stamped.transform.translation.z = odometry->pose.pose.position.z;
+        transform_stamped.transform.rotation = odometry->pose.pose.orientation;
+
+        broadcaster_ptr->sendTransform(transform_stamped);
+    }
+};
+
+}  // namespace fluid
+
+PLUGINLIB_EXPORT_CLASS(fluid::BaseLinkPublisherNodelet, nodelet::Nodelet)
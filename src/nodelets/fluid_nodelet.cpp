@@ -0,0 +1,83 @@
+/**
+ * @file fluid_nodelet.cpp
+ */
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <ros/callback_queue.h>
+
+#include <memory>
+#include <thread>
+
+#include "configuration_loader.h"
+#include "deferred_log.h"
+#include "fluid.h"
+#include "startup_timeline.h"
+
+namespace fluid {
+
+/**
+ * @brief Runs Fluid within a nodelet manager. When MAVROS, the EKF and perception are loaded into the same manager,
+ *        their messages are handed over as shared pointers instead of being serialized and sent over TCP.
+ *
+ *        The main loop of Fluid blocks, so it runs on its own thread and spins its own queue instead of the
+ *        manager's. Every nodelet runs its own instance in the namespace it is loaded in, so one manager can run
+ *        the nodelets of several vehicles.
+ */
+class FluidNodelet : public nodelet::Nodelet {
+   private:
+    /**
+     * @brief The queue spun by the main loop of Fluid.
+     */
+    ros::CallbackQueue callback_queue;
+
+    /**
+     * @brief The instance of Fluid of this nodelet.
+     */
+    std::unique_ptr<Fluid> fluid_ptr;
+
+    /**
+     * @brief Runs the main loop of Fluid.
+     */
+    std::thread run_thread;
+
+    /**
+     * @brief Loads the configuration from the private namespace of the nodelet and starts Fluid.
+     */
+    void onInit() override {
+        std::shared_ptr<StartupTimeline> startup_timeline_ptr = std::make_shared<StartupTimeline>();
+
+        NODELET_INFO_STREAM(getName() << ": Starting up.");
+
+        std::shared_ptr<FluidConfiguration> configuration_ptr =
+            loadFluidConfiguration(getPrivateNodeHandle().getNamespace());
+
+        // Shutting down ROS would take down the whole manager, so Fluid is just not started.
+        if (!configuration_ptr) {
+            return;
+        }
+
+        startup_timeline_ptr->mark("parameters");
+
+        fluid_ptr.reset(
+            new Fluid(*configuration_ptr, getNodeHandle().getNamespace(), &callback_queue, startup_timeline_ptr));
+
+        run_thread = std::thread([this]() { fluid_ptr->run(); });
+    }
+
+   public:
+    /**
+     * @brief Stops the main loop, outputs what it logged and tears down Fluid when the nodelet is unloaded.
+     */
+    ~FluidNodelet() {
+        if (run_thread.joinable()) {
+            fluid_ptr->stop();
+            run_thread.join();
+            DeferredLog::getInstance().flush();
+        }
+    }
+};
+
+}  // namespace fluid
+
+PLUGINLIB_EXPORT_CLASS(fluid::FluidNodelet, nodelet::Nodelet)
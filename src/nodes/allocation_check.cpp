@@ -0,0 +1,267 @@
+/**
+ * @file allocation_check.cpp
+ *
+ * @brief Ticks every operation for a while and fails if any tick allocated after the warm up. Only built with the
+ *        FLUID_TRACK_ALLOCATIONS option.
+ *
+ *        The node feeds the operations a synthetic vehicle itself: a connected and armed ArduPilot in guided hovering
+ *        at 2 m, a static mast module and a trajectory, and answers the MAVROS services with success. The input is
+ *        published before every step, so it is on the callback queue of Fluid when the step spins it, and every
+ *        operation gets past its waits, e.g. the take off reaches its climb and the interact its approach. A roscore
+ *        has to be running, and nothing else may publish on these topics meanwhile. The configuration is read from
+ *        the private namespace like for the fluid node.
+ */
+
+#include <geometry_msgs/PoseWithCovarianceStamped.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <mavros_msgs/CommandBool.h>
+#include <mavros_msgs/CommandTOL.h>
+#include <mavros_msgs/ExtendedState.h>
+#include <mavros_msgs/ParamSet.h>
+#include <mavros_msgs/PositionTarget.h>
+#include <mavros_msgs/SetMode.h>
+#include <mavros_msgs/State.h>
+#include <nav_msgs/Odometry.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <trajectory_msgs/MultiDOFJointTrajectory.h>
+
+#include <memory>
+#include <vector>
+
+#include "allocation_tracker.h"
+#include "configuration_loader.h"
+#include "deferred_log.h"
+#include "explore_operation.h"
+#include "fluid.h"
+#include "follow_trajectory_operation.h"
+#include "hold_operation.h"
+#include "interact_operation.h"
+#include "land_operation.h"
+#include "operation_identifier.h"
+#include "take_off_operation.h"
+#include "travel_operation.h"
+
+#define TICK_COUNT 200              // Ticks run per operation, the warm up of Operation::step and the take off included
+#define HOVER_HEIGHT 2.0            // Height of the synthetic vehicle [m]
+#define MODULE_DISTANCE 3.0         // Distance along x from the vehicle to the synthetic module [m]
+#define TRAJECTORY_PERIOD 1.0       // Time between two trajectory chunks [s]
+#define TRAJECTORY_HORIZON 2.0      // Time covered by a trajectory chunk, overlaps the next chunk [s]
+#define TRAJECTORY_POINT_COUNT 21   // Points of a trajectory chunk
+
+/**
+ * @brief Publishes the input of the operations and answers the MAVROS services, as a vehicle hovering in guided would.
+ */
+class SyntheticInput {
+   private:
+    ros::NodeHandle node_handle;
+
+    ros::Publisher odometry_publisher, twist_publisher, state_publisher, extended_state_publisher;
+    ros::Publisher module_pose_publisher, ekf_module_state_publisher, trajectory_publisher;
+
+    /**
+     * @brief The services are answered on their own thread, the requests of the operations block a detached thread
+     *        until they are answered.
+     */
+    ros::CallbackQueue service_callback_queue;
+    ros::AsyncSpinner service_spinner;
+    ros::ServiceServer set_mode_server, arming_server, take_off_server, param_set_server;
+
+    ros::Time last_trajectory_time;
+
+    bool setMode(mavros_msgs::SetMode::Request&, mavros_msgs::SetMode::Response& response) {
+        response.mode_sent = true;
+        return true;
+    }
+
+    bool arm(mavros_msgs::CommandBool::Request&, mavros_msgs::CommandBool::Response& response) {
+        response.success = true;
+        return true;
+    }
+
+    bool takeOff(mavros_msgs::CommandTOL::Request&, mavros_msgs::CommandTOL::Response& response) {
+        response.success = true;
+        return true;
+    }
+
+    bool setParam(mavros_msgs::ParamSet::Request&, mavros_msgs::ParamSet::Response& response) {
+        response.success = true;
+        return true;
+    }
+
+    /**
+     * @brief Publishes a chunk of a straight trajectory through the hover point, starting at @p now.
+     */
+    void publishTrajectory(const ros::Time& now) {
+        trajectory_msgs::MultiDOFJointTrajectory trajectory;
+        trajectory.header.stamp = now;
+        trajectory.points.resize(TRAJECTORY_POINT_COUNT);
+
+        for (size_t i = 0; i < trajectory.points.size(); i++) {
+            const double time = TRAJECTORY_HORIZON * i / (trajectory.points.size() - 1);
+            trajectory.points[i].time_from_start = ros::Duration(time);
+            trajectory.points[i].transforms.resize(1);
+            trajectory.points[i].transforms[0].translation.x = 0.1 * time;
+            trajectory.points[i].transforms[0].translation.z = HOVER_HEIGHT;
+            trajectory.points[i].transforms[0].rotation.w = 1.0;
+            trajectory.points[i].velocities.resize(1);
+            trajectory.points[i].velocities[0].linear.x = 0.1;
+        }
+
+        trajectory_publisher.publish(trajectory);
+        last_trajectory_time = now;
+    }
+
+   public:
+    SyntheticInput() : service_spinner(1, &service_callback_queue) {
+        odometry_publisher = node_handle.advertise<nav_msgs::Odometry>("mavros/global_position/local", 1);
+        twist_publisher = node_handle.advertise<geometry_msgs::TwistStamped>("mavros/local_position/velocity_local", 1);
+        state_publisher = node_handle.advertise<mavros_msgs::State>("mavros/state", 1);
+        extended_state_publisher = node_handle.advertise<mavros_msgs::ExtendedState>("mavros/extended_state", 1);
+        module_pose_publisher = node_handle.advertise<geometry_msgs::PoseWithCovarianceStamped>(
+            "/simulator/module/ground_truth/pose", 1);
+        ekf_module_state_publisher = node_handle.advertise<mavros_msgs::PositionTarget>("/ekf/module/state", 1);
+        trajectory_publisher = node_handle.advertise<trajectory_msgs::MultiDOFJointTrajectory>("fluid/trajectory", 1);
+
+        ros::NodeHandle service_node_handle;
+        service_node_handle.setCallbackQueue(&service_callback_queue);
+        set_mode_server = service_node_handle.advertiseService("mavros/set_mode", &SyntheticInput::setMode, this);
+        arming_server = service_node_handle.advertiseService("mavros/cmd/arming", &SyntheticInput::arm, this);
+        take_off_server = service_node_handle.advertiseService("mavros/cmd/takeoff", &SyntheticInput::takeOff, this);
+        param_set_server = service_node_handle.advertiseService("mavros/param/set", &SyntheticInput::setParam, this);
+        service_spinner.start();
+    }
+
+    ~SyntheticInput() { service_spinner.stop(); }
+
+    /**
+     * @brief Publishes the current input, called before every step.
+     */
+    void publish() {
+        const ros::Time now = ros::Time::now();
+
+        nav_msgs::Odometry odometry;
+        odometry.header.stamp = now;
+        odometry.header.frame_id = "map";
+        odometry.pose.pose.position.z = HOVER_HEIGHT;
+        odometry.pose.pose.orientation.w = 1.0;
+        odometry_publisher.publish(odometry);
+
+        geometry_msgs::TwistStamped twist;
+        twist.header.stamp = now;
+        twist.header.frame_id = "map";
+        twist_publisher.publish(twist);
+
+        mavros_msgs::State state;
+        state.header.stamp = now;
+        state.connected = true;
+        state.armed = true;
+        state.guided = true;
+        state.mode = ARDUPILOT_MODE_GUIDED;
+        state_publisher.publish(state);
+
+        mavros_msgs::ExtendedState extended_state;
+        extended_state.header.stamp = now;
+        extended_state.landed_state = mavros_msgs::ExtendedState::LANDED_STATE_IN_AIR;
+        extended_state_publisher.publish(extended_state);
+
+        // The interact reads the module from the simulator or from the EKF depending on the configuration.
+        geometry_msgs::PoseWithCovarianceStamped module_pose;
+        module_pose.header.stamp = now;
+        module_pose.header.frame_id = "map";
+        module_pose.pose.pose.position.x = MODULE_DISTANCE;
+        module_pose.pose.pose.position.z = HOVER_HEIGHT;
+        module_pose.pose.pose.orientation.w = 1.0;
+        module_pose_publisher.publish(module_pose);
+
+        mavros_msgs::PositionTarget module_state;
+        module_state.header.stamp = now;
+        module_state.header.frame_id = "map";
+        module_state.position = module_pose.pose.pose.position;
+        ekf_module_state_publisher.publish(module_state);
+
+        if ((now - last_trajectory_time).toSec() >= TRAJECTORY_PERIOD) {
+            publishTrajectory(now);
+        }
+    }
+};
+
+/**
+ * @return A short square path at @p height.
+ */
+std::vector<geometry_msgs::Point> createPath(const double& height) {
+    std::vector<geometry_msgs::Point> path(4);
+
+    for (size_t i = 0; i < path.size(); i++) {
+        path[i].x = (i == 1 || i == 2) ? 2.0 : 0.0;
+        path[i].y = (i >= 2) ? 2.0 : 0.0;
+        path[i].z = height;
+    }
+
+    return path;
+}
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "fluid_allocation_check");
+
+    if (!AllocationTracker::isEnabled()) {
+        ROS_FATAL_STREAM(ros::this_node::getName().c_str() << ": Built without FLUID_TRACK_ALLOCATIONS.");
+        return 1;
+    }
+
+    std::shared_ptr<FluidConfiguration> configuration_ptr = loadFluidConfiguration(ros::this_node::getName());
+
+    if (!configuration_ptr) {
+        ros::shutdown();
+        return 1;
+    }
+
+    Fluid fluid(*configuration_ptr, "", nullptr, nullptr);
+    SyntheticInput synthetic_input;
+
+    const std::vector<geometry_msgs::Point> path = createPath(2.0);
+    geometry_msgs::Point point_of_interest;
+    point_of_interest.x = 1.0;
+    point_of_interest.y = 1.0;
+
+    const std::vector<std::shared_ptr<Operation>> operations{
+        std::make_shared<TakeOffOperation>(fluid, 2.0),
+        std::make_shared<TravelOperation>(fluid, path),
+        std::make_shared<ExploreOperation>(fluid, path, point_of_interest),
+        std::make_shared<InteractOperation>(fluid, 0.0),
+        std::make_shared<FollowTrajectoryOperation>(fluid),
+        std::make_shared<HoldOperation>(fluid),
+        std::make_shared<LandOperation>(fluid)};
+
+    unsigned int allocating_operation_count = 0;
+
+    for (const std::shared_ptr<Operation>& operation_ptr : operations) {
+        operation_ptr->begin();
+
+        for (int i = 0; i < TICK_COUNT && ros::ok(); i++) {
+            synthetic_input.publish();
+            operation_ptr->step(true);
+            operation_ptr->getPeriod().sleep();
+        }
+
+        operation_ptr->end();
+
+        if (operation_ptr->getAllocatingTickCount() > 0) {
+            allocating_operation_count++;
+        }
+    }
+
+    if (allocating_operation_count > 0) {
+        ROS_ERROR_STREAM(ros::this_node::getName().c_str()
+                         << ": " << allocating_operation_count << " of " << operations.size()
+                         << " operations allocated within their ticks.");
+    } else {
+        ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": No tick allocated after the warm up.");
+    }
+
+    DeferredLog::getInstance().flush();
+
+    // Stops the link thread of Fluid, which is joined when it is destroyed.
+    ros::shutdown();
+    return allocating_operation_count > 0 ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file fleet.cpp
+ *
+ * @brief Runs one instance of Fluid per vehicle within a single process, all stepped by one shared pool of threads.
+ *
+ *        The vehicles are listed in the ~vehicles parameter as namespaces, e.g. [uav1, uav2]. Each vehicle talks to
+ *        the MAVROS in its namespace, advertises its services there, and reads its configuration from
+ *        <vehicle>/fluid, the namespace base.launch sets the parameters in. ~threads sets the size of the pool.
+ *
+ *        The processor time and the resident memory of the process are logged periodically. With
+ *        ~measure_vehicle_cost set, the vehicles are started one per report period instead of all at once, and every
+ *        report gives the processor use and the memory added by the vehicle which started last, measured while it
+ *        runs rather than when it is set up.
+ */
+
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "configuration_loader.h"
+#include "deferred_log.h"
+#include "fluid.h"
+#include "fluid_executor.h"
+
+#define REPORT_PERIOD 10.0  // Time between two reports of the processor time used [s]
+
+/**
+ * @return The resident memory of the process [MB].
+ */
+double getResidentMemory() {
+    std::ifstream statm("/proc/self/statm");
+    long size = 0, resident = 0;
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE) / 1e6;
+}
+
+/**
+ * @return The processor time used by all the threads of the process so far [s].
+ */
+double getProcessorTime() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 + usage.ru_stime.tv_sec +
+           usage.ru_stime.tv_usec * 1e-6;
+}
+
+int main(int argc, char** argv) {
+    ros::init(argc, argv, "fluid_fleet");
+    ros::NodeHandle node_handle, private_node_handle("~");
+
+    std::vector<std::string> vehicles;
+    if (!private_node_handle.getParam("vehicles", vehicles) || vehicles.empty()) {
+        ROS_FATAL_STREAM(ros::this_node::getName().c_str() << ": No vehicles given in ~vehicles.");
+        return 1;
+    }
+
+    const int default_thread_count =
+        std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), static_cast<int>(vehicles.size())));
+    const int thread_count = private_node_handle.param("threads", default_thread_count);
+
+    // Every vehicle spins its own queue within its steps, so its callbacks never run on the thread stepping another
+    // vehicle. The queues are declared before the executor, so they outlive the instances it holds.
+    std::vector<std::unique_ptr<ros::CallbackQueue>> callback_queues;
+    std::unique_ptr<FluidExecutor> executor_ptr(new FluidExecutor(thread_count));
+
+    // All the configurations are loaded before the first vehicle starts, so a wrong one stops the fleet right away.
+    std::vector<std::string> name_spaces;
+    std::vector<std::shared_ptr<FluidConfiguration>> configuration_ptrs;
+
+    for (const std::string& vehicle : vehicles) {
+        const std::string name_space = ros::names::resolve(vehicle);
+        std::shared_ptr<FluidConfiguration> configuration_ptr = loadFluidConfiguration(name_space + "/fluid");
+
+        if (!configuration_ptr) {
+            ros::shutdown();
+            return 1;
+        }
+
+        // The executor steps the vehicles on their schedule, the latency is still measured on the trigger topic.
+        if (configuration_ptr->tick_on_trigger) {
+            ROS_WARN_STREAM(ros::this_node::getName().c_str()
+                            << ": " << name_space.c_str() << " asks for tick_on_trigger, which the fleet doesn't "
+                            << "support, ticking at the rate of the operations.");
+        }
+
+        name_spaces.push_back(name_space);
+        configuration_ptrs.push_back(configuration_ptr);
+    }
+
+    size_t started_count = 0;
+
+    auto startNextVehicle = [&]() {
+        callback_queues.emplace_back(new ros::CallbackQueue());
+        executor_ptr->add(std::make_shared<Fluid>(*configuration_ptrs[started_count], name_spaces[started_count],
+                                                  callback_queues.back().get()));
+        started_count++;
+    };
+
+    const bool should_measure_vehicle_cost = private_node_handle.param("measure_vehicle_cost", false);
+
+    if (!should_measure_vehicle_cost) {
+        while (started_count < name_spaces.size()) {
+            startNextVehicle();
+        }
+    }
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                    << ": Running " << vehicles.size() << " vehicles on " << thread_count << " threads"
+                    << (should_measure_vehicle_cost ? ", starting them one at a time." : "."));
+
+    ros::WallTime last_report_time = ros::WallTime::now();
+    double last_processor_time = getProcessorTime();
+    double last_load = 0, last_memory = getResidentMemory();
+    bool has_baseline = false;
+
+    ros::WallTimer report_timer =
+        node_handle.createWallTimer(ros::WallDuration(REPORT_PERIOD), [&](const ros::WallTimerEvent&) {
+            const double load = (getProcessorTime() - last_processor_time) /
+                                (ros::WallTime::now() - last_report_time).toSec();
+            const double memory = getResidentMemory();
+
+            if (!should_measure_vehicle_cost) {
+                ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                                << ": Processor use " << 100 * load << " % of a core, resident memory " << memory
+                                << " MB.");
+            } else if (!has_baseline) {
+                ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                                << ": Without vehicles, processor use " << 100 * load
+                                << " % of a core, resident memory " << memory << " MB.");
+                has_baseline = true;
+            } else if (started_count > 0) {
+                ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                                << ": With " << started_count << " vehicles, processor use " << 100 * load
+                                << " % of a core (+" << 100 * (load - last_load) << " % for "
+                                << name_spaces[started_count - 1].c_str() << "), resident memory " << memory
+                                << " MB (+" << memory - last_memory << " MB).");
+            }
+
+            last_load = load;
+            last_memory = memory;
+
+            // The next vehicle starts once the previous one has run for a whole period.
+            if (should_measure_vehicle_cost && started_count < name_spaces.size()) {
+                startNextVehicle();
+            }
+
+            // Measured from here, so that the setup of a vehicle doesn't count as the cost of running it.
+            last_report_time = ros::WallTime::now();
+            last_processor_time = getProcessorTime();
+        });
+
+    // The global queue only has the report timer, the vehicles are stepped by the executor.
+    ros::spin();
+
+    // Nothing is logged from the control loops once the executor has joined its threads.
+    executor_ptr.reset();
+    DeferredLog::getInstance().flush();
+
+    return 0;
+}
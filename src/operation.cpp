@@ -9,53 +9,59 @@
 #include <tf2/LinearMath/Quaternion.h>
 #include <nav_msgs/Odometry.h>
 
+#include "allocation_tracker.h"
 #include "fluid.h"
 #include "util.h"
 
-Operation::Operation(const OperationIdentifier& identifier, const bool& steady, const bool& autoPublish)
-                                        : identifier(identifier), steady(steady), autoPublish(autoPublish){
-    pose_subscriber = node_handle.subscribe("mavros/global_position/local", 1, &Operation::poseCallback, this);
-    twist_subscriber =
-        node_handle.subscribe("mavros/local_position/velocity_local", 1, &Operation::twistCallback, this);
-
+#define HANDOVER_TIME_CONSTANT 1.0  // Time constant of the decay of the handover velocity [s]
+#define ALLOCATION_WARMUP_TICKS 10  // Ticks allowed to allocate before the allocation tracking reports them
+
+Operation::Operation(Fluid& fluid, const OperationIdentifier& identifier, const bool& steady,
+                     const bool& autoPublish, const int& nominal_rate, const int& max_rate)
+                                        : steady(steady), autoPublish(autoPublish), fluid(fluid),
+                                          nominal_rate(nominal_rate > 0 ? nominal_rate : fluid.configuration.refresh_rate),
+                                          max_rate(std::max(max_rate, this->nominal_rate)),
+                                          node_handle(fluid.getNodeHandle()), identifier(identifier) {
+    // Subclasses subscribe through the same node handle, so all the callbacks of the operation end up on the
+    // queue Fluid spins.
     setpoint_publisher = node_handle.advertise<mavros_msgs::PositionTarget>("mavros/setpoint_raw/local", 10);
     setpoint.coordinate_frame = mavros_msgs::PositionTarget::FRAME_LOCAL_NED;
-    rate_int = (int) Fluid::getInstance().configuration.refresh_rate;
+    rate_int = this->nominal_rate;
+    tick_dt = 1.0 / rate_int;
 }
 
+int Operation::getDesiredRate() const { return nominal_rate; }
 
-geometry_msgs::PoseStamped Operation::getCurrentPose() const { return current_pose; }
-
-void Operation::poseCallback(const nav_msgs::Odometry::ConstPtr pose) {
-    current_pose.pose = pose->pose.pose;
-    current_pose.header = pose->header;
-    current_accel = orientation_to_acceleration(pose->pose.pose.orientation);
+OperationProgress Operation::getProgress() const {
+    OperationProgress progress;
+    progress.state = getStringFromOperationIdentifier(identifier);
+    return progress;
 }
 
-geometry_msgs::TwistStamped Operation::getCurrentTwist() const { return current_twist; }
+std::string Operation::getArdupilotMode() const { return getArdupilotModeForOperationIdentifier(identifier); }
 
+const geometry_msgs::PoseStamped& Operation::getCurrentPose() const {
+    return fluid.getStateHubPtr()->getPose();
+}
 
-void Operation::twistCallback(const geometry_msgs::TwistStampedConstPtr twist) {
-    current_twist.twist = twist->twist;
-    current_twist.header = twist->header;
+const geometry_msgs::TwistStamped& Operation::getCurrentTwist() const {
+    return fluid.getStateHubPtr()->getTwist();
 }
 
-geometry_msgs::Vector3 Operation::getCurrentAccel() const { return current_accel; }
+geometry_msgs::Vector3 Operation::getCurrentAccel() const { return fluid.getStateHubPtr()->getAccel(); }
 
-geometry_msgs::Vector3 Operation::orientation_to_acceleration(geometry_msgs::Quaternion orientation)
-{
-    geometry_msgs::Vector3 accel;
-    geometry_msgs::Vector3 angle = Util::quaternion_to_euler_angle(orientation);
-    accel.x = tan(angle.y) *9.81;
-    accel.y = -tan(angle.x) *9.81;
-    accel.z = 0.0; //we actually don't know ...
-    return accel;
+geometry_msgs::Vector3 Operation::getHandoverVelocity() const {
+    const double decay = std::exp(-(ros::Time::now() - start_time).toSec() / HANDOVER_TIME_CONSTANT);
+
+    geometry_msgs::Vector3 velocity;
+    velocity.x = handover_velocity.x * decay;
+    velocity.y = handover_velocity.y * decay;
+    velocity.z = handover_velocity.z * decay;
+    return velocity;
 }
 
 float Operation::getCurrentYaw() const {
-    geometry_msgs::Quaternion quaternion = current_pose.pose.orientation;
-    geometry_msgs::Vector3 euler = Util::quaternion_to_euler_angle(quaternion);
-    return euler.z;
+    return Util::quaternion_to_euler_angle(getCurrentPose().pose.orientation).z;
 }
 
 void Operation::publishSetpoint() { 
@@ -64,20 +70,68 @@ void Operation::publishSetpoint() {
     setpoint_publisher.publish(setpoint); 
 }
 
-void Operation::perform(std::function<bool(void)> should_tick, bool should_halt_if_steady) {
+void Operation::fail(const std::string& reason) { failure_reason = reason; }
 
-    ros::Rate rate(rate_int);
+void Operation::begin() {
+    rate_int = nominal_rate;
+    start_time = ros::Time::now();
+    last_tick_time = ros::Time();
+    tick_count = 0;
+    allocating_tick_count = 0;
+    failure_reason.clear();
     initialize();
+}
+
+bool Operation::step(const bool& should_halt_if_steady) {
+    const ros::Time now = ros::Time::now();
+    // Limit the step so a stalled loop doesn't make the integrators jump.
+    tick_dt = last_tick_time.isZero() ? 1.0 / rate_int : std::min((now - last_tick_time).toSec(), 5.0 / rate_int);
+    last_tick_time = now;
+
+    // Spun right before the tick rather than after it, so an input which arrived while waiting is used now instead of
+    // one step later.
+    fluid.spinOnce();
+
+    const uint64_t allocations_before_tick = AllocationTracker::getCount();
+    tick();
+    tick_count++;
+
+    // Only the tick of the operation itself is checked, publishing and spinning allocate inside roscpp.
+    const uint64_t allocations = AllocationTracker::getCount() - allocations_before_tick;
+    if (allocations > 0 && tick_count > ALLOCATION_WARMUP_TICKS) {
+        allocating_tick_count++;
+        ROS_ERROR_STREAM_THROTTLE(1, ros::this_node::getName().c_str()
+                                         << ": Tick " << tick_count << " of "
+                                         << getStringFromOperationIdentifier(identifier) << " allocated "
+                                         << allocations << " times.");
+    }
+
+    if (autoPublish)
+        publishSetpoint();
+    fluid.getStatusPublisherPtr()->status.setpoint.x = setpoint.position.x;
+    fluid.getStatusPublisherPtr()->status.setpoint.y = setpoint.position.y;
+    fluid.getStatusPublisherPtr()->status.setpoint.z = setpoint.position.z;
+    fluid.getStatusPublisherPtr()->publish();
+    fluid.getLatencyMonitorPtr()->publish();
+    fluid.publishActionFeedback(*this);
+
+    rate_int = std::min(std::max(getDesiredRate(), 1), max_rate);
+
+    if (!failure_reason.empty()) {
+        return false;
+    }
+
+    return (should_halt_if_steady && steady) || !hasFinishedExecution();
+}
+
+void Operation::end() {
+    if (AllocationTracker::isEnabled()) {
+        ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                        << ": " << getStringFromOperationIdentifier(identifier) << " allocated in "
+                        << allocating_tick_count << " of " << tick_count << " ticks after the warm up.");
+    }
+}
+
+ros::Duration Operation::getPeriod() const { return ros::Duration(1.0 / rate_int); }
 
-    do {
-        tick();
-        if (autoPublish)
-            publishSetpoint();
-        Fluid::getInstance().getStatusPublisherPtr()->status.setpoint.x = setpoint.position.x;
-        Fluid::getInstance().getStatusPublisherPtr()->status.setpoint.y = setpoint.position.y;
-        Fluid::getInstance().getStatusPublisherPtr()->status.setpoint.z = setpoint.position.z;
-        Fluid::getInstance().getStatusPublisherPtr()->publish();
-        ros::spinOnce();
-        rate.sleep();
-    } while (ros::ok() && ((should_halt_if_steady && steady) || !hasFinishedExecution()) && should_tick());
-}
\ No newline at end of file
+unsigned int Operation::getAllocatingTickCount() const { return allocating_tick_count; }
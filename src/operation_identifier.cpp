@@ -25,6 +25,8 @@ std::string getStringFromOperationIdentifier(const OperationIdentifier& operatio
             return "LAND";
         case OperationIdentifier::INTERACT:
             return "INTERACT";
+        case OperationIdentifier::FOLLOW_TRAJECTORY:
+            return "FOLLOW_TRAJECTORY";
         case OperationIdentifier::UNDEFINED:
             return "UNDEFINED";
     }
@@ -3,15 +3,16 @@
  */
 
 #include "explore_operation.h"
-#include "mavros_interface.h"
 
-#include <limits>
 #include <std_srvs/Trigger.h>
 
+#include "fluid.h"
 #include "util.h"
 
-ExploreOperation::ExploreOperation(const std::vector<geometry_msgs::Point>& path, const geometry_msgs::Point& point_of_interest)
-    : MoveOperation(OperationIdentifier::EXPLORE, path, 1, 0.5, 1, 15),
+ExploreOperation::ExploreOperation(Fluid& fluid,
+                                   const std::vector<geometry_msgs::Point>& path,
+                                   const geometry_msgs::Point& point_of_interest)
+    : MoveOperation(fluid, OperationIdentifier::EXPLORE, path, 1, 0.5, 1, 15),
       obstacle_avoidance_path_publisher(node_handle.advertise<ascend_msgs::Path>("/obstacle_avoidance/path", 10)),
       obstacle_avoidance_path_subscriber(
           node_handle.subscribe("/obstacle_avoidance/corrected_path", 10, &ExploreOperation::pathCallback, this)),
@@ -25,9 +26,8 @@ void ExploreOperation::initialize() {
 
     MoveOperation::initialize();
 
-    MavrosInterface mavros_interface;
-    mavros_interface.setParam("WPNAV_ACCEL", 50);
-    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Sat max acceleration to: " << 50/100.0 << " m/s2.");
+    fluid.setParam("WPNAV_ACCEL", 50);
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Setting max acceleration to: " << 50/100.0 << " m/s2.");
 
     ros::ServiceClient fh_extend = node_handle.serviceClient<std_srvs::Trigger>("/facehugger/moveforward");
     std_srvs::Trigger fh_extend_handle;
@@ -37,54 +37,33 @@ void ExploreOperation::initialize() {
     original_path = path;
     original_path_set = true;
 
-    dense_path.clear();
+    dense_path.points.clear();
 
     if (original_path.size() == 1) {
-        dense_path.insert(dense_path.begin(), getCurrentPose().pose.position);
-    }
-
-    for (int i = 1; i < original_path.size(); i++) {
-        std::vector<geometry_msgs::Point> filler_points =
-            Util::createPath(original_path[i - 1], original_path[i], path_density);
-        dense_path.insert(dense_path.end(), begin(filler_points), end(filler_points));
+        dense_path.points.push_back(getCurrentPose().pose.position);
+    } else {
+        PackedPath dense_packed_path;
+        PackedPath(original_path).densify(path_density, dense_packed_path);
+        dense_packed_path.toMessage(dense_path);
     }
 }
 
-void ExploreOperation::pathCallback(ascend_msgs::Path corrected_path) {
+void ExploreOperation::pathCallback(const ascend_msgs::Path::ConstPtr& corrected_path) {
     if (original_path_set) {
         // Check if the path is different from the current path
-
-        bool different_path = path.size() != corrected_path.points.size();
-        unsigned int closest_point_index = -1;
-
-        // Find the point we are closest to in the path given from OA and set that as starting point for the
-        // iterator if the paths are different
-        if (path.size() == corrected_path.points.size()) {
-            for (int i = 0; i < path.size(); i++) {
-                double distance = Util::distanceBetween(path[i], corrected_path.points[i]);
-
-                if (distance >= 0.01) {
-                    different_path = true;
-                    break;
-                }
-            }
-        }
-
-        if (different_path) {
-            double closest_distance = std::numeric_limits<double>::max();
-
-            for (int i = 0; i < corrected_path.points.size(); i++) {
-                double distance = Util::distanceBetween(getCurrentPose().pose.position, corrected_path.points[i]);
-
-                if (distance <= closest_distance) {
-                    closest_distance = distance;
-                    closest_point_index = i;
-                }
-            }
-
-            if (closest_point_index != -1) {
-                path = std::vector<geometry_msgs::Point>(corrected_path.points.begin() + closest_point_index,
-                                                         corrected_path.points.end());
+        packed_path.assign(path);
+        packed_corrected_path.assign(*corrected_path);
+
+        if (!packed_path.isEqual(packed_corrected_path, 0.01)) {
+            // Find the point we are closest to in the path given from OA and set that as starting point for the
+            // iterator
+            const size_t closest_point_index = packed_corrected_path.nearest(getCurrentPose().pose.position);
+
+            if (closest_point_index < packed_corrected_path.size()) {
+                path = std::vector<geometry_msgs::Point>(corrected_path->points.begin() + closest_point_index,
+                                                         corrected_path->points.end());
+                original_indices.clear();
+                is_path_saved = false;
                 current_setpoint_iterator = path.begin();
                 update_setpoint = true;
 
@@ -105,7 +84,10 @@ void ExploreOperation::tick() {
     double dy = point_of_interest.y - getCurrentPose().pose.position.y;
     setpoint.yaw = std::atan2(dy, dx);
    
-    ascend_msgs::Path path_msg;
-    path_msg.points = dense_path;
-    obstacle_avoidance_path_publisher.publish(path_msg);
+    obstacle_avoidance_path_publisher.publish(dense_path);
+}
+
+void ExploreOperation::saveCheckpoint(CheckpointState& state) {
+    MoveOperation::saveCheckpoint(state);
+    state.point_of_interest = Vec3::from(point_of_interest);
 }
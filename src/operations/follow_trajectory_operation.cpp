@@ -0,0 +1,106 @@
+/**
+ * @file follow_trajectory_operation.cpp
+ */
+
+#include "follow_trajectory_operation.h"
+
+#include "deferred_log.h"
+#include "fluid.h"
+#include "util.h"
+
+FollowTrajectoryOperation::FollowTrajectoryOperation(Fluid& fluid)
+    : Operation(fluid,
+                OperationIdentifier::FOLLOW_TRAJECTORY,
+                false,
+                true,
+                fluid.configuration.trajectory_refresh_rate) {}
+
+FollowTrajectoryOperation::~FollowTrajectoryOperation() {
+    trajectory_subscriber.shutdown();
+
+    if (trajectory_spinner) {
+        trajectory_spinner->stop();
+    }
+}
+
+bool FollowTrajectoryOperation::hasFinishedExecution() const { return past_grace_period; }
+
+void FollowTrajectoryOperation::initialize() {
+    setpoint.position = getCurrentPose().pose.position;
+    setpoint.yaw = getCurrentYaw();
+    setpoint.type_mask = TypeMask::POSITION;
+
+    ros::NodeHandle trajectory_node_handle(node_handle.getNamespace());
+    trajectory_node_handle.setCallbackQueue(&trajectory_callback_queue);
+    trajectory_subscriber = trajectory_node_handle.subscribe("fluid/trajectory", 10,
+                                                             &FollowTrajectoryOperation::trajectoryCallback, this);
+
+    // One thread, the buffer has a single producer.
+    trajectory_spinner.reset(new ros::AsyncSpinner(1, &trajectory_callback_queue));
+    trajectory_spinner->start();
+}
+
+void FollowTrajectoryOperation::trajectoryCallback(
+    const trajectory_msgs::MultiDOFJointTrajectory::ConstPtr& trajectory) {
+    // Chunks without a stamp start when they are received.
+    const double chunk_stamp =
+        trajectory->header.stamp.isZero() ? ros::Time::now().toSec() : trajectory->header.stamp.toSec();
+
+    for (const auto& point : trajectory->points) {
+        if (point.transforms.empty()) {
+            continue;
+        }
+
+        TrajectorySample sample;
+        sample.time = chunk_stamp + point.time_from_start.toSec();
+        sample.chunk_stamp = chunk_stamp;
+
+        sample.position.x = point.transforms[0].translation.x;
+        sample.position.y = point.transforms[0].translation.y;
+        sample.position.z = point.transforms[0].translation.z;
+        sample.yaw = Util::quaternion_to_euler_angle(point.transforms[0].rotation).z;
+
+        if (!point.velocities.empty()) {
+            sample.velocity = point.velocities[0].linear;
+        }
+
+        if (!point.accelerations.empty()) {
+            sample.acceleration = point.accelerations[0].linear;
+        }
+
+        if (!trajectory_buffer.push(sample)) {
+            ROS_WARN_STREAM_THROTTLE(1, ros::this_node::getName().c_str()
+                                            << ": Trajectory buffer full, dropped "
+                                            << trajectory_buffer.getDroppedCount() << " samples so far.");
+            return;
+        }
+    }
+}
+
+void FollowTrajectoryOperation::tick() {
+    TrajectorySample state;
+    const double now = ros::Time::now().toSec();
+
+    // Keep the setpoint from initialize until the first chunk arrives.
+    if (!trajectory_buffer.sample(now, state)) {
+        return;
+    }
+
+    setpoint.position = state.position;
+    setpoint.velocity = state.velocity;
+    setpoint.acceleration_or_force = state.acceleration;
+    setpoint.yaw = state.yaw;
+    setpoint.type_mask = TypeMask::POSITION_VELOCITY_AND_ACCELERATION;
+
+    // Past the end, the buffer holds the last sample until a new chunk continues the trajectory.
+    const double end_time = trajectory_buffer.getEndTime();
+    const bool is_past_end = now > end_time;
+
+    if (is_past_end && !past_end) {
+        FLUID_LOG_INFO("Reached the end of the trajectory, holding the last sample for %.1f s.",
+                       fluid.configuration.trajectory_end_grace_period);
+    }
+
+    past_end = is_past_end;
+    past_grace_period = now > end_time + fluid.configuration.trajectory_end_grace_period;
+}
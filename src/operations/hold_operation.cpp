@@ -4,17 +4,18 @@
 
 #include "hold_operation.h"
 
+#include <limits>
+
 #include "fluid.h"
 
-HoldOperation::HoldOperation() : Operation(OperationIdentifier::HOLD, true, false) {}
+HoldOperation::HoldOperation(Fluid& fluid)
+    : Operation(fluid, OperationIdentifier::HOLD, true, false, fluid.configuration.hold_refresh_rate),
+      convergence_predictor(fluid.configuration.completion_horizon, 2 * max_rate) {}
 
 bool HoldOperation::hasFinishedExecution() const {
-    const float threshold = Fluid::getInstance().configuration.velocity_completion_threshold;
-    bool low_enough_velocity = std::abs(getCurrentTwist().twist.linear.x) < threshold &&
-                               std::abs(getCurrentTwist().twist.linear.y) < threshold &&
-                               std::abs(getCurrentTwist().twist.linear.z) < threshold;
-
-    return low_enough_velocity;
+    // Only the velocity matters, the drone holds wherever it stops.
+    return convergence_predictor.hasConverged(std::numeric_limits<double>::infinity(),
+                                              fluid.configuration.velocity_completion_threshold);
 }
 
 void HoldOperation::initialize() {
@@ -23,4 +24,9 @@ void HoldOperation::initialize() {
     setpoint.position.z = getCurrentPose().pose.position.z + 0.1;  // Add a delta so the drone doesn't drop slightly
     setpoint.yaw = getCurrentYaw();
     setpoint.type_mask = TypeMask::POSITION;
+}
+
+void HoldOperation::tick() {
+    convergence_predictor.update(ros::Time::now().toSec(), getCurrentPose().pose.position, setpoint.position,
+                                 getCurrentTwist().twist.linear);
 }
\ No newline at end of file
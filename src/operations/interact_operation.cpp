@@ -7,9 +7,7 @@
 #include "util.h"
 #include "fluid.h" //to get access to the tick rate
 #include "type_mask.h"
-
-#include <ascend_msgs/SetInt.h>
-#include <std_srvs/Trigger.h>
+#include "deferred_log.h"
 
 //A list of parameters for the user
 #define MAST_INTERACT false //safety feature to avoid going at close proximity to the mast and set the FH
@@ -29,34 +27,55 @@
 
 #define MAX_ANGLE   1500 // in centi-degrees 
 
-uint16_t time_cout = 0; //used not to do some stuffs at every tick
-ros::Time prev_gt_pose_time;
-geometry_msgs::Vector3 DIST_FH_DRONE_CENTRE;
+#define CLOSE_TRACKING_TIMEOUT 1.0 //a close tracking call not answered within this is abandoned and sent again [s]
+
+#define MAX_LATENCY_COMPENSATION 0.3 //the interaction point state is never predicted further ahead than this [s]
+
+// Model predictive controller, only used when interaction_use_mpc is set
+#define MPC_TIME_STEP       0.1     // time between two steps of the horizon [s]
+#define MPC_MAX_ACCEL       3.0     // bound on the acceleration sent to the drone [m/s²]
+#define MPC_POSITION_WEIGHT 10.0
+#define MPC_VELOCITY_WEIGHT 1.0
+#define MPC_ACCEL_WEIGHT    0.1
+#define MPC_TIME_BUDGET     0.003   // compute time allowed for the controller every tick [s]
+#define MPC_MAX_ITERATIONS  50
+
 
 
 //function called when creating the operation
-InteractOperation::InteractOperation(const float& fixed_mast_yaw, const float& offset) : 
-            Operation(OperationIdentifier::INTERACT, false, false) { 
-    mast = Mast(fixed_mast_yaw);
+InteractOperation::InteractOperation(Fluid& fluid, const float& fixed_mast_yaw, const float& offset) : 
+            Operation(fluid, OperationIdentifier::INTERACT, false, false,
+                      fluid.configuration.interact_refresh_rate,
+                      fluid.configuration.interact_max_refresh_rate),
+            offset(offset),
+            rendezvous_planner(fluid.configuration.interact_max_vel,
+                               fluid.configuration.interact_max_acc,
+                               3, TIME_WINDOW_INTERACTION) { 
+    mast = Mast(fixed_mast_yaw, fluid.configuration.interaction_show_prints);
     
-    SHOW_PRINTS = Fluid::getInstance().configuration.interaction_show_prints;
-    EKF = Fluid::getInstance().configuration.ekf;
-    USE_PERCEPTION = Fluid::getInstance().configuration.use_perception;
-    MAX_ACCEL = Fluid::getInstance().configuration.interact_max_acc;
-    MAX_VEL = Fluid::getInstance().configuration.interact_max_vel;
-    DIST_FH_DRONE_CENTRE.x = Fluid::getInstance().configuration.fh_offset[0];
-    DIST_FH_DRONE_CENTRE.y = Fluid::getInstance().configuration.fh_offset[1];
-    DIST_FH_DRONE_CENTRE.z = Fluid::getInstance().configuration.fh_offset[2];
+    SHOW_PRINTS = fluid.configuration.interaction_show_prints;
+    EKF = fluid.configuration.ekf;
+    USE_PERCEPTION = fluid.configuration.use_perception;
+    USE_MPC = fluid.configuration.interact_use_mpc;
+    MAX_ACCEL = fluid.configuration.interact_max_acc;
+    MAX_VEL = fluid.configuration.interact_max_vel;
+
+    geometry_msgs::Point fh_offset;
+    fh_offset.x = fluid.configuration.fh_offset[0];
+    fh_offset.y = fluid.configuration.fh_offset[1];
+    fh_offset.z = fluid.configuration.fh_offset[2];
+    frames = FrameTransformer(fixed_mast_yaw, fh_offset);
 
     //Choose an initial offset. It is the offset for the approaching state.
     //the offset is set in the frame of the mast:    
-    desired_offset.x = offset;     //forward
-    desired_offset.y = DIST_FH_DRONE_CENTRE.y;     //left
-    desired_offset.z = DIST_FH_DRONE_CENTRE.z+0.03;    //up
+    desired_offset = frames.standoff(offset, 0.03);
 
     }
 
 void InteractOperation::initialize() {
+    std::shared_ptr<LatencyMonitor> latency_monitor_ptr = fluid.getLatencyMonitorPtr();
+    module_state_latency_source = latency_monitor_ptr->addSource(EKF ? "ekf_module_state" : "module_pose");
+    interaction_point_age_source = latency_monitor_ptr->addSource("interaction_point_age");
 
     if(EKF){
         ekf_module_pose_subscriber = node_handle.subscribe("/ekf/module/state",
@@ -78,8 +97,10 @@ void InteractOperation::initialize() {
     close_tracking_ready_subscriber = node_handle.subscribe("/close_tracking_running",
                                     10, &InteractOperation::closeTrackingCallback, this);
 
-    start_close_tracking_client = node_handle.serviceClient<ascend_msgs::SetInt>("start_close_tracking");
-    pause_close_tracking_client = node_handle.serviceClient<std_srvs::Trigger>("Pause_close_tracking");
+    start_close_tracking_caller.reset(new AsyncServiceCaller<ascend_msgs::SetInt>(
+        node_handle, "start_close_tracking", CLOSE_TRACKING_TIMEOUT));
+    pause_close_tracking_caller.reset(new AsyncServiceCaller<std_srvs::Trigger>(
+        node_handle, "Pause_close_tracking", CLOSE_TRACKING_TIMEOUT));
 
     interact_fail_pub = node_handle.advertise<std_msgs::Int16>("/fluid/interact_fail",10);
     altitude_and_yaw_pub = node_handle.advertise<mavros_msgs::PositionTarget>("/mavros/setpoint_raw/local",10);
@@ -87,12 +108,18 @@ void InteractOperation::initialize() {
     setpoint.type_mask = TypeMask::POSITION_AND_VELOCITY;
     setpoint.header.frame_id = "map";
 
-    MavrosInterface mavros_interface;
-    mavros_interface.setParam("ANGLE_MAX", MAX_ANGLE);
-    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Sat max angle to: " << MAX_ANGLE/100.0 << " deg.");
+    if(USE_MPC){
+        mpc_controller.reset(new MpcController(MPC_TIME_STEP, MPC_MAX_ACCEL, MPC_POSITION_WEIGHT,
+                                               MPC_VELOCITY_WEIGHT, MPC_ACCEL_WEIGHT,
+                                               MPC_TIME_BUDGET, MPC_MAX_ITERATIONS));
+        ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Uses MPC to follow the mast");
+    }
+
+    fluid.setParam("ANGLE_MAX", MAX_ANGLE);
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Setting max angle to: " << MAX_ANGLE/100.0 << " deg.");
 
     // The transition state is mesured in the mast frame
-    transition_state.state.position = desired_offset;
+    transition_state.state.position = Vec3::from(desired_offset);
     transition_state.cte_acc = MAX_ACCEL; 
     transition_state.max_vel = MAX_VEL;
     
@@ -104,6 +131,7 @@ void InteractOperation::initialize() {
     reference_state = DataFile("reference_state.txt");
     drone_pose = DataFile("drone_pose.txt");
     gt_reference = DataFile("gt_reference.txt");
+    tick_benchmark = DataFile("interact_tick_benchmark.txt");
 
     reference_state.shouldSaveZ(SAVE_Z);
     drone_pose.shouldSaveZ(SAVE_Z);
@@ -111,6 +139,7 @@ void InteractOperation::initialize() {
 
     reference_state.initStateLog();
     drone_pose.initStateLog();    
+    tick_benchmark.init("Time\ttick_time\ttracking_error\tmpc_iterations");
     #if SAVE_Z
     gt_reference.init("Time\tpose.x\tpose.y\tpose.z");
     #else
@@ -131,65 +160,78 @@ void InteractOperation::initialize() {
     }
 */
     approaching_t0 = ros::Time::now();
-    completion_count =0;
+    completion_time = 0.0;
 }
 
 bool InteractOperation::hasFinishedExecution() const {
     return interaction_state == InteractionState::EXTRACTED; 
 }
 
+int InteractOperation::getDesiredRate() const {
+    // Run as fast as allowed while close to the moving mast
+    switch (interaction_state) {
+        case InteractionState::READY:
+        case InteractionState::OVER:
+        case InteractionState::INTERACT:
+            return max_rate;
+        default:
+            return nominal_rate;
+    }
+}
+
 void InteractOperation::ekfModulePoseCallback(
-                const mavros_msgs::PositionTarget module_state) {
-    mast.updateFromEkf(module_state);
+                const mavros_msgs::PositionTarget::ConstPtr& module_state) {
+    fluid.getLatencyMonitorPtr()->record(module_state_latency_source, module_state->header.stamp);
+    mast.updateFromEkf(*module_state);
 }
 
 void InteractOperation::ekfStateVectorCallback(
-                const mavros_msgs::DebugValue ekf_state) {
-    mast.search_period(ekf_state.data[0]); //the first element is the pitch
-    mast.set_period(2*M_PI/ekf_state.data[4]);
+                const mavros_msgs::DebugValue::ConstPtr& ekf_state) {
+    mast.search_period(ekf_state->data[0]); //the first element is the pitch
+    mast.set_period(2*M_PI/ekf_state->data[4]);
 }
 
 void InteractOperation::gt_modulePoseCallbackWithCov(
-    const geometry_msgs::PoseWithCovarianceStampedConstPtr module_pose_ptr) {
+    const geometry_msgs::PoseWithCovarianceStamped::ConstPtr& module_pose_ptr) {
     geometry_msgs::PoseStamped module_pose;
     module_pose.header = module_pose_ptr->header;
     module_pose.pose = module_pose_ptr->pose.pose;
     gt_modulePoseCallback(module_pose);
 }
 
-void InteractOperation::gt_modulePoseCallbackWithoutCov(geometry_msgs::PoseStampedConstPtr module_pose_ptr){
+void InteractOperation::gt_modulePoseCallbackWithoutCov(const geometry_msgs::PoseStamped::ConstPtr& module_pose_ptr){
     gt_modulePoseCallback(*module_pose_ptr);
 }
 
 void InteractOperation::gt_modulePoseCallback(
-    const geometry_msgs::PoseStamped module_pose) {
+    const geometry_msgs::PoseStamped& module_pose) {
     if((module_pose.header.stamp - prev_gt_pose_time).toSec() >0.01){
         #if SAVE_DATA
             prev_gt_pose_time = module_pose.header.stamp;
-            mavros_msgs::PositionTarget smooth_rotated_offset = rotate(transition_state.state,mast.get_yaw());
+            const Vec3 smooth_rotated_offset = frames.mastToWorld(transition_state.state.position);
             geometry_msgs::Vector3 vec;
-            vec.x = module_pose.pose.position.x + smooth_rotated_offset.position.x;
-            vec.y = module_pose.pose.position.y + smooth_rotated_offset.position.y;
-            vec.z = module_pose.pose.position.z + smooth_rotated_offset.position.z;
+            vec.x = module_pose.pose.position.x + smooth_rotated_offset.x;
+            vec.y = module_pose.pose.position.y + smooth_rotated_offset.y;
+            vec.z = module_pose.pose.position.z + smooth_rotated_offset.z;
             gt_reference.saveVector3(vec);
         #endif
         if(!EKF){
-            const geometry_msgs::Vector3 received_eul_angle = Util::quaternion_to_euler_angle(module_pose.pose.orientation);
-            mast.update(module_pose);
-            mast.search_period(received_eul_angle.x); //pitch is y euler angle because of different frame
+            fluid.getLatencyMonitorPtr()->record(module_state_latency_source, module_pose.header.stamp);
+            Pose pose;
+            pose.position = Vec3::from(module_pose.pose.position);
+            pose.orientation = Vec3::from(Util::quaternion_to_euler_angle(module_pose.pose.orientation));
+            mast.update(pose, module_pose.header.stamp);
         }
     }
 }
 
-void InteractOperation::FaceHuggerCallback(const std_msgs::Bool released){
-    if (released.data && !faceHugger_is_set){
+void InteractOperation::FaceHuggerCallback(const std_msgs::Bool::ConstPtr& released){
+    if (released->data && !faceHugger_is_set){
         ROS_INFO_STREAM(ros::this_node::getName().c_str() << "CONGRATULATION, FaceHugger set on the mast! We can now exit the mast");
         interaction_state =  InteractionState::EXIT;
         faceHugger_is_set = true;
 
-        desired_offset.x = 2.0;   //forward
-        desired_offset.y = DIST_FH_DRONE_CENTRE.y;    //left
-        desired_offset.z = DIST_FH_DRONE_CENTRE.z - 0.3;   //up
+        desired_offset = frames.standoff(2.0, -0.3);
         transition_state.state.position.z = desired_offset.z;
         transition_state.cte_acc = MAX_ACCEL*3;
         transition_state.max_vel = MAX_VEL*3;
@@ -198,27 +240,8 @@ void InteractOperation::FaceHuggerCallback(const std_msgs::Bool released){
     }
 }
 
-void InteractOperation::closeTrackingCallback(std_msgs::Bool ready){
-    close_tracking_is_ready = ready.data; 
-}
-
-
-template<typename T>  T rotate2 (T pt, float yaw) {
-    T rotated_point;
-    rotated_point.x = cos(yaw) * pt.x - sin(yaw) * pt.y;
-    rotated_point.y = cos(yaw) * pt.y + sin(yaw) * pt.x;
-    rotated_point.z = pt.z;
-
-    return rotated_point;
-}
-
-mavros_msgs::PositionTarget InteractOperation::rotate(mavros_msgs::PositionTarget setpoint, float yaw){
-    mavros_msgs::PositionTarget rotated_setpoint;
-    rotated_setpoint.position = rotate2<geometry_msgs::Point>(setpoint.position, yaw);
-    rotated_setpoint.velocity = rotate2<geometry_msgs::Vector3>(setpoint.velocity, yaw);
-    rotated_setpoint.acceleration_or_force = rotate2<geometry_msgs::Vector3>(setpoint.acceleration_or_force, yaw);
-
-    return rotated_setpoint;
+void InteractOperation::closeTrackingCallback(const std_msgs::Bool::ConstPtr& ready){
+    close_tracking_is_ready = ready->data; 
 }
 
 
@@ -234,31 +257,31 @@ void InteractOperation::update_transition_state()
                             >= abs(desired_offset.x - transition_state.state.position.x)){
         // if it is time to brake to avoid overshoot
             //set the transition acceleration (or deceleration) to the one that will lead us to the exact point we want
-            transition_state.state.acceleration_or_force.x = - Util::sq(transition_state.state.velocity.x) 
+            transition_state.state.acceleration.x = - Util::sq(transition_state.state.velocity.x) 
                                             /2.0 / (desired_offset.x - transition_state.state.position.x);
         }
         else if (abs(transition_state.state.velocity.x) > transition_state.max_vel){
         // if we have reached max transitionning speed
             //we stop accelerating and maintain speed
-            transition_state.state.acceleration_or_force.x = 0.0;
+            transition_state.state.acceleration.x = 0.0;
         }
         else{
         //we are in the acceleration phase of the transition){
             if (desired_offset.x - transition_state.state.position.x > 0.0)
-                transition_state.state.acceleration_or_force.x = transition_state.cte_acc;
+                transition_state.state.acceleration.x = transition_state.cte_acc;
             else
-                transition_state.state.acceleration_or_force.x = - transition_state.cte_acc;
+                transition_state.state.acceleration.x = - transition_state.cte_acc;
         }
         // Whatever the state we are in, update velocity and position of the target
-        transition_state.state.velocity.x = transition_state.state.velocity.x + transition_state.state.acceleration_or_force.x / (float)rate_int;
-        transition_state.state.position.x = transition_state.state.position.x + transition_state.state.velocity.x / (float)rate_int;
+        transition_state.state.velocity.x = transition_state.state.velocity.x + transition_state.state.acceleration.x * tick_dt;
+        transition_state.state.position.x = transition_state.state.position.x + transition_state.state.velocity.x * tick_dt;
         
     }
     else if (abs(transition_state.state.velocity.x) < 0.1){
         //setpoint reached destination on this axis
         transition_state.state.position.x = desired_offset.x;
         transition_state.state.velocity.x = 0.0;
-        transition_state.state.acceleration_or_force.x = 0.0;
+        transition_state.state.acceleration.x = 0.0;
         transition_state.finished_bitmask |= 0x1;
     }
 
@@ -267,23 +290,23 @@ void InteractOperation::update_transition_state()
         transition_state.finished_bitmask &= ~0x2;
         if (Util::sq(transition_state.state.velocity.y) / 2.0 / transition_state.cte_acc 
                             >= abs(desired_offset.y - transition_state.state.position.y))
-            transition_state.state.acceleration_or_force.y = - Util::sq(transition_state.state.velocity.y) 
+            transition_state.state.acceleration.y = - Util::sq(transition_state.state.velocity.y) 
                                             /2.0 / (desired_offset.y - transition_state.state.position.y);
         else if (abs(transition_state.state.velocity.y) > transition_state.max_vel)
-            transition_state.state.acceleration_or_force.y = 0.0;
+            transition_state.state.acceleration.y = 0.0;
         else{
             if (desired_offset.y - transition_state.state.position.y > 0.0)
-                transition_state.state.acceleration_or_force.y = transition_state.cte_acc;
+                transition_state.state.acceleration.y = transition_state.cte_acc;
             else
-                transition_state.state.acceleration_or_force.y = - transition_state.cte_acc;
+                transition_state.state.acceleration.y = - transition_state.cte_acc;
             }
-        transition_state.state.velocity.y  =   transition_state.state.velocity.y  + transition_state.state.acceleration_or_force.y / (float)rate_int;
-        transition_state.state.position.y =  transition_state.state.position.y  + transition_state.state.velocity.y / (float)rate_int;
+        transition_state.state.velocity.y  =   transition_state.state.velocity.y  + transition_state.state.acceleration.y * tick_dt;
+        transition_state.state.position.y =  transition_state.state.position.y  + transition_state.state.velocity.y * tick_dt;
     }
     else if (abs(transition_state.state.velocity.y) < 0.1){
         transition_state.state.position.y = desired_offset.y;
         transition_state.state.velocity.y = 0.0;
-        transition_state.state.acceleration_or_force.y = 0.0;
+        transition_state.state.acceleration.y = 0.0;
         transition_state.finished_bitmask |= 0x2;
     }
 
@@ -292,149 +315,211 @@ void InteractOperation::update_transition_state()
         transition_state.finished_bitmask &= ~0x4;
         if (Util::sq(transition_state.state.velocity.z) / 2.0 / transition_state.cte_acc 
                             >= abs(desired_offset.z - transition_state.state.position.z))
-            transition_state.state.acceleration_or_force.z = - Util::sq(transition_state.state.velocity.z) 
+            transition_state.state.acceleration.z = - Util::sq(transition_state.state.velocity.z) 
                                             /2.0 / (desired_offset.z - transition_state.state.position.z);
         else if (abs(transition_state.state.velocity.z) > transition_state.max_vel)
-            transition_state.state.acceleration_or_force.z = 0.0;
+            transition_state.state.acceleration.z = 0.0;
         else {
             if (desired_offset.z - transition_state.state.position.z > 0.0)
-                transition_state.state.acceleration_or_force.z = transition_state.cte_acc;
+                transition_state.state.acceleration.z = transition_state.cte_acc;
             else 
-                transition_state.state.acceleration_or_force.z = - transition_state.cte_acc;
+                transition_state.state.acceleration.z = - transition_state.cte_acc;
         }
-        transition_state.state.velocity.z =  transition_state.state.velocity.z + transition_state.state.acceleration_or_force.z / (float)rate_int;
-        transition_state.state.position.z =  transition_state.state.position.z + transition_state.state.velocity.z / (float)rate_int;
+        transition_state.state.velocity.z =  transition_state.state.velocity.z + transition_state.state.acceleration.z * tick_dt;
+        transition_state.state.position.z =  transition_state.state.position.z + transition_state.state.velocity.z * tick_dt;
     }
     else if (abs(transition_state.state.velocity.z) < 0.1){
         transition_state.state.position.z = desired_offset.z;
         transition_state.state.velocity.z = 0.0;
-        transition_state.state.acceleration_or_force.z = 0.0;
+        transition_state.state.acceleration.z = 0.0;
         transition_state.finished_bitmask |= 0x4;
     }
 }
 
 
-float InteractOperation::estimate_time_to_mast()
+float InteractOperation::estimate_time_to_mast() const
 {
     // Estimation of the time it takes to go from current position to interaction point
-    float dist = transition_state.state.position.x - DIST_FH_DRONE_CENTRE.x; //assuming that the drone is always accurate
-    float dist_acc_decc = Util::sq(MAX_VEL)/MAX_ACCEL;
-    if (dist < dist_acc_decc)
-        return 2.0 * sqrt(2.0*dist/MAX_ACCEL);
-    else
-        return (dist - dist_acc_decc) / MAX_VEL //time during max vel
-                    + 2 * MAX_VEL / MAX_ACCEL; //time during acceleration and decceleration
+    float dist = transition_state.state.position.x - frames.getFaceHuggerOffset().x; //assuming that the drone is always accurate
+    return RendezvousPlanner::travelTime(dist, MAX_VEL, MAX_ACCEL);
+}
+
+OperationProgress InteractOperation::getProgress() const {
+    OperationProgress progress;
+
+    switch (interaction_state) {
+        case InteractionState::APPROACHING:
+            progress.state = "APPROACHING";
+            break;
+        case InteractionState::READY:
+            progress.state = "READY";
+            break;
+        case InteractionState::OVER:
+            progress.state = "OVER";
+            break;
+        case InteractionState::INTERACT:
+            progress.state = "INTERACT";
+            break;
+        case InteractionState::EXIT:
+            progress.state = "EXIT";
+            break;
+        case InteractionState::EXTRACTED:
+            progress.state = "EXTRACTED";
+            break;
+    }
+
+    // The distance along the mast x axis between the reference and the face hugger touching the mast.
+    if (interaction_state == InteractionState::APPROACHING || interaction_state == InteractionState::READY ||
+        interaction_state == InteractionState::OVER) {
+        progress.distance_remaining =
+            std::max(0.0, transition_state.state.position.x - frames.getFaceHuggerOffset().x);
+        progress.eta = estimate_time_to_mast();
+    }
+
+    return progress;
+}
+
+void InteractOperation::saveCheckpoint(CheckpointState& state) {
+    state.fixed_mast_yaw = mast.get_yaw();
+    state.offset = offset;
 }
 
+void InteractOperation::saveCheckpointProgress(CheckpointState& state) {
+    state.mast_estimate = mast.get_estimate();
+    // Once out of the mast the interaction is over, after a restart the drone only has to hold.
+    state.is_completed = interaction_state == InteractionState::EXIT ||
+                         interaction_state == InteractionState::EXTRACTED;
+}
+
+void InteractOperation::restoreMastEstimate(const MastEstimate& estimate) { mast.restore_estimate(estimate); }
+
 void InteractOperation::tick() {
-    time_cout++;
-    mavros_msgs::PositionTarget interact_pt_state = mast.get_interaction_point_state();
+    const ros::WallTime tick_start = ros::WallTime::now();
+    // Predict the interaction point to now, so the latency of perception and EKF does not turn into tracking error.
+    const ros::Time now = ros::Time::now();
+    const PVAState interact_pt_state = mast.get_interaction_point_state(now, MAX_LATENCY_COMPENSATION);
     //printf("mast pitch %f, roll %f, angle %f\n", mast_angle.x, mast_angle.y, mast_angle.z);
     // Wait until we get the first module position readings before we do anything else.
-    if (interact_pt_state.header.seq == 0) {
-        if(time_cout%rate_int==0)
-            ROS_INFO_STREAM(ros::this_node::getName().c_str() 
-                                << ": Waiting for interaction point pose callback\n");
+    if (mast.get_interaction_point_stamp().isZero()) {
+        FLUID_LOG_INFO_THROTTLE(1.0, "Waiting for interaction point pose callback");
         approaching_t0 = ros::Time::now();
         return;
     }
+    fluid.getLatencyMonitorPtr()->record(interaction_point_age_source, 
+                                                        mast.get_interaction_point_stamp(), now);
 
     update_transition_state();
 
-    geometry_msgs::Point rotated_offset = rotate2<geometry_msgs::Point>(desired_offset,mast.get_yaw());
-    const double dx = interact_pt_state.position.x + rotated_offset.x - getCurrentPose().pose.position.x;
-    const double dy = interact_pt_state.position.y + rotated_offset.y - getCurrentPose().pose.position.y;
-    const double dz = interact_pt_state.position.z + rotated_offset.z - getCurrentPose().pose.position.z;
+    frames.setMastYaw(mast.get_yaw());
+    geometry_msgs::Point rotated_offset = frames.mastToWorld(desired_offset);
+    // Compare the drone and the interaction point at the newest time both have been measured at, so the error does
+    // not mix samples from different instants. Falls back to the latest values if the histories do not overlap.
+    const StateHistory& drone_history = fluid.getStateHubPtr()->getHistory();
+    const double common_time = std::min(drone_history.getNewestTime(), mast.get_history().getNewestTime());
+    StateSample drone_sample, interact_pt_sample;
+    geometry_msgs::Point drone_position = getCurrentPose().pose.position;
+    geometry_msgs::Point interact_pt_position = interact_pt_state.position.to<geometry_msgs::Point>();
+
+    if (drone_history.sample(common_time, drone_sample) && mast.get_history().sample(common_time, interact_pt_sample)) {
+        drone_position = drone_sample.position;
+        interact_pt_position = interact_pt_sample.position;
+    }
+
+    const double dx = interact_pt_position.x + rotated_offset.x - drone_position.x;
+    const double dy = interact_pt_position.y + rotated_offset.y - drone_position.y;
+    const double dz = interact_pt_position.z + rotated_offset.z - drone_position.z;
     const double distance_to_offset = sqrt(Util::sq(dx) + Util::sq(dy) + Util::sq(dz));
     
     switch (interaction_state) {
         case InteractionState::APPROACHING: {
-            if (SHOW_PRINTS and time_cout%rate_int==0) {
-                printf("APPROACHING\t");
-                printf("distance to ref %f\n", distance_to_offset);
-            }
+            if (SHOW_PRINTS)
+                FLUID_LOG_INFO_THROTTLE(1.0, "APPROACHING\tdistance to ref %f", distance_to_offset);
                        
             if(MAST_INTERACT) {
                 float time_out_gain = 1 + (ros::Time::now()-approaching_t0).toSec()/30.0;
                 if ( distance_to_offset <= APPROACH_ACCURACY *time_out_gain ) { 
                     //Todo, we may want to judge the velocity in stead of having a time to completion
-                    if (completion_count < ceil(TIME_TO_COMPLETION * (float)rate_int) )
-                        completion_count++;
+                    // Summed from the tick durations, so the dwell doesn't shrink when triggered steps come faster
+                    // than the rate.
+                    if (completion_time < TIME_TO_COMPLETION)
+                        completion_time += tick_dt;
                     else {
                         //We consider that if the drone is ready at some point, it will 
                         //remain ready until it is time to try
-                        ROS_INFO_STREAM(ros::this_node::getName().c_str()
-                                        << ": " << "Approaching -> Ready");
+                        FLUID_LOG_INFO("Approaching -> Ready");
 
-                        completion_count = 0;
-                        ROS_INFO_STREAM(ros::this_node::getName().c_str() 
-                                << ": Control ready to set the FaceHugger."
-                                << " Waiting for the best opportunity");
+                        completion_time = 0.0;
+                        FLUID_LOG_INFO("Control ready to set the FaceHugger. Waiting for the best opportunity");
                         interaction_state = InteractionState::READY;   
                         desired_offset.x = MAX_DIST_FOR_CLOSE_TRACKING;             
                     }
                 }
                 else
-                    completion_count = 0;
+                    completion_time = 0.0;
             }
             break;
         }
         case InteractionState::READY: {
             //The drone is ready, we just have to wait for the best moment to go!
             if(!close_tracking_is_set and (transition_state.finished_bitmask & 0x7) == 0x7){
-                ROS_INFO_STREAM(ros::this_node::getName().c_str() 
-                        << ": Turning on close tracking");
-                
-                // send a message to perception to switch close tracking on.
+                // send a message to perception to switch close tracking on, the answer is polled every tick and
+                // the call is sent again if it fails or times out.
                 if(USE_PERCEPTION){
-                    ascend_msgs::SetInt srv;
-                    srv.request.data = 10;
-                    if (start_close_tracking_client.call(srv)){
-                        close_tracking_is_set = true; 
+                    switch (start_close_tracking_caller->poll()) {
+                        case AsyncCallStatus::IDLE: {
+                            FLUID_LOG_INFO("Turning on close tracking");
+                            ascend_msgs::SetInt::Request request;
+                            request.data = 10;
+                            start_close_tracking_caller->call(request);
+                            break;
+                        }
+                        case AsyncCallStatus::SUCCEEDED:
+                            close_tracking_is_set = true;
+                            break;
+                        default:
+                            break;
                     }
                 }
                 else{
+                    FLUID_LOG_INFO("Turning on close tracking");
                     close_tracking_is_set= true; //Todo, to be removed
                     close_tracking_is_ready = true;
                 }
             }
             if(mast.time_to_max_pitch() !=-1){ //we don't konw it yet
-                float time_to_wait = mast.time_to_max_pitch()-estimate_time_to_mast();
-//              printf("t_2max_pitch %f\t t_2mast %f\tt_wait %f\n",
-//                          mast.time_to_max_pitch(), estimate_time_to_mast(), time_to_wait);
-                if(time_to_wait < -TIME_WINDOW_INTERACTION){
-                    time_to_wait+=mast.get_period();
+                // Evaluate the next oscillations and approach profiles and go as soon as one is feasible
+                const float distance_to_mast = transition_state.state.position.x - frames.getFaceHuggerOffset().x;
+                const RendezvousPlan plan = rendezvous_planner.plan(mast.time_to_max_pitch(), mast.get_period(),
+                                                                    mast.get_amplitude(), distance_to_mast);
+                if (SHOW_PRINTS) {
+                    if(plan.feasible)
+                        FLUID_LOG_INFO_THROTTLE(0.5, "READY; Estimated waiting time before go: %f (window %d, max vel %f)",
+                                                plan.launch_time, plan.window, plan.max_vel);
+                    else
+                        FLUID_LOG_INFO_THROTTLE(0.5, "READY; no feasible window among %d candidates",
+                                                plan.evaluated_candidates);
                 }
-                if (SHOW_PRINTS and time_cout%(rate_int/2)==0) {
-                    ROS_INFO_STREAM("READY; "
-                            << "Estimated waiting time before go: "
-                            << time_to_wait);
-                }
-                if( close_tracking_is_ready and (abs(time_to_wait) <= TIME_WINDOW_INTERACTION) )
+                if( close_tracking_is_ready and plan.feasible and plan.launch_time <= 1.0/rate_int )
                 { //We are in the good window to set the faceHugger
                     interaction_state = InteractionState::OVER;
-                    ROS_INFO_STREAM(ros::this_node::getName().c_str()
-                                << ": " << "Ready -> Over");
-                    desired_offset.x = DIST_FH_DRONE_CENTRE.x;  //forward
-                    desired_offset.y = DIST_FH_DRONE_CENTRE.y;   //left
-                    desired_offset.z = DIST_FH_DRONE_CENTRE.z+0.03; //up
-                    transition_state.cte_acc = MAX_ACCEL;
-                    transition_state.max_vel = MAX_VEL;
+                    FLUID_LOG_INFO("Ready -> Over");
+                    desired_offset = frames.faceHuggerToDrone(0.0, 0.03);
+                    transition_state.cte_acc = plan.max_acc;
+                    transition_state.max_vel = plan.max_vel;
                     transition_state.finished_bitmask = 0x0;
                 }
             }
             break;
         }
         case InteractionState::OVER: {
-            if (SHOW_PRINTS and time_cout%(rate_int*2)==0)
-                printf("OVER\n");
+            if (SHOW_PRINTS)
+                FLUID_LOG_INFO_THROTTLE(2.0, "OVER");
     
             //We assume that the accuracy is fine, we don't want to take the risk to stay too long
             if ((transition_state.finished_bitmask & 0x7) == 0x7) {
                 interaction_state = InteractionState::INTERACT;
-                ROS_INFO_STREAM(ros::this_node::getName().c_str()
-                            << ": " << "Over -> Interact");
-                desired_offset.x = DIST_FH_DRONE_CENTRE.x;  //forward
+                FLUID_LOG_INFO("Over -> Interact");
+                desired_offset.x = frames.getFaceHuggerOffset().x;  //forward
                 desired_offset.y = 0.0;   //left
                 desired_offset.z -= 0.2;  //up
                 transition_state.finished_bitmask = 0x0;
@@ -442,25 +527,22 @@ void InteractOperation::tick() {
             break;
         }
         case InteractionState::INTERACT: {
-            if (SHOW_PRINTS and time_cout%(rate_int*2)==0) 
-                printf("INTERACT\n");
+            if (SHOW_PRINTS)
+                FLUID_LOG_INFO_THROTTLE(2.0, "INTERACT");
 
             // we don't want to take the risk to stay too long, 
             // Whether the faceHugger is set or not, we have to exit.
             // NB, when FH is set, an interupt function switches the state to EXIT
             if ((transition_state.finished_bitmask & 0x7) == 0x7) {
                 interaction_state = InteractionState::EXIT;
-                ROS_INFO_STREAM(ros::this_node::getName().c_str() 
-                        << "Interact -> Exiting\n"
-                        << "Exit for safety reasons, the FaceHugger could not be placed..."); 
+                FLUID_LOG_INFO("Interact -> Exiting\n"
+                               "Exit for safety reasons, the FaceHugger could not be placed...");
 
                 //we move backward to ensure there will be no colision
                 // We directly set the transition state as we want to move as fast as possible
                 // and we don't mind anymore about the relative position to the mast
-                desired_offset.x = 2;   //forward
-                desired_offset.y = DIST_FH_DRONE_CENTRE.y;    //left
-                desired_offset.z = DIST_FH_DRONE_CENTRE.z;   //up
-                transition_state.state.position = desired_offset;
+                desired_offset = frames.standoff(2.0, 0.0);
+                transition_state.state.position = Vec3::from(desired_offset);
                 transition_state.cte_acc = MAX_ACCEL*3;
                 transition_state.max_vel = MAX_VEL*3;
                 transition_state.finished_bitmask = 0x0;
@@ -470,47 +552,48 @@ void InteractOperation::tick() {
         }
         case InteractionState::EXIT: {
             // NB, when FH is set, an interupt function switches the state to EXIT
-            if (SHOW_PRINTS and time_cout%(rate_int*2)==0) 
-                printf("EXIT\n");
+            if (SHOW_PRINTS)
+                FLUID_LOG_INFO_THROTTLE(2.0, "EXIT");
     
             if(close_tracking_is_set){
                 if(USE_PERCEPTION){ //we are getting to far from the mast, and the position is not stable.
-                    std_srvs::Trigger srv;
-                    if (pause_close_tracking_client.call(srv)){
-                        close_tracking_is_set = false;
+                    switch (pause_close_tracking_caller->poll()) {
+                        case AsyncCallStatus::IDLE:
+                            FLUID_LOG_INFO("switch close tracking off");
+                            pause_close_tracking_caller->call(std_srvs::Trigger::Request());
+                            break;
+                        case AsyncCallStatus::SUCCEEDED:
+                            close_tracking_is_set = false;
+                            break;
+                        default:
+                            break;
                     }
                 }
                 else{
                         close_tracking_is_set = false;
                         close_tracking_is_ready = false;
+                        FLUID_LOG_INFO("switch close tracking off");
                 }
-                ROS_INFO_STREAM(ros::this_node::getName().c_str()
-                        << ": " << "switch close tracking off");
             }
             
             // Come back the the base or try again.
             if ( distance_to_offset < 0.2 ) {
                 if (faceHugger_is_set){
-                    ROS_INFO_STREAM(ros::this_node::getName().c_str()
-                            << ": " << "Exit -> Extracted");
+                    FLUID_LOG_INFO("Exit -> Extracted");
                     interaction_state = InteractionState::EXTRACTED;
-                    desired_offset.x = 4;
-                    desired_offset.y = DIST_FH_DRONE_CENTRE.y;
+                    desired_offset = frames.standoff(4.0, 0.0);
                     desired_offset.z = 3;
                     transition_state.cte_acc = MAX_ACCEL*3;
                     transition_state.max_vel = MAX_VEL*3;
                 }
                 else {
-                    ROS_INFO_STREAM(ros::this_node::getName().c_str()
-                            << ": " << "Exit -> Approaching");
+                    FLUID_LOG_INFO("Exit -> Approaching");
                     //ascend_msgs::SetInt interact_fail_srv;
                     number_fail.data++;
                     //interact_fail_srv.request.data = number_fail;
                     for(int i = 0; i<3 ; i ++) interact_fail_pub.publish(number_fail);
                     interaction_state = InteractionState::APPROACHING;
-                    desired_offset.x = 2;
-                    desired_offset.y = DIST_FH_DRONE_CENTRE.y;
-                    desired_offset.z = DIST_FH_DRONE_CENTRE.z+0.03;
+                    desired_offset = frames.standoff(2.0, 0.03);
                     transition_state.cte_acc = MAX_ACCEL;
                     transition_state.max_vel = MAX_VEL;
                 }
@@ -518,34 +601,71 @@ void InteractOperation::tick() {
             break;
         }
         case InteractionState::EXTRACTED: {
-            if (SHOW_PRINTS and time_cout%(rate_int*2)==0) 
-                printf("EXTRACTED\n");
+            if (SHOW_PRINTS)
+                FLUID_LOG_INFO_THROTTLE(2.0, "EXTRACTED");
             // Operation finished, waiting for AI to close the operation
         }
     }//end switch state
 
-    if (SHOW_PRINTS and time_cout% rate_int ==0) {
-        printf("transition pose\tx %f,\ty %f,\tz %f\n",transition_state.state.position.x,
-                        transition_state.state.position.y, transition_state.state.position.z);
-        geometry_msgs::Point cur_drone_pose = getCurrentPose().pose.position;
-        printf("Drone pose\tx %f,\ty %f,\tz %f\tyaw %f\n",cur_drone_pose.x,
-                                        cur_drone_pose.y, cur_drone_pose.z,getCurrentYaw());
+    if (SHOW_PRINTS) {
+        FLUID_LOG_INFO_THROTTLE(1.0, "transition pose\tx %f,\ty %f,\tz %f", transition_state.state.position.x,
+                                transition_state.state.position.y, transition_state.state.position.z);
+        const geometry_msgs::Point& cur_drone_pose = getCurrentPose().pose.position;
+        FLUID_LOG_INFO_THROTTLE(1.0, "Drone pose\tx %f,\ty %f,\tz %f\tyaw %f", cur_drone_pose.x,
+                                cur_drone_pose.y, cur_drone_pose.z, getCurrentYaw());
     }
     
-    mavros_msgs::PositionTarget smooth_rotated_offset = rotate(transition_state.state,mast.get_yaw());
-    mavros_msgs::PositionTarget ref = Util::addPositionTarget(interact_pt_state,smooth_rotated_offset);
+    const PVAState ref = interact_pt_state + frames.mastToWorld(transition_state.state);
 
     setpoint.header.seq++;
     setpoint.header.stamp = ros::Time::now();
     setpoint.yaw = mast.get_yaw()+M_PI;
-    setpoint.position = ref.position;
-    setpoint.velocity = ref.velocity;
+    setpoint.position = ref.position.to<geometry_msgs::Point>();
+    setpoint.velocity = ref.velocity.to<geometry_msgs::Vector3>();
+    setpoint.acceleration_or_force = geometry_msgs::Vector3();
+
+    // The MPC only tracks the mast close to it, the approach and the exit follow the transition setpoint.
+    const bool should_use_mpc = USE_MPC && (interaction_state == InteractionState::OVER ||
+                                            interaction_state == InteractionState::INTERACT);
+
+    // Only the MPC commands an acceleration, the transition setpoint leaves it at zero and it must not be sent then.
+    setpoint.type_mask = should_use_mpc ? TypeMask::POSITION_VELOCITY_AND_ACCELERATION
+                                        : TypeMask::POSITION_AND_VELOCITY;
+
+    int mpc_iterations = 0;
+    if(!should_use_mpc && mpc_controller){
+        // Start over when it takes over again, the previous solution is stale by then.
+        mpc_controller->reset();
+    }
+
+    if(should_use_mpc){
+        // Predict the reference over the horizon with a constant acceleration.
+        MpcController::Reference horizon;
+        for(int k = 0; k < MpcController::HORIZON; k++){
+            horizon[k] = ref.predict((k+1) * mpc_controller->getTimeStep());
+        }
+
+        const MpcController::Result result = mpc_controller->solve(getCurrentPose().pose.position,
+                                                                   getCurrentTwist().twist.linear, horizon, tick_dt);
+        setpoint.position = result.position;
+        setpoint.velocity = result.velocity;
+        setpoint.acceleration_or_force = result.acceleration;
+        mpc_iterations = result.iterations;
+    }
 
     altitude_and_yaw_pub.publish(setpoint);
     
     #if SAVE_DATA
-        reference_state.saveStateLog(ref);
-        geometry_msgs::Vector3 drone_acc = rotate2<geometry_msgs::Vector3>(getCurrentAccel(),getCurrentYaw());
+        double benchmark[3] = {(ros::WallTime::now() - tick_start).toSec(),
+                               Util::distanceBetween(ref.position.to<geometry_msgs::Point>(),
+                                                     getCurrentPose().pose.position),
+                               (double) mpc_iterations};
+        tick_benchmark.saveArray(benchmark, 3);
+        reference_state.saveStateLog(ref.position.to<geometry_msgs::Point>(),
+                                     ref.velocity.to<geometry_msgs::Vector3>(),
+                                     ref.acceleration.to<geometry_msgs::Vector3>());
+        frames.setDroneYaw(getCurrentYaw());
+        geometry_msgs::Vector3 drone_acc = frames.bodyToWorld(getCurrentAccel());
         drone_pose.saveStateLog( getCurrentPose().pose.position,getCurrentTwist().twist.linear,drone_acc);
     #endif
 }
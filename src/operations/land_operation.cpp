@@ -4,23 +4,82 @@
 
 #include "land_operation.h"
 
+#include <mavros_msgs/ExtendedState.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "deferred_log.h"
 #include "fluid.h"
 
-LandOperation::LandOperation() : Operation(OperationIdentifier::LAND, true, true) {}
+#define SETPOINT_LEAD_TIME 0.5           // Longest time the descending setpoint is ahead of the drone [s]
+#define ACCELERATION_SMOOTHING 0.3       // Weight of a new sample in the smoothed vertical acceleration
+#define TOUCHDOWN_ACCELERATION 2.0       // Upward acceleration felt as an impact with the ground [m/s²]
+#define TOUCHDOWN_TIME 1.0               // Time stopped during the final approach before touchdown is assumed [s]
+#define TOUCHDOWN_CONFIRMATION_TIME 0.2  // Time stopped after an impact before touchdown is assumed [s]
+
+LandOperation::LandOperation(Fluid& fluid)
+    : Operation(fluid, OperationIdentifier::LAND, true, true), mavros_interface(fluid) {}
 
 bool LandOperation::isBelowThreshold() const {
     return getCurrentPose().pose.position.z < 0.05 &&
            std::abs(getCurrentTwist().twist.linear.z) <
-               Fluid::getInstance().configuration.velocity_completion_threshold;
+               fluid.configuration.velocity_completion_threshold;
 }
 
-bool LandOperation::hasFinishedExecution() const { return isBelowThreshold() && setpoint.type_mask == TypeMask::IDLE; }
+bool LandOperation::isOnGround() const {
+    return isBelowThreshold() ||
+           fluid.getStateHubPtr()->getLandedState() == mavros_msgs::ExtendedState::LANDED_STATE_ON_GROUND;
+}
+
+bool LandOperation::isInLandMode() const { return mavros_interface.getCurrentState().mode == ARDUPILOT_MODE_LAND; }
+
+bool LandOperation::hasFinishedExecution() const {
+    // Guided is only left once ArduPilot has confirmed the land mode, so the next operation doesn't take over a drone
+    // that nobody lands.
+    if (fluid.configuration.fast_landing) {
+        return phase == Phase::TOUCHDOWN && (is_land_mode_set || isInLandMode());
+    }
+
+    return isBelowThreshold() && setpoint.type_mask == TypeMask::IDLE;
+}
+
+OperationProgress LandOperation::getProgress() const {
+    OperationProgress progress;
+    progress.state = getStringFromOperationIdentifier(identifier);
+    progress.distance_remaining = std::max(0.0, getCurrentPose().pose.position.z);
+    return progress;
+}
+
+std::string LandOperation::getArdupilotMode() const {
+    // A drone which has touched down, or which ArduPilot is already landing, is left to the land mode, which disarms
+    // it.
+    if (fluid.configuration.fast_landing && phase != Phase::TOUCHDOWN && !isOnGround() && !isInLandMode()) {
+        return ARDUPILOT_MODE_GUIDED;
+    }
+
+    return ARDUPILOT_MODE_LAND;
+}
 
 void LandOperation::initialize() {
+    if (fluid.configuration.fast_landing) {
+        phase = isOnGround() || isInLandMode() ? Phase::TOUCHDOWN : Phase::DESCENT;
+        // The operation only begins once ArduPilot has accepted the mode it asked for, which is land in that case.
+        is_land_mode_set = phase == Phase::TOUCHDOWN;
+        previous_vertical_velocity = getCurrentTwist().twist.linear.z;
+        vertical_acceleration = 0;
+        stall_start_time = impact_time = ros::Time();
+    }
+
     // If land is issued and the drone is currently at ground, just keep sending setpoints with idle type mask
-    if (isBelowThreshold()) {
+    if (isBelowThreshold() || phase == Phase::TOUCHDOWN) {
         setpoint.position.x = setpoint.position.y = setpoint.position.z = 0;
         setpoint.type_mask = TypeMask::IDLE;
+    } else if (fluid.configuration.fast_landing) {
+        setpoint.position = getCurrentPose().pose.position;
+        setpoint.velocity.x = setpoint.velocity.y = setpoint.velocity.z = 0;
+        setpoint.yaw = getCurrentYaw();
+        setpoint.type_mask = TypeMask::POSITION_AND_VELOCITY;
     } else {
         setpoint.position.x = getCurrentPose().pose.position.x;
         setpoint.position.y = getCurrentPose().pose.position.y;
@@ -30,9 +89,90 @@ void LandOperation::initialize() {
     }
 }
 
+bool LandOperation::hasTouchedDown() {
+    const double vertical_velocity = getCurrentTwist().twist.linear.z;
+    const double acceleration = (vertical_velocity - previous_vertical_velocity) / tick_dt;
+    previous_vertical_velocity = vertical_velocity;
+    vertical_acceleration += ACCELERATION_SMOOTHING * (acceleration - vertical_acceleration);
+
+    if (phase != Phase::FINAL_APPROACH) {
+        return false;
+    }
+
+    if (fluid.getStateHubPtr()->getLandedState() == mavros_msgs::ExtendedState::LANDED_STATE_ON_GROUND) {
+        return true;
+    }
+
+    const ros::Time now = ros::Time::now();
+
+    // The ground stops the descent abruptly, which is felt as an upward acceleration.
+    if (vertical_acceleration > TOUCHDOWN_ACCELERATION) {
+        impact_time = now;
+    }
+
+    // The drone is commanded down, so it only stops descending when it is held by the ground.
+    if (std::abs(vertical_velocity) > 0.5 * fluid.configuration.land_final_speed) {
+        stall_start_time = ros::Time();
+        return false;
+    }
+
+    if (stall_start_time.isZero()) {
+        stall_start_time = now;
+    }
+
+    const bool has_felt_impact = !impact_time.isZero() && (now - impact_time).toSec() < TOUCHDOWN_TIME;
+    return (now - stall_start_time).toSec() >= (has_felt_impact ? TOUCHDOWN_CONFIRMATION_TIME : TOUCHDOWN_TIME);
+}
+
+void LandOperation::tickFastLanding() {
+    if (phase == Phase::TOUCHDOWN) {
+        // Requested again until ArduPilot accepts the land mode.
+        if (!is_land_mode_set && land_mode_request.valid() &&
+            land_mode_request.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            is_land_mode_set = land_mode_request.get();
+
+            if (!is_land_mode_set) {
+                FLUID_LOG_WARN_THROTTLE(1.0, "Failed to set land mode after touchdown, retrying.");
+                land_mode_request = mavros_interface.setModeAsync(ARDUPILOT_MODE_LAND);
+            }
+        }
+
+        return;
+    }
+
+    const double height = getCurrentPose().pose.position.z;
+
+    if (phase == Phase::DESCENT && height <= fluid.configuration.land_flare_height) {
+        phase = Phase::FINAL_APPROACH;
+        FLUID_LOG_INFO("Final approach at %.2f m.", height);
+    }
+
+    const double speed = phase == Phase::DESCENT ? fluid.configuration.land_descent_speed
+                                                 : fluid.configuration.land_final_speed;
+
+    // The setpoint is moved down at the descent speed, but kept close to the drone, so that it does not run away
+    // while the drone is slowed down by the flare or held by the ground.
+    setpoint.position.z = std::max(setpoint.position.z - speed * tick_dt, height - speed * SETPOINT_LEAD_TIME);
+    setpoint.velocity.z = -speed;
+
+    if (hasTouchedDown()) {
+        phase = Phase::TOUCHDOWN;
+        setpoint.position.x = setpoint.position.y = setpoint.position.z = 0;
+        setpoint.velocity.z = 0;
+        setpoint.type_mask = TypeMask::IDLE;
+        land_mode_request = mavros_interface.setModeAsync(ARDUPILOT_MODE_LAND);
+        FLUID_LOG_INFO("Touchdown, handing over to land mode.");
+    }
+}
+
 void LandOperation::tick() {
+    if (fluid.configuration.fast_landing) {
+        tickFastLanding();
+        return;
+    }
+
     if (isBelowThreshold()) {
         setpoint.position.x = setpoint.position.y = setpoint.position.z = 0;
         setpoint.type_mask = TypeMask::IDLE;
     }
-}
\ No newline at end of file
+}
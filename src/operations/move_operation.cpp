@@ -11,26 +11,64 @@
 #include <tf2/transform_datatypes.h>
 
 #include "fluid.h"
-#include "mavros_interface.h"
+#include "path_simplifier.h"
 #include "util.h"
 
-MoveOperation::MoveOperation(const OperationIdentifier& operation_identifier,
+MoveOperation::MoveOperation(Fluid& fluid,
+                             const OperationIdentifier& operation_identifier,
                              const std::vector<geometry_msgs::Point>& path, const double& speed,
                              const double& position_threshold, const double& velocity_threshold,
                              const double& max_angle = 45)
-    : Operation(operation_identifier, false, true),
+    : Operation(fluid, operation_identifier, false, true),
       path(path),
       speed(speed*100),
       position_threshold(position_threshold),
       velocity_threshold(velocity_threshold),
-      max_angle(max_angle*100) {}
+      max_angle(max_angle*100),
+      original_path_size(path.size()),
+      convergence_predictor(fluid.configuration.completion_horizon, 2 * max_rate) {
+    const FluidConfiguration& configuration = fluid.configuration;
+    const PathSimplifier path_simplifier(
+        configuration.path_tolerance, configuration.path_min_spacing, configuration.path_resample_spacing);
+
+    SimplifiedPath simplified_path = path_simplifier.simplify(path);
+
+    if (simplified_path.points.size() != path.size()) {
+        ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Simplified the path from " << path.size() << " to "
+                                                          << simplified_path.points.size() << " points.");
+    }
+
+    this->path = std::move(simplified_path.points);
+    original_indices = std::move(simplified_path.original_indices);
+}
 
 bool MoveOperation::hasFinishedExecution() const { return been_to_all_points; }
 
+OperationProgress MoveOperation::getProgress() const {
+    OperationProgress progress;
+    const long index = current_setpoint_iterator - path.begin();
+
+    // Report the waypoint of the requested path, unless the path has been replaced since.
+    const bool has_original_indices = original_indices.size() == path.size();
+    const size_t waypoint = has_original_indices ? original_indices[index] + 1 : index + 1;
+    const size_t waypoints = has_original_indices ? original_path_size : path.size();
+
+    progress.state = getStringFromOperationIdentifier(identifier) + ": waypoint " + std::to_string(waypoint) + "/" +
+                     std::to_string(waypoints);
+
+    progress.distance_remaining = Util::distanceBetween(getCurrentPose().pose.position, *current_setpoint_iterator);
+    for (auto iterator = current_setpoint_iterator; iterator + 1 < path.end(); iterator++) {
+        progress.distance_remaining += Util::distanceBetween(*iterator, *(iterator + 1));
+    }
+
+    progress.eta = progress.distance_remaining / (speed / 100);
+    return progress;
+}
+
 void MoveOperation::initialize() {
     for (auto iterator = path.begin(); iterator != path.end(); iterator++) {
         if (iterator->z <= 0.1) {
-            iterator->z = Fluid::getInstance().configuration.default_height;
+            iterator->z = fluid.configuration.default_height;
         }
     }
 
@@ -44,25 +82,41 @@ void MoveOperation::initialize() {
     setpoint.yaw = std::atan2(dy, dx);
     
     
-    MavrosInterface mavros_interface;
-    mavros_interface.setParam("WPNAV_SPEED", speed);
-    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Sat speed to: " << speed/100 << " m/s.");
+    fluid.setParam("WPNAV_SPEED", speed);
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Setting speed to: " << speed/100 << " m/s.");
 
-    mavros_interface.setParam("ANGLE_MAX", max_angle);
-    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Sat max angle to: " << max_angle/100 << " deg.");
+    fluid.setParam("ANGLE_MAX", max_angle);
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Setting max angle to: " << max_angle/100 << " deg.");
 
 }
 
 void MoveOperation::tick() {
-    bool at_position_target =
-        Util::distanceBetween(getCurrentPose().pose.position, *current_setpoint_iterator) < position_threshold;
-    bool low_enough_velocity = std::abs(getCurrentTwist().twist.linear.x) < velocity_threshold &&
-                               std::abs(getCurrentTwist().twist.linear.y) < velocity_threshold &&
-                               std::abs(getCurrentTwist().twist.linear.z) < velocity_threshold;
+    const geometry_msgs::Point position = getCurrentPose().pose.position;
+    convergence_predictor.update(ros::Time::now().toSec(), position, *current_setpoint_iterator,
+                                 getCurrentTwist().twist.linear);
+
+    // Only the part of the handover velocity towards the setpoint is kept, so the drone doesn't drift sideways.
+    const double distance = Util::distanceBetween(position, *current_setpoint_iterator);
+    const geometry_msgs::Vector3 handover_velocity = getHandoverVelocity();
+    setpoint.velocity = geometry_msgs::Vector3();
+
+    if (distance > 0) {
+        const double direction_x = (current_setpoint_iterator->x - position.x) / distance;
+        const double direction_y = (current_setpoint_iterator->y - position.y) / distance;
+        const double direction_z = (current_setpoint_iterator->z - position.z) / distance;
+        const double forward_velocity = std::max(0.0,
+                                                 handover_velocity.x * direction_x + handover_velocity.y * direction_y +
+                                                     handover_velocity.z * direction_z);
 
-    if ((at_position_target && low_enough_velocity) || update_setpoint) {
+        setpoint.velocity.x = forward_velocity * direction_x;
+        setpoint.velocity.y = forward_velocity * direction_y;
+        setpoint.velocity.z = forward_velocity * direction_z;
+    }
+
+    if (convergence_predictor.hasConverged(position_threshold, velocity_threshold) || update_setpoint) {
         if (current_setpoint_iterator < path.end() - 1) {
             current_setpoint_iterator++;
+            convergence_predictor.reset();
 
             setpoint.position = *current_setpoint_iterator;
 
@@ -77,3 +131,34 @@ void MoveOperation::tick() {
         update_setpoint = false;
     }
 }
+
+void MoveOperation::savePath(CheckpointState& state) {
+    // Only the current waypoint and the ones after it are needed to resume, so a path too long for the checkpoint is
+    // kept as a window starting at the current waypoint.
+    saved_path_start =
+        path.size() > CheckpointState::MAX_PATH_SIZE ? current_setpoint_iterator - path.begin() : 0;
+    const size_t size = std::min<size_t>(path.size() - saved_path_start, CheckpointState::MAX_PATH_SIZE);
+
+    for (size_t i = 0; i < size; i++) {
+        state.path[i] = Vec3::from(path[saved_path_start + i]);
+    }
+
+    state.path_size = size;
+    is_path_saved = true;
+}
+
+void MoveOperation::saveCheckpoint(CheckpointState& state) {
+    savePath(state);
+    saveCheckpointProgress(state);
+}
+
+void MoveOperation::saveCheckpointProgress(CheckpointState& state) {
+    const size_t index = current_setpoint_iterator - path.begin();
+
+    // The window is moved forward when the drone has flown through it.
+    if (!is_path_saved || index >= saved_path_start + state.path_size) {
+        savePath(state);
+    }
+
+    state.path_index = index - saved_path_start;
+}
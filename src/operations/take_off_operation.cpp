@@ -4,62 +4,204 @@
 
 #include "take_off_operation.h"
 
+#include "deferred_log.h"
 #include "fluid.h"
-#include "mavros_interface.h"
 #include "util.h"
-#include <mavros_msgs/CommandTOL.h>
-#include <fluid/OperationCompletion.h>
 
-TakeOffOperation::TakeOffOperation(float height_setpoint)
-    : Operation(OperationIdentifier::TAKE_OFF, false, true), height_setpoint(height_setpoint) {}
+#define WARMUP_DURATION 2.0        // Setpoints are streamed for this long before guided is set [s]
+#define REQUEST_INTERVAL 0.5       // Minimum time between two requests of the same kind [s]
+#define LINK_TIMEOUT 30.0
+#define ARM_TIMEOUT 10.0
+#define GUIDED_TIMEOUT 5.0
+#define POSE_TIMEOUT 5.0
+#define CONFIGURE_TIMEOUT 5.0
+#define TAKE_OFF_TIMEOUT 5.0
+#define CLIMB_TIMEOUT 30.0
+#define CLIMB_RATE 90              // WPNAV_SPEED_UP [cm/s]
+
+TakeOffOperation::TakeOffOperation(Fluid& fluid, float height_setpoint)
+    : Operation(fluid, OperationIdentifier::TAKE_OFF, false, true),
+      mavros_interface(fluid),
+      convergence_predictor(fluid.configuration.completion_horizon, 2 * max_rate),
+      height_setpoint(height_setpoint) {}
 
 bool TakeOffOperation::hasFinishedExecution() const {
-    const float distance_threshold = Fluid::getInstance().configuration.distance_completion_threshold;
-    const float velocity_threshold = Fluid::getInstance().configuration.velocity_completion_threshold;
-    bool completed =  Util::distanceBetween(getCurrentPose().pose.position, setpoint.position) < distance_threshold &&
-           std::abs(getCurrentTwist().twist.linear.x) < velocity_threshold &&
-           std::abs(getCurrentTwist().twist.linear.y) < velocity_threshold &&
-           std::abs(getCurrentTwist().twist.linear.z) < velocity_threshold;
+    if (stage != Stage::CLIMB) {
+        return false;
+    }
+
+    const float distance_threshold = fluid.configuration.distance_completion_threshold;
+    const float velocity_threshold = fluid.configuration.velocity_completion_threshold;
+    bool completed = convergence_predictor.hasConverged(distance_threshold, velocity_threshold);
     if (completed) {
-        ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": take_off OK!");
+        FLUID_LOG_INFO("take_off OK!");
     }
     return completed;
 }
 
-bool cb(fluid::OperationCompletion::Request& request,
-                                      fluid::OperationCompletion::Response& response) {
-    return true;
+OperationProgress TakeOffOperation::getProgress() const {
+    OperationProgress progress;
+    progress.state = getStageName(stage);
+    progress.distance_remaining = std::max(0.0, height_setpoint - getCurrentPose().pose.position.z);
+    return progress;
+}
+
+std::string TakeOffOperation::getStageName(const Stage& stage) {
+    switch (stage) {
+        case Stage::LINK:
+            return "LINK";
+        case Stage::ARM:
+            return "ARM";
+        case Stage::GUIDED:
+            return "GUIDED";
+        case Stage::WAIT_FOR_POSE:
+            return "WAIT_FOR_POSE";
+        case Stage::CONFIGURE:
+            return "CONFIGURE";
+        case Stage::TAKE_OFF:
+            return "TAKE_OFF";
+        case Stage::CLIMB:
+            return "CLIMB";
+    }
+    return "";  // to avoid warning
+}
+
+double TakeOffOperation::getTimeout(const Stage& stage) {
+    switch (stage) {
+        case Stage::LINK:
+            return LINK_TIMEOUT;
+        case Stage::ARM:
+            return ARM_TIMEOUT;
+        case Stage::GUIDED:
+            return GUIDED_TIMEOUT;
+        case Stage::WAIT_FOR_POSE:
+            return POSE_TIMEOUT;
+        case Stage::CONFIGURE:
+            return CONFIGURE_TIMEOUT;
+        case Stage::TAKE_OFF:
+            return TAKE_OFF_TIMEOUT;
+        case Stage::CLIMB:
+            return CLIMB_TIMEOUT;
+    }
+    return 0;  // to avoid warning
+}
+
+void TakeOffOperation::setStage(const Stage& next_stage) {
+    stage = next_stage;
+    stage_start_time = ros::Time::now();
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Take off stage: " << getStageName(stage).c_str());
+    fluid.getStatusPublisherPtr()->status.current_operation =
+        getStringFromOperationIdentifier(identifier) + ": " + getStageName(stage);
+}
+
+bool TakeOffOperation::pollPendingRequest(bool& success) {
+    if (!pending_request.valid() ||
+        pending_request.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+
+    success = pending_request.get();
+    return pending_request_stage == stage;
+}
+
+void TakeOffOperation::setPendingRequest(std::future<bool>&& request) {
+    pending_request = std::move(request);
+    pending_request_stage = stage;
+    last_request_time = ros::Time::now();
 }
 
 void TakeOffOperation::initialize() {
-    MavrosInterface mavros_interface;
+    // Stream idle setpoints until we have taken off, ArduPilot needs the stream before it accepts guided.
+    setpoint.type_mask = TypeMask::IDLE;
+    warmup_start_time = ros::Time::now();
+    setStage(Stage::LINK);
+}
+
+void TakeOffOperation::tick() {
+    const FluidConfiguration& configuration = fluid.configuration;
+    std::shared_ptr<StatusPublisher> status_publisher_ptr = fluid.getStatusPublisherPtr();
+    const mavros_msgs::State& state = mavros_interface.getCurrentState();
+    const ros::Time now = ros::Time::now();
 
-    ros::Rate rate(5);
-        
-    mavros_interface.establishContactToArduPilot();
-    Fluid::getInstance().getStatusPublisherPtr()->status.linked_with_ardupilot = 1;
+    status_publisher_ptr->status.armed = state.armed;
+    if (!state.mode.empty()) {
+        status_publisher_ptr->status.ardupilot_mode = state.mode;
+    }
 
-    mavros_interface.requestArm(Fluid::getInstance().configuration.should_auto_arm);
-    Fluid::getInstance().getStatusPublisherPtr()->status.armed = Fluid::getInstance().configuration.should_auto_arm;
+    bool request_succeeded = false;
+    const bool got_answer = pollPendingRequest(request_succeeded);
 
-    mavros_interface.requestOffboard(Fluid::getInstance().configuration.should_auto_offboard);
-    Fluid::getInstance().getStatusPublisherPtr()->status.ardupilot_mode = ARDUPILOT_MODE_GUIDED;
+    // Requests are only sent when the previous one has been answered and the request interval has passed.
+    const bool can_request = !pending_request.valid() && (now - last_request_time).toSec() > REQUEST_INTERVAL;
 
-    // Spin until we retrieve the first pose
-    while(ros::ok() && getCurrentPose().header.seq == 0) {
-        ROS_INFO_STREAM(ros::this_node::getName().c_str() << "publish setPoint for takeoff\n");
-        publishSetpoint();
-        ros::spinOnce();
-        rate.sleep();
+    // Requests are retried within a stage, but a stage which doesn't complete in time fails the take off.
+    if ((now - stage_start_time).toSec() > getTimeout(stage)) {
+        fail("stage " + getStageName(stage) + " timed out after " +
+             std::to_string(static_cast<int>(getTimeout(stage))) + " s");
+        return;
     }
 
-    mavros_interface.setParam("WPNAV_SPEED_UP", 90);
-    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Sat climb rate to: " << 90./100. << " m/s.");
+    switch (stage) {
+        case Stage::LINK:
+            if (fluid.isLinkedWithArduPilot() || state.connected) {
+                status_publisher_ptr->status.linked_with_ardupilot = 1;
+                setStage(Stage::ARM);
+            }
+            break;
 
-    //send take off command
-    setpoint.position.x = getCurrentPose().pose.position.x;
-    setpoint.position.y = getCurrentPose().pose.position.y;
-    setpoint.position.z = height_setpoint;
-    setpoint.yaw = getCurrentYaw();
-    mavros_interface.requestTakeOff(setpoint);
+        case Stage::ARM:
+            // Arming overlaps with the setpoint stream warm up.
+            if (state.armed) {
+                if ((now - warmup_start_time).toSec() > WARMUP_DURATION) {
+                    setStage(Stage::GUIDED);
+                }
+            } else if (configuration.should_auto_arm && can_request) {
+                setPendingRequest(mavros_interface.requestArmAsync());
+            }
+            break;
+
+        case Stage::GUIDED:
+            if (state.mode == ARDUPILOT_MODE_GUIDED) {
+                setStage(Stage::WAIT_FOR_POSE);
+            } else if (configuration.should_auto_offboard && can_request) {
+                setPendingRequest(mavros_interface.setModeAsync(ARDUPILOT_MODE_GUIDED));
+            }
+            break;
+
+        case Stage::WAIT_FOR_POSE:
+            if (getCurrentPose().header.seq != 0) {
+                setStage(Stage::CONFIGURE);
+            }
+            break;
+
+        case Stage::CONFIGURE:
+            if (got_answer && request_succeeded) {
+                ROS_INFO_STREAM(ros::this_node::getName().c_str()
+                                << ": Sat climb rate to: " << CLIMB_RATE / 100. << " m/s.");
+
+                setpoint.position.x = getCurrentPose().pose.position.x;
+                setpoint.position.y = getCurrentPose().pose.position.y;
+                setpoint.position.z = height_setpoint;
+                setpoint.yaw = getCurrentYaw();
+                setStage(Stage::TAKE_OFF);
+            } else if (can_request) {
+                setPendingRequest(mavros_interface.setParamAsync("WPNAV_SPEED_UP", CLIMB_RATE));
+            }
+            break;
+
+        case Stage::TAKE_OFF:
+            if (got_answer && request_succeeded) {
+                setpoint.type_mask = TypeMask::POSITION;
+                setStage(Stage::CLIMB);
+            } else if (can_request) {
+                setPendingRequest(mavros_interface.requestTakeOffAsync(height_setpoint, setpoint.yaw));
+            }
+            break;
+
+        case Stage::CLIMB:
+            convergence_predictor.update(now.toSec(), getCurrentPose().pose.position, setpoint.position,
+                                         getCurrentTwist().twist.linear);
+            break;
+    }
 }
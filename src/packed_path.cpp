@@ -0,0 +1,230 @@
+/**
+ * @file packed_path.cpp
+ */
+
+#include "packed_path.h"
+
+#include <cmath>
+#include <limits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+PackedPath::PackedPath(const std::vector<geometry_msgs::Point>& points) { assign(points); }
+
+void PackedPath::assign(const std::vector<geometry_msgs::Point>& points) {
+    const size_t count = points.size();
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        x[i] = points[i].x;
+        y[i] = points[i].y;
+        z[i] = points[i].z;
+    }
+}
+
+void PackedPath::assign(const ascend_msgs::Path& path) { assign(path.points); }
+
+void PackedPath::toPoints(std::vector<geometry_msgs::Point>& points) const {
+    points.resize(size());
+
+    for (size_t i = 0; i < size(); i++) {
+        points[i].x = x[i];
+        points[i].y = y[i];
+        points[i].z = z[i];
+    }
+}
+
+void PackedPath::toMessage(ascend_msgs::Path& path) const { toPoints(path.points); }
+
+void PackedPath::push_back(const geometry_msgs::Point& point) {
+    x.push_back(point.x);
+    y.push_back(point.y);
+    z.push_back(point.z);
+}
+
+void PackedPath::clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+}
+
+size_t PackedPath::size() const { return x.size(); }
+
+geometry_msgs::Point PackedPath::at(const size_t& index) const {
+    geometry_msgs::Point point;
+    point.x = x[index];
+    point.y = y[index];
+    point.z = z[index];
+    return point;
+}
+
+void PackedPath::squaredDistancesTo(const geometry_msgs::Point& point, std::vector<double>& output) const {
+    const size_t count = size();
+    output.resize(count);
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128d px = _mm_set1_pd(point.x), py = _mm_set1_pd(point.y), pz = _mm_set1_pd(point.z);
+
+    for (; i + 2 <= count; i += 2) {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(&x[i]), px);
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(&y[i]), py);
+        const __m128d dz = _mm_sub_pd(_mm_loadu_pd(&z[i]), pz);
+        const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+        _mm_storeu_pd(&output[i], sum);
+    }
+#endif
+
+    for (; i < count; i++) {
+        const double dx = x[i] - point.x, dy = y[i] - point.y, dz = z[i] - point.z;
+        output[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+size_t PackedPath::nearest(const geometry_msgs::Point& point) const {
+    const size_t count = size();
+    size_t closest = count;
+    double closest_distance = std::numeric_limits<double>::max();
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // Each lane keeps its own closest point, the indices are kept as doubles so they can be selected with the same
+    // masks as the distances.
+    const __m128d px = _mm_set1_pd(point.x), py = _mm_set1_pd(point.y), pz = _mm_set1_pd(point.z);
+    __m128d lane_distance = _mm_set1_pd(closest_distance), lane_index = _mm_set1_pd(-1);
+    __m128d index = _mm_set_pd(1, 0);
+    const __m128d increment = _mm_set1_pd(2);
+
+    for (; i + 2 <= count; i += 2) {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(&x[i]), px);
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(&y[i]), py);
+        const __m128d dz = _mm_sub_pd(_mm_loadu_pd(&z[i]), pz);
+        const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+        const __m128d closer = _mm_cmple_pd(sum, lane_distance);
+
+        lane_distance = _mm_or_pd(_mm_and_pd(closer, sum), _mm_andnot_pd(closer, lane_distance));
+        lane_index = _mm_or_pd(_mm_and_pd(closer, index), _mm_andnot_pd(closer, lane_index));
+        index = _mm_add_pd(index, increment);
+    }
+
+    double distances[2], indices[2];
+    _mm_storeu_pd(distances, lane_distance);
+    _mm_storeu_pd(indices, lane_index);
+
+    for (int lane = 0; lane < 2; lane++) {
+        if (indices[lane] < 0) {
+            continue;
+        }
+
+        // On a tie the later point wins, like in the scalar loop.
+        if (distances[lane] < closest_distance || (distances[lane] == closest_distance && indices[lane] > closest)) {
+            closest_distance = distances[lane];
+            closest = static_cast<size_t>(indices[lane]);
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        const double dx = x[i] - point.x, dy = y[i] - point.y, dz = z[i] - point.z;
+        const double distance = dx * dx + dy * dy + dz * dz;
+
+        if (distance <= closest_distance) {
+            closest_distance = distance;
+            closest = i;
+        }
+    }
+
+    return closest;
+}
+
+void PackedPath::cumulativeLength(std::vector<double>& output) const {
+    const size_t count = size();
+    output.resize(count);
+
+    if (count == 0) {
+        return;
+    }
+
+    // The segment lengths are independent, so they are computed in bulk before the running sum.
+    output[0] = 0;
+    size_t i = 1;
+
+#ifdef __SSE2__
+    for (; i + 2 <= count; i += 2) {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(&x[i]), _mm_loadu_pd(&x[i - 1]));
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(&y[i]), _mm_loadu_pd(&y[i - 1]));
+        const __m128d dz = _mm_sub_pd(_mm_loadu_pd(&z[i]), _mm_loadu_pd(&z[i - 1]));
+        const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+        _mm_storeu_pd(&output[i], _mm_sqrt_pd(sum));
+    }
+#endif
+
+    for (; i < count; i++) {
+        const double dx = x[i] - x[i - 1], dy = y[i] - y[i - 1], dz = z[i] - z[i - 1];
+        output[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+    }
+
+    for (i = 1; i < count; i++) {
+        output[i] += output[i - 1];
+    }
+}
+
+void PackedPath::densify(const double& density, PackedPath& output) const {
+    output.clear();
+
+    for (size_t i = 1; i < size(); i++) {
+        const double dx = x[i] - x[i - 1], dy = y[i] - y[i - 1], dz = z[i] - z[i - 1];
+        const double steps = density * std::sqrt(dx * dx + dy * dy + dz * dz);
+
+        // A segment without length only contributes its start.
+        const int count = steps > 0 ? int(steps) + 1 : 1;
+        const double step = steps > 0 ? 1.0 / steps : 0;
+
+        for (int j = 0; j < count; j++) {
+            output.x.push_back(x[i - 1] + j * step * dx);
+            output.y.push_back(y[i - 1] + j * step * dy);
+            output.z.push_back(z[i - 1] + j * step * dz);
+        }
+    }
+}
+
+bool PackedPath::isEqual(const PackedPath& other, const double& tolerance) const {
+    const size_t count = size();
+
+    if (count != other.size()) {
+        return false;
+    }
+
+    const double squared_tolerance = tolerance * tolerance;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    const __m128d limit = _mm_set1_pd(squared_tolerance);
+
+    for (; i + 2 <= count; i += 2) {
+        const __m128d dx = _mm_sub_pd(_mm_loadu_pd(&x[i]), _mm_loadu_pd(&other.x[i]));
+        const __m128d dy = _mm_sub_pd(_mm_loadu_pd(&y[i]), _mm_loadu_pd(&other.y[i]));
+        const __m128d dz = _mm_sub_pd(_mm_loadu_pd(&z[i]), _mm_loadu_pd(&other.z[i]));
+        const __m128d sum = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+
+        // Not less than, so that NaN coordinates count as different.
+        if (_mm_movemask_pd(_mm_cmpnlt_pd(sum, limit)) != 0) {
+            return false;
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        const double dx = x[i] - other.x[i], dy = y[i] - other.y[i], dz = z[i] - other.z[i];
+
+        if (!(dx * dx + dy * dy + dz * dz < squared_tolerance)) {
+            return false;
+        }
+    }
+
+    return true;
+}
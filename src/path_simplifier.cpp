@@ -0,0 +1,148 @@
+/**
+ * @file path_simplifier.cpp
+ */
+
+#include "path_simplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+#include "util.h"
+
+PathSimplifier::PathSimplifier(const double& tolerance, const double& min_spacing, const double& resample_spacing)
+    : tolerance(tolerance), min_spacing(min_spacing), resample_spacing(resample_spacing) {}
+
+double PathSimplifier::distanceToSegment(const geometry_msgs::Point& point,
+                                         const geometry_msgs::Point& start,
+                                         const geometry_msgs::Point& end) {
+    const double dx = end.x - start.x, dy = end.y - start.y, dz = end.z - start.z;
+    const double length_squared = dx * dx + dy * dy + dz * dz;
+
+    double t = 0;
+
+    if (length_squared > 0) {
+        t = ((point.x - start.x) * dx + (point.y - start.y) * dy + (point.z - start.z) * dz) / length_squared;
+        t = std::min(std::max(t, 0.0), 1.0);
+    }
+
+    geometry_msgs::Point closest;
+    closest.x = start.x + t * dx;
+    closest.y = start.y + t * dy;
+    closest.z = start.z + t * dz;
+
+    return Util::distanceBetween(point, closest);
+}
+
+SimplifiedPath PathSimplifier::simplify(const std::vector<geometry_msgs::Point>& path) const {
+    // Merge duplicates, the last point is where the drone should end up so it replaces the one before it, even if that
+    // is the first point.
+    std::vector<size_t> kept;
+    kept.reserve(path.size());
+
+    for (size_t i = 0; i < path.size(); i++) {
+        if (kept.empty() || Util::distanceBetween(path[kept.back()], path[i]) > min_spacing) {
+            kept.push_back(i);
+        } else if (i == path.size() - 1) {
+            kept.back() = i;
+        }
+    }
+
+    const size_t n = kept.size();
+    std::vector<bool> removed(n, false);
+
+    if (tolerance > 0 && n > 2) {
+        // The points form a linked list so they can be removed in any order, segment_error[i] is the largest
+        // distance from an original point to the segment starting at i.
+        std::vector<size_t> previous(n), next(n);
+        std::vector<double> segment_error(n, 0);
+        std::vector<unsigned int> version(n, 0);
+
+        for (size_t i = 0; i < n; i++) {
+            previous[i] = i - 1;
+            next[i] = i + 1;
+        }
+
+        struct Entry {
+            double key;
+            size_t index;
+            unsigned int version;
+
+            bool operator>(const Entry& other) const { return key > other.key; }
+        };
+
+        auto key = [&](const size_t& i) {
+            return std::max(segment_error[previous[i]], segment_error[i]) +
+                   distanceToSegment(path[kept[i]], path[kept[previous[i]]], path[kept[next[i]]]);
+        };
+
+        std::vector<Entry> entries;
+        entries.reserve(n);
+
+        for (size_t i = 1; i < n - 1; i++) {
+            entries.push_back({key(i), i, 0});
+        }
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap(std::greater<Entry>(),
+                                                                                 std::move(entries));
+
+        while (!heap.empty()) {
+            const Entry entry = heap.top();
+            heap.pop();
+
+            // Entries are not updated in place, outdated ones are skipped instead.
+            if (removed[entry.index] || entry.version != version[entry.index]) {
+                continue;
+            }
+
+            if (entry.key > tolerance) {
+                break;
+            }
+
+            const size_t i = entry.index;
+            removed[i] = true;
+            next[previous[i]] = next[i];
+            previous[next[i]] = previous[i];
+            segment_error[previous[i]] = entry.key;
+
+            for (const size_t& neighbour : {previous[i], next[i]}) {
+                if (neighbour != 0 && neighbour != n - 1) {
+                    heap.push({key(neighbour), neighbour, ++version[neighbour]});
+                }
+            }
+        }
+    }
+
+    SimplifiedPath simplified;
+
+    for (size_t i = 0; i < n; i++) {
+        if (removed[i]) {
+            continue;
+        }
+
+        const geometry_msgs::Point& point = path[kept[i]];
+
+        if (resample_spacing > 0 && !simplified.points.empty()) {
+            const geometry_msgs::Point start = simplified.points.back();
+            const size_t start_index = simplified.original_indices.back();
+            const int pieces = std::ceil(Util::distanceBetween(start, point) / resample_spacing);
+
+            for (int piece = 1; piece < pieces; piece++) {
+                const double t = double(piece) / pieces;
+                geometry_msgs::Point inserted;
+                inserted.x = start.x + t * (point.x - start.x);
+                inserted.y = start.y + t * (point.y - start.y);
+                inserted.z = start.z + t * (point.z - start.z);
+
+                simplified.points.push_back(inserted);
+                simplified.original_indices.push_back(start_index);
+            }
+        }
+
+        simplified.points.push_back(point);
+        simplified.original_indices.push_back(kept[i]);
+    }
+
+    return simplified;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file rendezvous_planner.cpp
+ */
+
+#include "rendezvous_planner.h"
+
+#include <ros/ros.h>
+
+#include <cmath>
+
+#include "util.h"
+
+RendezvousPlanner::RendezvousPlanner(const float& max_vel,
+                                     const float& max_acc,
+                                     const int& number_of_windows,
+                                     const float& time_window,
+                                     const float& position_tolerance,
+                                     const float& velocity_tolerance,
+                                     const double& time_budget)
+    : number_of_windows(number_of_windows),
+      time_window(time_window),
+      position_tolerance(position_tolerance),
+      velocity_tolerance(velocity_tolerance),
+      time_budget(time_budget) {
+    // The profiles never exceed the maximum velocity and acceleration given, slower profiles make it possible to
+    // hit a window we would otherwise be too early for.
+    const float vel_scales[] = {1.0, 0.85, 0.7, 0.55};
+    const float acc_scales[] = {1.0, 0.7};
+
+    for (int i = 0; i < NUMBER_OF_PROFILES; i++) {
+        profile_vel[i] = max_vel * vel_scales[i % 4];
+        profile_acc[i] = max_acc * acc_scales[i / 4];
+    }
+}
+
+float RendezvousPlanner::travelTime(const float& distance, const float& max_vel, const float& max_acc) {
+    const float dist_acc_decc = Util::sq(max_vel) / max_acc;
+
+    if (distance < dist_acc_decc) {
+        return 2.0 * sqrt(2.0 * distance / max_acc);
+    }
+
+    return (distance - dist_acc_decc) / max_vel    // time during max vel
+           + 2 * max_vel / max_acc;                 // time during acceleration and decceleration
+}
+
+RendezvousPlan RendezvousPlanner::plan(const float& time_to_max_pitch,
+                                       const float& period,
+                                       const float& amplitude,
+                                       const float& distance) {
+    RendezvousPlan best;
+
+    if (period <= 0 || time_to_max_pitch < 0) {
+        return best;
+    }
+
+    const ros::WallTime start = ros::WallTime::now();
+    const float omega = 2.0 * M_PI / period;
+    const float known_amplitude = amplitude > 0 ? amplitude : 0;
+    float best_score = 0;
+
+    std::array<float, NUMBER_OF_PROFILES> travel_time;
+    for (int p = 0; p < NUMBER_OF_PROFILES; p++) {
+        travel_time[p] = travelTime(distance, profile_vel[p], profile_acc[p]);
+    }
+
+    for (int window = 0; window < number_of_windows; window++) {
+        // Always evaluate the first window, the budget only limits how far ahead we look.
+        if (window > 0 && (ros::WallTime::now() - start).toSec() > time_budget) {
+            break;
+        }
+
+        const float max_pitch_time = time_to_max_pitch + window * period;
+
+        // Enumerate the launch times around the ideal launch of every profile. Launches in the past are
+        // clamped to now.
+        for (int p = 0; p < NUMBER_OF_PROFILES; p++) {
+            const float ideal_launch = max_pitch_time - travel_time[p];
+
+            for (int i = 0; i < NUMBER_OF_LAUNCH_SAMPLES; i++) {
+                const int c = p * NUMBER_OF_LAUNCH_SAMPLES + i;
+                const float offset = time_window * (2.0f * i / (NUMBER_OF_LAUNCH_SAMPLES - 1) - 1.0f);
+                launch[c] = std::max(0.0f, ideal_launch + offset);
+                delta[c] = launch[c] + travel_time[p] - max_pitch_time;
+            }
+        }
+
+        // Score the whole batch against the sinusoidal model of the mast.
+        for (int c = 0; c < BATCH_SIZE; c++) {
+            const float phase = omega * delta[c];
+            position_error[c] = known_amplitude * (1.0f - std::cos(phase));
+            velocity_error[c] = known_amplitude * omega * std::fabs(std::sin(phase));
+        }
+
+        for (int c = 0; c < BATCH_SIZE; c++) {
+            const bool feasible = std::fabs(delta[c]) <= time_window &&
+                                  position_error[c] <= position_tolerance &&
+                                  velocity_error[c] <= velocity_tolerance;
+
+            if (!feasible) {
+                continue;
+            }
+
+            const float score = position_error[c] + velocity_error[c] + std::fabs(delta[c]);
+
+            if (!best.feasible || launch[c] < best.launch_time ||
+                (launch[c] == best.launch_time && score < best_score)) {
+                const int p = c / NUMBER_OF_LAUNCH_SAMPLES;
+
+                best.feasible = true;
+                best.launch_time = launch[c];
+                best.max_vel = profile_vel[p];
+                best.max_acc = profile_acc[p];
+                best.window = window;
+                best.position_error = position_error[c];
+                best.velocity_error = velocity_error[c];
+                best_score = score;
+            }
+        }
+
+        best.evaluated_candidates += BATCH_SIZE;
+    }
+
+    return best;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file startup_timeline.cpp
+ */
+
+#include "startup_timeline.h"
+
+#include <xmlrpcpp/XmlRpcValue.h>
+
+#include <iomanip>
+#include <sstream>
+
+StartupTimeline::StartupTimeline() : start(ros::WallTime::now()) {}
+
+void StartupTimeline::mark(const std::string& stage) {
+    const double time = (ros::WallTime::now() - start).toSec();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stages.emplace_back(stage, time);
+}
+
+void StartupTimeline::report() const {
+    std::stringstream line;
+    XmlRpc::XmlRpcValue timeline;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (const auto& stage : stages) {
+            line << (line.tellp() > 0 ? ", " : " ") << stage.first << ": " << std::fixed << std::setprecision(3)
+                 << stage.second << " s";
+            timeline[stage.first] = stage.second;
+        }
+    }
+
+    ROS_INFO_STREAM(ros::this_node::getName().c_str() << ": Startup timeline:" << line.str());
+
+    ros::NodeHandle node_handle("~");
+    node_handle.setParam("startup_timeline", timeline);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file state_history.cpp
+ */
+
+#include "state_history.h"
+
+constexpr size_t StateHistory::CAPACITY;
+
+bool StateHistory::push(const StateSample& sample) {
+    if (count > 0 && sample.time <= getNewestTime()) {
+        if (getNewestTime() - sample.time <= 1.0) {
+            return false;
+        }
+
+        clear();
+    }
+
+    if (count < CAPACITY) {
+        ring[(start + count) % CAPACITY] = sample;
+        count++;
+    } else {
+        ring[start] = sample;
+        start = (start + 1) % CAPACITY;
+    }
+
+    return true;
+}
+
+bool StateHistory::sample(const double& time, StateSample& output) const {
+    if (count == 0 || time < getOldestTime() || time > getNewestTime()) {
+        return false;
+    }
+
+    // Find the first sample after the requested time, the one before it is at or before it.
+    size_t low = 1, high = count;
+
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+
+        if ((*this)[middle].time <= time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    const StateSample& before = (*this)[low - 1];
+
+    if (low == count) {
+        output = before;
+        return true;
+    }
+
+    const StateSample& after = (*this)[low];
+    const double s = (time - before.time) / (after.time - before.time);
+
+    auto interpolate = [&](const double& a, const double& b) { return a + s * (b - a); };
+
+    output.time = time;
+
+    output.position.x = interpolate(before.position.x, after.position.x);
+    output.position.y = interpolate(before.position.y, after.position.y);
+    output.position.z = interpolate(before.position.z, after.position.z);
+
+    output.velocity.x = interpolate(before.velocity.x, after.velocity.x);
+    output.velocity.y = interpolate(before.velocity.y, after.velocity.y);
+    output.velocity.z = interpolate(before.velocity.z, after.velocity.z);
+
+    output.acceleration.x = interpolate(before.acceleration.x, after.acceleration.x);
+    output.acceleration.y = interpolate(before.acceleration.y, after.acceleration.y);
+    output.acceleration.z = interpolate(before.acceleration.z, after.acceleration.z);
+
+    return true;
+}
+
+void StateHistory::clear() {
+    start = 0;
+    count = 0;
+}
+
+size_t StateHistory::size() const { return count; }
+
+const StateSample& StateHistory::operator[](const size_t& index) const { return ring[(start + index) % CAPACITY]; }
+
+double StateHistory::getOldestTime() const { return count == 0 ? 0 : (*this)[0].time; }
+
+double StateHistory::getNewestTime() const { return count == 0 ? 0 : (*this)[count - 1].time; }
@@ -0,0 +1,93 @@
+/**
+ * @file state_hub.cpp
+ */
+
+#include "state_hub.h"
+
+#include <cmath>
+
+#include "util.h"
+
+StateHub::StateHub(const ros::NodeHandle& node_handle,
+                   std::shared_ptr<LatencyMonitor> latency_monitor_ptr,
+                   const bool& should_broadcast_transform,
+                   const float& transform_rate)
+    : node_handle(node_handle), latency_monitor_ptr(latency_monitor_ptr), transform_period(1.0 / transform_rate) {
+    odometry_latency_source = latency_monitor_ptr->addSource("odometry");
+    velocity_latency_source = latency_monitor_ptr->addSource("velocity");
+
+    if (should_broadcast_transform) {
+        broadcaster_ptr.reset(new tf2_ros::TransformBroadcaster());
+
+        // A vehicle in its own namespace gets its own frame, e.g. uav1/base_link.
+        const std::string& name_space = node_handle.getNamespace();
+        transform_stamped.child_frame_id = name_space == "/" ? "base_link" : name_space.substr(1) + "/base_link";
+    }
+
+    odometry_subscriber =
+        this->node_handle.subscribe("mavros/global_position/local", 1, &StateHub::odometryCallback, this);
+    twist_subscriber =
+        this->node_handle.subscribe("mavros/local_position/velocity_local", 1, &StateHub::twistCallback, this);
+    extended_state_subscriber =
+        this->node_handle.subscribe("mavros/extended_state", 1, &StateHub::extendedStateCallback, this);
+}
+
+void StateHub::odometryCallback(const nav_msgs::Odometry::ConstPtr& odometry) {
+    latency_monitor_ptr->record(odometry_latency_source, odometry->header.stamp);
+
+    current_pose.pose = odometry->pose.pose;
+    current_pose.header = odometry->header;
+    current_accel = orientationToAcceleration(odometry->pose.pose.orientation);
+
+    StateSample sample;
+    sample.time = odometry->header.stamp.toSec();
+    sample.position = odometry->pose.pose.position;
+    sample.velocity = current_twist.twist.linear;
+    sample.acceleration = current_accel;
+    history.push(sample);
+
+    // The transform keeps the stamp of the odometry, so it lines up with the other data from the same instant. A
+    // stamp going backwards means the clock was reset, e.g. by restarting the simulator.
+    const double elapsed = (odometry->header.stamp - transform_stamped.header.stamp).toSec();
+
+    if (broadcaster_ptr && (elapsed >= transform_period || elapsed < 0)) {
+        transform_stamped.header.stamp = odometry->header.stamp;
+        transform_stamped.header.frame_id = odometry->header.frame_id;
+        transform_stamped.transform.translation.x = odometry->pose.pose.position.x;
+        transform_stamped.transform.translation.y = odometry->pose.pose.position.y;
+        transform_stamped.transform.translation.z = odometry->pose.pose.position.z;
+        transform_stamped.transform.rotation = odometry->pose.pose.orientation;
+
+        broadcaster_ptr->sendTransform(transform_stamped);
+    }
+}
+
+void StateHub::twistCallback(const geometry_msgs::TwistStamped::ConstPtr& twist) {
+    latency_monitor_ptr->record(velocity_latency_source, twist->header.stamp);
+
+    current_twist.twist = twist->twist;
+    current_twist.header = twist->header;
+}
+
+void StateHub::extendedStateCallback(const mavros_msgs::ExtendedState::ConstPtr& extended_state) {
+    landed_state = extended_state->landed_state;
+}
+
+geometry_msgs::Vector3 StateHub::orientationToAcceleration(const geometry_msgs::Quaternion& orientation) {
+    geometry_msgs::Vector3 accel;
+    geometry_msgs::Vector3 angle = Util::quaternion_to_euler_angle(orientation);
+    accel.x = tan(angle.y) * 9.81;
+    accel.y = -tan(angle.x) * 9.81;
+    accel.z = 0.0;  // we actually don't know ...
+    return accel;
+}
+
+const geometry_msgs::PoseStamped& StateHub::getPose() const { return current_pose; }
+
+const geometry_msgs::TwistStamped& StateHub::getTwist() const { return current_twist; }
+
+const geometry_msgs::Vector3& StateHub::getAccel() const { return current_accel; }
+
+const StateHistory& StateHub::getHistory() const { return history; }
+
+uint8_t StateHub::getLandedState() const { return landed_state; }
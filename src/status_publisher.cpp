@@ -1,15 +1,17 @@
 #include "status_publisher.h"
 
-StatusPublisher::StatusPublisher() {
+StatusPublisher::StatusPublisher(const ros::NodeHandle& node_handle) : node_handle(node_handle) {
     status.armed = 0;
     status.linked_with_ardupilot = 0;
     status.ardupilot_mode = "none";
     status.current_operation = "none";
 
-    pose_subscriber = node_handle.subscribe("mavros/local_position/pose", 1, &StatusPublisher::poseCallback, this);
-    status_publisher = node_handle.advertise<ascend_msgs::FluidStatus>("fluid/status", 1);
-    trace_publisher = node_handle.advertise<nav_msgs::Path>("fluid/trace", 1);
-    setpoint_marker_publisher = node_handle.advertise<visualization_msgs::Marker>("fluid/setpoint_setpoint_marker", 10);
+    pose_subscriber =
+        this->node_handle.subscribe("mavros/local_position/pose", 1, &StatusPublisher::poseCallback, this);
+    status_publisher = this->node_handle.advertise<ascend_msgs::FluidStatus>("fluid/status", 1);
+    trace_publisher = this->node_handle.advertise<nav_msgs::Path>("fluid/trace", 1);
+    setpoint_marker_publisher =
+        this->node_handle.advertise<visualization_msgs::Marker>("fluid/setpoint_setpoint_marker", 10);
 
     setpoint_marker.header.frame_id = "/map";
     setpoint_marker.header.stamp = ros::Time::now();
@@ -29,7 +31,7 @@ StatusPublisher::StatusPublisher() {
     setpoint_marker.lifetime = ros::Duration();
 }
 
-void StatusPublisher::poseCallback(const geometry_msgs::PoseStampedConstPtr pose_ptr) {
+void StatusPublisher::poseCallback(const geometry_msgs::PoseStamped::ConstPtr& pose_ptr) {
     if (trace_path.poses.size() > 300) {
         trace_path.poses.erase(trace_path.poses.begin());
     }
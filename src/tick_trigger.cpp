@@ -0,0 +1,49 @@
+/**
+ * @file tick_trigger.cpp
+ */
+
+#include "tick_trigger.h"
+
+#include <chrono>
+#include <thread>
+
+TickTrigger::TickTrigger(const ros::NodeHandle& node_handle, const std::string& topic)
+    : spinner(1, &callback_queue) {
+    ros::NodeHandle trigger_node_handle(node_handle);
+    trigger_node_handle.setCallbackQueue(&callback_queue);
+
+    subscriber =
+        trigger_node_handle.subscribe(topic, 1, &TickTrigger::callback, this, ros::TransportHints().tcpNoDelay());
+    spinner.start();
+}
+
+TickTrigger::~TickTrigger() {
+    spinner.stop();
+    subscriber.shutdown();
+}
+
+void TickTrigger::callback(const ros::MessageEvent<topic_tools::ShapeShifter const>& event) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        arrival_time = ros::WallTime::now();
+        has_arrived = true;
+    }
+
+    condition.notify_one();
+}
+
+bool TickTrigger::wait(const ros::WallDuration& min_wait, const ros::WallDuration& max_wait) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(min_wait.toSec()));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    const bool is_triggered = condition.wait_for(lock, std::chrono::duration<double>((max_wait - min_wait).toSec()),
+                                                 [this]() { return has_arrived; });
+    has_arrived = false;
+    return is_triggered;
+}
+
+ros::WallTime TickTrigger::consumeArrivalTime() {
+    std::lock_guard<std::mutex> lock(mutex);
+    has_arrived = false;
+    return arrival_time;
+}
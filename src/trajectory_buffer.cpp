@@ -0,0 +1,133 @@
+/**
+ * @file trajectory_buffer.cpp
+ */
+
+#include "trajectory_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool TrajectoryBuffer::push(const TrajectorySample& sample) {
+    const size_t write = write_index.load(std::memory_order_relaxed);
+
+    if (write - read_index.load(std::memory_order_acquire) >= CAPACITY) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ring[write % CAPACITY] = sample;
+    write_index.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+void TrajectoryBuffer::drain() {
+    size_t read = read_index.load(std::memory_order_relaxed);
+    const size_t write = write_index.load(std::memory_order_acquire);
+
+    for (; read != write; read++) {
+        const TrajectorySample& sample = ring[read % CAPACITY];
+
+        if (sample.chunk_stamp > newest_chunk_stamp) {
+            // A new plan, it replaces everything from its first sample and onwards.
+            newest_chunk_stamp = sample.chunk_stamp;
+            newest_chunk_start = sample.time;
+
+            while (!window.empty() && window.back().time >= sample.time) {
+                window.pop_back();
+            }
+
+            insert(sample);
+        } else if (sample.chunk_stamp == newest_chunk_stamp) {
+            insert(sample);
+        } else if (sample.time < newest_chunk_start) {
+            // An older chunk which arrived late, only use it where the newest chunk doesn't say anything.
+            insert(sample);
+        }
+    }
+
+    read_index.store(read, std::memory_order_release);
+}
+
+void TrajectoryBuffer::insert(const TrajectorySample& sample) {
+    auto iterator = std::lower_bound(
+        window.begin(), window.end(), sample.time,
+        [](const TrajectorySample& element, const double& time) { return element.time < time; });
+
+    if (iterator != window.end() && iterator->time == sample.time) {
+        *iterator = sample;
+    } else {
+        window.insert(iterator, sample);
+    }
+}
+
+bool TrajectoryBuffer::sample(const double& time, TrajectorySample& output) {
+    drain();
+
+    // Samples before the one right before the requested time are not needed anymore.
+    while (window.size() >= 2 && window[1].time <= time) {
+        window.pop_front();
+    }
+
+    if (window.empty()) {
+        return false;
+    }
+
+    const TrajectorySample& first = window.front();
+
+    if (window.size() == 1 || time <= first.time) {
+        output = first;
+
+        if (time != first.time) {
+            // Before the start or past the end of the trajectory, hold the position without feeding forward the
+            // velocity of the sample.
+            output.velocity = geometry_msgs::Vector3();
+            output.acceleration = geometry_msgs::Vector3();
+        }
+
+        output.time = time;
+        return true;
+    }
+
+    const TrajectorySample& second = window[1];
+    const double h = second.time - first.time;
+    const double s = (time - first.time) / h;
+    const double s2 = s * s, s3 = s2 * s;
+
+    // Cubic Hermite basis and its derivative, the velocities are the tangents.
+    const double h00 = 2 * s3 - 3 * s2 + 1, h10 = s3 - 2 * s2 + s, h01 = -2 * s3 + 3 * s2, h11 = s3 - s2;
+    const double d00 = 6 * s2 - 6 * s, d10 = 3 * s2 - 4 * s + 1, d01 = -6 * s2 + 6 * s, d11 = 3 * s2 - 2 * s;
+
+    auto position = [&](const double& p0, const double& v0, const double& p1, const double& v1) {
+        return h00 * p0 + h10 * h * v0 + h01 * p1 + h11 * h * v1;
+    };
+
+    auto velocity = [&](const double& p0, const double& v0, const double& p1, const double& v1) {
+        return (d00 * p0 + d10 * h * v0 + d01 * p1 + d11 * h * v1) / h;
+    };
+
+    output.time = time;
+    output.chunk_stamp = second.chunk_stamp;
+
+    output.position.x = position(first.position.x, first.velocity.x, second.position.x, second.velocity.x);
+    output.position.y = position(first.position.y, first.velocity.y, second.position.y, second.velocity.y);
+    output.position.z = position(first.position.z, first.velocity.z, second.position.z, second.velocity.z);
+
+    output.velocity.x = velocity(first.position.x, first.velocity.x, second.position.x, second.velocity.x);
+    output.velocity.y = velocity(first.position.y, first.velocity.y, second.position.y, second.velocity.y);
+    output.velocity.z = velocity(first.position.z, first.velocity.z, second.position.z, second.velocity.z);
+
+    // The acceleration is a feed forward term, a linear blend of the planned accelerations is enough.
+    output.acceleration.x = (1 - s) * first.acceleration.x + s * second.acceleration.x;
+    output.acceleration.y = (1 - s) * first.acceleration.y + s * second.acceleration.y;
+    output.acceleration.z = (1 - s) * first.acceleration.z + s * second.acceleration.z;
+
+    // Interpolate the yaw along the shortest way around.
+    const float yaw_difference = std::remainder(second.yaw - first.yaw, 2 * M_PI);
+    output.yaw = std::remainder(first.yaw + s * yaw_difference, 2 * M_PI);
+
+    return true;
+}
+
+double TrajectoryBuffer::getEndTime() const { return window.empty() ? 0 : window.back().time; }
+
+unsigned int TrajectoryBuffer::getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
@@ -0,0 +1,126 @@
+/**
+ * @file async_service_caller_test.cpp
+ *
+ * @brief Checks that an AsyncServiceCaller retrying against a service which never answers doesn't leak threads.
+ */
+
+#include <gtest/gtest.h>
+#include <ros/callback_queue.h>
+#include <ros/ros.h>
+#include <std_srvs/Trigger.h>
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include "async_service_caller.h"
+
+#define SERVICE_NAME "async_service_caller_test/hanging"  // Service which blocks until the test is done
+#define CALL_TIMEOUT 0.1                                  // [s] Timeout of the caller
+#define RETRY_COUNT 20                                    // Calls started against the hanging service
+#define MAX_EXTRA_THREADS 2                               // The worker and the one abandoned worker
+
+/**
+ * @return The number of threads of this process, -1 if it can't be read.
+ */
+int getThreadCount() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) {
+            return std::stoi(line.substr(8));
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Advertises #SERVICE_NAME on its own spinner, the calls block until #release is called.
+ */
+class HangingService {
+   private:
+    ros::NodeHandle node_handle;
+    ros::CallbackQueue callback_queue;
+    ros::ServiceServer server;
+    ros::AsyncSpinner spinner;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool is_released = false;
+
+    bool callback(std_srvs::Trigger::Request&, std_srvs::Trigger::Response& response) {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return is_released; });
+        response.success = true;
+        return true;
+    }
+
+   public:
+    HangingService() : spinner(4, &callback_queue) {
+        node_handle.setCallbackQueue(&callback_queue);
+        server = node_handle.advertiseService(SERVICE_NAME, &HangingService::callback, this);
+        spinner.start();
+    }
+
+    ~HangingService() {
+        release();
+        spinner.stop();
+    }
+
+    void release() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_released = true;
+        }
+
+        condition.notify_all();
+    }
+};
+
+TEST(AsyncServiceCallerTest, threadCountStaysBoundedAgainstHangingService) {
+    ros::NodeHandle node_handle;
+    HangingService service;
+    ASSERT_TRUE(ros::service::waitForService(SERVICE_NAME, 5000));
+
+    const int baseline_thread_count = getThreadCount();
+    ASSERT_GT(baseline_thread_count, 0);
+
+    bool was_busy = false;
+
+    {
+        AsyncServiceCaller<std_srvs::Trigger> caller(node_handle, SERVICE_NAME, CALL_TIMEOUT);
+        std_srvs::Trigger::Request request;
+
+        for (int i = 0; i < RETRY_COUNT; i++) {
+            caller.call(request);
+
+            AsyncCallStatus status = caller.poll();
+
+            while (status == AsyncCallStatus::PENDING) {
+                ros::WallDuration(0.01).sleep();
+                status = caller.poll();
+            }
+
+            EXPECT_NE(status, AsyncCallStatus::SUCCEEDED);
+            was_busy = was_busy || caller.poll() == AsyncCallStatus::BUSY;
+
+            EXPECT_LE(getThreadCount(), baseline_thread_count + MAX_EXTRA_THREADS) << "after call " << i;
+        }
+
+        // Lets the stuck workers finish before the process exits.
+        service.release();
+        ros::WallDuration(0.5).sleep();
+    }
+
+    EXPECT_TRUE(was_busy);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    ros::init(argc, argv, "async_service_caller_test");
+    ros::NodeHandle node_handle;
+    return RUN_ALL_TESTS();
+}
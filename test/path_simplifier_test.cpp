@@ -0,0 +1,47 @@
+/**
+ * @file path_simplifier_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "path_simplifier.h"
+
+#define MIN_SPACING 0.05  // [m]
+
+/**
+ * @return A point at @p x on the x axis.
+ */
+geometry_msgs::Point pointAt(const double& x) {
+    geometry_msgs::Point point;
+    point.x = x;
+    return point;
+}
+
+TEST(PathSimplifierTest, keepsGoalWhenEveryPointIsMergedIntoTheFirst) {
+    const PathSimplifier simplifier(0.0, MIN_SPACING, 0.0);
+    const std::vector<geometry_msgs::Point> path{pointAt(0.0), pointAt(0.01), pointAt(0.02)};
+
+    const SimplifiedPath simplified = simplifier.simplify(path);
+
+    ASSERT_EQ(simplified.points.size(), 1u);
+    EXPECT_DOUBLE_EQ(simplified.points.back().x, 0.02);
+    EXPECT_EQ(simplified.original_indices.back(), 2u);
+}
+
+TEST(PathSimplifierTest, keepsGoalWhenItIsMergedIntoTheOneBefore) {
+    const PathSimplifier simplifier(0.0, MIN_SPACING, 0.0);
+    const std::vector<geometry_msgs::Point> path{pointAt(0.0), pointAt(1.0), pointAt(1.01)};
+
+    const SimplifiedPath simplified = simplifier.simplify(path);
+
+    ASSERT_EQ(simplified.points.size(), 2u);
+    EXPECT_DOUBLE_EQ(simplified.points.front().x, 0.0);
+    EXPECT_DOUBLE_EQ(simplified.points.back().x, 1.01);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}